@@ -0,0 +1,1747 @@
+/*******************************************************************************
+ *
+ * MIT License
+ *
+ * Copyright (c) 2020 Advanced Micro Devices, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
+#include <malloc.h>
+#include <random>
+
+#include "config_binary.hpp"
+#include "config_gzip.hpp"
+#include "config_lazy.hpp"
+#include "config_parser.hpp"
+#include "config_writer.hpp"
+#include "igemm_gtc_base.hpp"
+#include "igemm_gtc_select.hpp"
+#include "igemm_gtc_table.hpp"
+#include "config_comm.hpp"
+#include "bwd_nchw_config.hpp"
+#include "bwd_nhwc_config.hpp"
+#include "fwd_nchw_config.hpp"
+
+// every heap allocation made by the program goes through here, so the
+// allocation benchmarks can tell how many mallocs a piece of code costs
+static size_t num_allocations = 0;
+static size_t num_live_bytes = 0;
+
+void *operator new(size_t size)
+{
+    num_allocations++;
+    void *p = malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    num_live_bytes += malloc_usable_size(p);
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    if (p)
+         num_live_bytes -= malloc_usable_size(p);
+    free(p);
+}
+void operator delete(void *p, size_t) noexcept { operator delete(p); }
+
+// std::pmr::new_delete_resource() allocates through these
+void *operator new(size_t size, std::align_val_t align)
+{
+    num_allocations++;
+    void *p = NULL;
+    if (posix_memalign(&p, std::max(sizeof(void *), static_cast<size_t>(align)), size ? size : 1) != 0)
+        throw std::bad_alloc();
+    num_live_bytes += malloc_usable_size(p);
+    return p;
+}
+
+void operator delete(void *p, std::align_val_t) noexcept { operator delete(p); }
+void operator delete(void *p, size_t, std::align_val_t) noexcept { operator delete(p); }
+
+static size_t count_allocations(const std::function<void()> &func)
+{
+    size_t before = num_allocations;
+    func();
+    return num_allocations - before;
+}
+
+static double time_ms(const std::function<void()> &func, int iterations)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+        func();
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(stop - start).count() / iterations;
+}
+
+static size_t count_sections(const config_content_t &content)
+{
+    size_t num_sections = 0;
+    for (const auto &sec : content) {
+        (void)sec;
+        num_sections++;
+    }
+    return num_sections;
+}
+
+static bool same_content(const config_content_t &a, const config_content_t &b)
+{
+    auto it_b = b.begin();
+    for (const auto &sec_a : a) {
+        if (it_b == b.end() || sec_a.get_name() != it_b->get_name())
+            return false;
+        for (const auto &kv : sec_a) {
+            if (it_b->count(kv.first) == 0 || it_b->at(kv.first).serialize() != kv.second.serialize())
+                return false;
+        }
+        for (const auto &kv : *it_b) {
+            if (sec_a.count(kv.first) == 0)
+                return false;
+        }
+        it_b++;
+    }
+    return it_b == b.end();
+}
+
+static void report_throughput(const char *name, double ms, size_t bytes, size_t num_sections)
+{
+    fprintf(stdout, "%-24s %10.3f ms %10.2f MB/s %14.0f sections/s\n", name, ms,
+            (double)bytes / (1024.0 * 1024.0) / (ms / 1000.0), (double)num_sections / (ms / 1000.0));
+}
+
+// parse throughput of the std::ifstream path against the mmap/string_view path
+static int benchmark_parse(const char *config_file, int iterations, int num_threads)
+{
+    config_mapped_file_t mapped_file(config_file);
+    size_t bytes = mapped_file.size();
+
+    config_content_t stream_content = config_parser_t(config_file, config_parse_mode_enum::config_parse_mode_stream).parse();
+    config_content_t mmap_content   = config_parser_t(config_file, config_parse_mode_enum::config_parse_mode_mmap).parse();
+    if (!same_content(stream_content, mmap_content)) {
+         fprintf(stdout, "stream and mmap parse results differ !\n");
+         return(-1);
+    }
+    // the key table is shared by the workers, so look at how the parallel parse
+    // scales and not only at the requested thread count
+    std::vector<int> thread_counts = {1, 2, 4};
+    if (std::find(thread_counts.begin(), thread_counts.end(), num_threads) == thread_counts.end())
+         thread_counts.push_back(num_threads);
+    for (int threads : thread_counts) {
+         config_content_t parallel_content = config_parser_t(config_file, config_parse_mode_enum::config_parse_mode_parallel, threads).parse();
+         if (!same_content(stream_content, parallel_content)) {
+              fprintf(stdout, "stream and parallel (%dt) parse results differ !\n", threads);
+              return(-1);
+         }
+    }
+    size_t num_sections = count_sections(stream_content);
+    fprintf(stdout, "%s: %zu bytes, %zu sections, %d iterations\n", config_file, bytes, num_sections, iterations);
+
+    double stream_ms = time_ms([&]() {
+         config_parser_t(config_file, config_parse_mode_enum::config_parse_mode_stream).parse();
+    }, iterations);
+    double mmap_ms = time_ms([&]() {
+         config_parser_t(config_file, config_parse_mode_enum::config_parse_mode_mmap).parse();
+    }, iterations);
+
+    report_throughput("parse (stream)", stream_ms, bytes, num_sections);
+    report_throughput("parse (mmap)", mmap_ms, bytes, num_sections);
+    for (int threads : thread_counts) {
+         double parallel_ms = time_ms([&]() {
+              config_parser_t(config_file, config_parse_mode_enum::config_parse_mode_parallel, threads).parse();
+         }, iterations);
+         report_throughput(("parse (parallel, " + std::to_string(threads) + "t)").c_str(), parallel_ms, bytes, num_sections);
+    }
+    return(0);
+}
+
+// heap allocations per section spent in parsing, in tunable conversion and
+// in reading back every value of every section
+static int benchmark_alloc(const char *config_file)
+{
+    config_content_t content;
+    size_t live_bytes = num_live_bytes;
+    size_t parse_allocs = count_allocations([&]() {
+         content = config_parser_t(config_file).parse();
+    });
+    size_t content_bytes = num_live_bytes - live_bytes;
+    size_t num_sections = count_sections(content);
+
+    std::vector<igemm_gtc_tunable_t> tunables;
+    tunables.reserve(num_sections);
+    size_t convert_allocs = count_allocations([&]() {
+         std::string arch_string = content.get_section("codegen").at("arch").get_string();
+         for (const auto &sec : content)
+              if (igemm_gtc_is_tunable_section(sec))
+                   tunables.push_back(igemm_gtc_tunable_from_section(arch_string, sec));
+    });
+
+    size_t checksum = 0;
+    auto decode_all_values = [&](bool use_views) {
+         for (const auto &sec : content) {
+              for (const auto &kv : sec) {
+                   const config_section_value_t &value = kv.second;
+                   switch (value.get_type()) {
+                   case config_section_value_type_enum::config_section_value_type_int:
+                        checksum += value.get_int();
+                        break;
+                   case config_section_value_type_enum::config_section_value_type_list_int:
+                        checksum += use_views ? value.get_list_int_view().size() : value.get_list_int().size();
+                        break;
+                   case config_section_value_type_enum::config_section_value_type_string:
+                        checksum += use_views ? value.get_string_view().size() : value.get_string().size();
+                        break;
+                   default:
+                        break;
+                   }
+              }
+         }
+    };
+    size_t decode_allocs = count_allocations([&]() { decode_all_values(false); });
+    size_t view_allocs = count_allocations([&]() { decode_all_values(true); });
+
+    // lists past the inline bytes live in the arena, after values of any length
+    config_content_t lists = config_parser_t(config_file).parse_buffer(
+         "[lists]\nname = 'abcdefghijklmnopqrstuvwxyz012345678'\n"
+         "ints = [1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12]\nfloats = [.5, .25, .75, .125, .375, .625, .875, .0625, .1875]\n");
+    const auto &lists_sec = lists.get_section("lists");
+    config_value_span_t<int> ints = lists_sec.at("ints").get_list_int_view();
+    config_value_span_t<float> floats = lists_sec.at("floats").get_list_float_view();
+    if (reinterpret_cast<uintptr_t>(ints.data()) % alignof(int) != 0 ||
+        reinterpret_cast<uintptr_t>(floats.data()) % alignof(float) != 0 || ints.size() != 12 || ints[11] != 12 ||
+        floats.size() != 9 || floats[8] != .1875f) {
+         fprintf(stdout, "the views of the lists held in the arena are misaligned or wrong !\n");
+         return(-1);
+    }
+
+    fprintf(stdout, "%s: %zu sections, %zu tunables (checksum %zu)\n", config_file, num_sections, tunables.size(), checksum);
+    fprintf(stdout, "%-24s %10.2f allocations/section %10.2f bytes/section\n", "parse", (double)parse_allocs / num_sections,
+            (double)content_bytes / num_sections);
+    fprintf(stdout, "%-24s %10zu allocations/file\n", "parse", parse_allocs);
+    fprintf(stdout, "%-24s %10.2f allocations/section\n", "tunable conversion", (double)convert_allocs / num_sections);
+    fprintf(stdout, "%-24s %10.2f allocations/section\n", "decode all values", (double)decode_allocs / num_sections);
+    fprintf(stdout, "%-24s %10.2f allocations/section\n", "view all values", (double)view_allocs / num_sections);
+    return(0);
+}
+
+// cost of igemm_gtc_tunable_from_section() on parsed sections
+static int benchmark_convert(const char *config_file, int iterations)
+{
+    config_content_t content = config_parser_t(config_file).parse();
+    std::string arch_string = content.get_section("codegen").at("arch").get_string();
+    size_t num_tunables = 0;
+    double ms = time_ms([&]() {
+         num_tunables = 0;
+         for (const auto &sec : content) {
+              if (igemm_gtc_is_tunable_section(sec)) {
+                   igemm_gtc_tunable_t tunable = igemm_gtc_tunable_from_section(arch_string, sec);
+                   num_tunables += tunable.nxe >= 0;
+              }
+         }
+    }, iterations);
+    fprintf(stdout, "%s: %zu tunables, %d iterations\n", config_file, num_tunables, iterations);
+    fprintf(stdout, "%-24s %10.3f ms %10.1f ns/tunable\n", "tunable conversion", ms, ms * 1e6 / num_tunables);
+
+    // the name index against a scan of all the sections
+    for (const char *sec_name : {"codegen", "igemm_fwd_gtc", "igemm_bwd_gtc", "igemm_wrw_gtc"}) {
+         size_t position = 0;
+         for (const auto &sec : content.get_sections(sec_name)) {
+              while (position < content.size() && content[position].get_name() != sec_name)
+                   position++;
+              if (position == content.size() || &content[position] != &sec) {
+                   fprintf(stdout, "name index of [%s] differs from the sections !\n", sec_name);
+                   return(-1);
+              }
+              position++;
+         }
+         while (position < content.size() && content[position].get_name() != sec_name)
+              position++;
+         if (position != content.size()) {
+              fprintf(stdout, "name index of [%s] misses sections !\n", sec_name);
+              return(-1);
+         }
+    }
+    size_t num_lookups = 1000000;
+    size_t found = 0;
+    std::string last_name(content.size() ? content[content.size() - 1].get_name() : "");
+    double lookup_ms = time_ms([&]() {
+         for (size_t i = 0; i < num_lookups; i++)
+              found += content.get_section(i & 1 ? last_name : "codegen").size();
+    }, 1);
+    double range_ms = time_ms([&]() {
+         for (size_t i = 0; i < num_lookups; i++)
+              found += content.get_sections("igemm_bwd_gtc").size();
+    }, 1);
+    fprintf(stdout, "%-24s %10.3f ms %10.1f ns/lookup (%zu)\n", "section lookup", lookup_ms, lookup_ms * 1e6 / num_lookups, found);
+    fprintf(stdout, "%-24s %10.3f ms %10.1f ns/lookup\n", "section range lookup", range_ms, range_ms * 1e6 / num_lookups);
+    return(0);
+}
+
+// startup cost of the tools: parsing the text against going through the
+// compiled '<config>.bin' cache, which is compiled from scratch first
+static int benchmark_cache(const char *config_file, int iterations, int num_threads)
+{
+    config_binary_cache_t cache(config_file, num_threads);
+    config_binary_reader_t reader;
+    unlink(cache.get_cache_file().c_str());
+    double rebuild_ms = time_ms([&]() { cache.rebuild(reader); }, 1);
+    // what an edit costs, every section but the edited ones is taken from the previous cache
+    double recompile_ms = time_ms([&]() { cache.rebuild(reader); }, iterations);
+
+    config_content_t content = config_parser_t(config_file).parse();
+    if (!same_content(content, reader.to_content())) {
+         fprintf(stdout, "text and compiled config differ !\n");
+         return(-1);
+    }
+    if (!cache.load(reader)) {
+         fprintf(stdout, "fail to load cache:%s\n", cache.get_cache_file().c_str());
+         return(-1);
+    }
+    size_t num_tunables = igemm_gtc_tunable_from_config(reader).size();
+    if (num_tunables != igemm_gtc_tunable_from_config(content).size()) {
+         fprintf(stdout, "text and compiled config give different tunables !\n");
+         return(-1);
+    }
+    fprintf(stdout, "%s: %zu sections, %zu tunables, %d iterations\n", config_file, reader.size(), num_tunables, iterations);
+
+    double text_ms = time_ms([&]() {
+         config_parser_t parser(config_file, config_parse_mode_enum::config_parse_mode_parallel, num_threads);
+         igemm_gtc_tunable_from_config(parser);
+    }, iterations);
+    double open_ms = time_ms([&]() {
+         config_binary_reader_t r;
+         cache.load(r);
+    }, iterations);
+    double load_ms = time_ms([&]() { igemm_gtc_tunable_load(config_file); }, iterations);
+
+    fprintf(stdout, "%-24s %10.3f ms\n", "compile + write cache", rebuild_ms);
+    fprintf(stdout, "%-24s %10.3f ms\n", "recompile, all reused", recompile_ms);
+    fprintf(stdout, "%-24s %10.3f ms %10.1f ns/tunable\n", "tunables from text", text_ms, text_ms * 1e6 / num_tunables);
+    fprintf(stdout, "%-24s %10.3f ms\n", "validate + map cache", open_ms);
+    fprintf(stdout, "%-24s %10.3f ms %10.1f ns/tunable\n", "tunables from cache", load_ms, load_ms * 1e6 / num_tunables);
+    return(0);
+}
+
+// raw 'value' of every 'key = value' line, as the parser hands it to parse_value()
+static std::vector<std::string> collect_values(const char *config_file)
+{
+    config_mapped_file_t mapped_file(config_file);
+    std::string_view buffer = mapped_file.view();
+    std::vector<std::string> values;
+    size_t pos = 0;
+    while (pos < buffer.size()) {
+        size_t eol = buffer.find('\n', pos);
+        if (eol == std::string_view::npos)
+            eol = buffer.size();
+        std::string_view line = svtrim(sv_remove_trailing_comment(buffer.substr(pos, eol - pos)));
+        pos = eol + 1;
+        size_t eq = line.find('=');
+        if (line.empty() || line[0] == '[' || eq == std::string_view::npos)
+            continue;
+        std::string_view value = svtrim(line.substr(eq + 1));
+        if (!value.empty())
+            values.emplace_back(value);
+    }
+    return values;
+}
+
+// same type and encoding from both classifiers, or both throw
+static bool same_classification(const std::string &v)
+{
+    config_section_value_t a, b;
+    bool a_throws = false, b_throws = false;
+    try { a = config_section_value_t::parse_value(v); } catch (...) { a_throws = true; }
+    try { b = config_section_value_t::parse_value_probing(v); } catch (...) { b_throws = true; }
+    if (a_throws || b_throws)
+        return a_throws == b_throws;
+    config_value_bytes_t ab = a.get_bytes(), bb = b.get_bytes();
+    return a.get_type() == b.get_type() && ab.size() == bb.size() &&
+           (ab.size() == 0 || memcmp(ab.data(), bb.data(), ab.size()) == 0);
+}
+
+// single pass parse_value() against the exception driven parse_value_probing()
+static int benchmark_classify(const char *config_file, int iterations)
+{
+    std::vector<std::string> values = collect_values(config_file);
+    // corner cases of the type precedence, on top of what the file has. Values
+    // no type accepts are left out, both classifiers assert on them
+    const char *corner_cases[] = {
+         "1", "-1", "+1", "1.5", "2x", ".5", "-.5e3", "1e", "inf", "nan", "NaN(1)", "0x1p3", "1e-50",
+         "99999999999", ".1e5", "(4)", "(1,4)", "(8,0,-2)", "(1,)", "(1, x)", "[1]", "[1,]",
+         "[1, 2 ,3]", "[1.5, 2]", "[2, 1.5]", "[2, .5]", "[.5, 2]", "[2, inf]", "['a', \"b\"]", "[']", "'abc'", "\" a b \"", "'",
+         "[0x10, 1]", "[0x10, 1.5]", "(0, 1000000)", "(-5)", "(3, 3)", "(0, 10, 0)", "(10, 0, -3)",
+         "(-2147483647, 2147483647, 1073741824)",
+    };
+    for (const char *v : corner_cases)
+         values.emplace_back(v);
+
+    size_t mismatches = 0;
+    for (const auto &v : values) {
+         if (!same_classification(v)) {
+              if (mismatches++ < 10)
+                   fprintf(stdout, "classification differs for: %s\n", v.c_str());
+         }
+    }
+    if (mismatches != 0) {
+         fprintf(stdout, "%zu values classified differently !\n", mismatches);
+         return(-1);
+    }
+    // lazy ranges against expanding them like the range encoder used to
+    for (const auto &v : values) {
+         config_section_value_t value;
+         try { value = config_section_value_t::parse_value(v); } catch (...) { continue; }
+         if (value.get_type() != config_section_value_type_enum::config_section_value_type_range)
+              continue;
+         config_value_range_t range = value.get_range();
+         std::vector<int> expanded;
+         if (range.get_step() > 0)
+              for (int64_t i = range.get_start(); i < range.get_end(); i += range.get_step())
+                   expanded.push_back((int)i);
+         else if (range.get_step() < 0)
+              for (int64_t i = range.get_start(); i > range.get_end(); i += range.get_step())
+                   expanded.push_back((int)i);
+         size_t position = 0;
+         bool same = range.size() == expanded.size() && range.to_vector() == expanded;
+         for (int element : range)
+              same &= position < expanded.size() && element == expanded[position++];
+         if (!same || position != expanded.size()) {
+              fprintf(stdout, "range elements differ for: %s\n", v.c_str());
+              return(-1);
+         }
+    }
+    // the probing classifier throws on the non-numeric ones, keep only what parses
+    std::vector<std::string> valid_values;
+    for (const auto &v : values) {
+         try {
+              config_section_value_t::parse_value(v);
+              valid_values.push_back(v);
+         } catch (...) {
+         }
+    }
+    fprintf(stdout, "%s: %zu values, %d iterations\n", config_file, valid_values.size(), iterations);
+
+    double probing_ms = time_ms([&]() {
+         for (const auto &v : valid_values)
+              config_section_value_t::parse_value_probing(v);
+    }, iterations);
+    double single_pass_ms = time_ms([&]() {
+         for (const auto &v : valid_values)
+              config_section_value_t::parse_value(v);
+    }, iterations);
+    fprintf(stdout, "%-24s %10.3f ms %10.1f ns/value\n", "probing classifier", probing_ms, probing_ms * 1e6 / valid_values.size());
+    fprintf(stdout, "%-24s %10.3f ms %10.1f ns/value\n", "single pass classifier", single_pass_ms, single_pass_ms * 1e6 / valid_values.size());
+    return(0);
+}
+
+static size_t read_gzip_file(const std::string &file_name, std::string &text)
+{
+    config_gzip_reader_t reader(file_name);
+    char block[64 * 1024];
+    text.clear();
+    for (size_t length; (length = reader.read(block, sizeof(block))) != 0;)
+         text.append(block, length);
+    return text.size();
+}
+
+// parsing a gzip copy of the file straight through the streaming inflate,
+// against inflating it to disk first and parsing the inflated file
+static int benchmark_gzip(const char *config_file, int iterations)
+{
+    std::string gzip_file = std::string(config_file) + ".gz";
+    std::string inflated_file = gzip_file + ".inflated";
+    config_mapped_file_t mapped_file(config_file);
+    size_t bytes = mapped_file.size();
+
+    double deflate_ms = time_ms([&]() {
+         config_ofstream_t ofs(gzip_file);
+         ofs.write(mapped_file.data(), bytes);
+         ofs.close();
+    }, 1);
+    uint64_t gzip_bytes = 0;
+    int64_t mtime_ns;
+    config_binary_stat_file(gzip_file, gzip_bytes, mtime_ns);
+
+    config_content_t content = config_parser_t(config_file).parse();
+    if (!same_content(content, config_parser_t(gzip_file).parse())) {
+         fprintf(stdout, "plain and gzip parse results differ !\n");
+         return(-1);
+    }
+    // output_configurations() through a gzip stream, once inflated, is the plain output
+    std::vector<igemm_gtc_tunable_t> tunables = igemm_gtc_tunable_from_config(content);
+    {
+         config_ofstream_t plain_ofs(inflated_file);
+         output_configurations(tunables, "k0xk1ExC0xC1", "K0xK1ExN0xN1B", plain_ofs);
+         config_ofstream_t gzip_ofs(inflated_file + ".gz");
+         output_configurations(tunables, "k0xk1ExC0xC1", "K0xK1ExN0xN1B", gzip_ofs);
+    }
+    std::string inflated_output;
+    read_gzip_file(inflated_file + ".gz", inflated_output);
+    if (config_mapped_file_t(inflated_file).view() != inflated_output) {
+         fprintf(stdout, "plain and gzip configurations output differ !\n");
+         return(-1);
+    }
+    unlink((inflated_file + ".gz").c_str());
+    size_t num_sections = content.size();
+    fprintf(stdout, "%s: %zu bytes, %llu compressed (%.1fx), %zu sections, %d iterations\n", config_file, bytes,
+            (unsigned long long)gzip_bytes, (double)bytes / gzip_bytes, num_sections, iterations);
+
+    size_t parsed_sections = 0;
+    auto count_section = [&](config_section_t &&section) { (void)section; parsed_sections++; };
+    double plain_ms = time_ms([&]() { config_parser_t(config_file).parse_sections(count_section); }, iterations);
+    double inflate_then_parse_ms = time_ms([&]() {
+         config_gzip_reader_t reader(gzip_file);
+         std::ofstream ofs(inflated_file, std::ofstream::out | std::ofstream::binary);
+         std::vector<char> block(1024 * 1024);
+         for (size_t length; (length = reader.read(block.data(), block.size())) != 0;)
+              ofs.write(block.data(), length);
+         ofs.close();
+         config_parser_t(inflated_file).parse_sections(count_section);
+    }, iterations);
+    double streaming_ms = time_ms([&]() { config_parser_t(gzip_file).parse_sections(count_section); }, iterations);
+    unlink(inflated_file.c_str());
+    unlink(gzip_file.c_str());
+
+    fprintf(stdout, "%-24s %10.3f ms\n", "deflate to .gz", deflate_ms);
+    report_throughput("parse (plain)", plain_ms, bytes, num_sections);
+    report_throughput("inflate to disk + parse", inflate_then_parse_ms, bytes, num_sections);
+    report_throughput("streaming inflate parse", streaming_ms, bytes, num_sections);
+    fprintf(stdout, "(throughput in text MB/s, %zu sections parsed)\n", parsed_sections);
+    return(0);
+}
+
+// typical filters of the tools, sections matching a macro tile or nxe
+template <typename content_t>
+static size_t count_matching_sections(const content_t &content, int m_per_block, int n_per_block)
+{
+    const igemm_gtc_tunable_keys_t &keys = igemm_gtc_tunable_keys_t::get();
+    size_t num_matching = 0;
+    for (const auto &sec : content) {
+         if (!igemm_gtc_is_tunable_section(sec))
+              continue;
+         if (m_per_block < 0)
+              num_matching += sec.count(keys.nxe) && sec.at(keys.nxe).get_int() == 0;
+         else
+              num_matching += sec.at(keys.gemm_m_per_block).get_int() == m_per_block &&
+                              sec.at(keys.gemm_n_per_block).get_int() == n_per_block;
+    }
+    return num_matching;
+}
+
+// queries touching a few keys, through the lazy index against a full parse
+static int benchmark_lazy(const char *config_file, int iterations)
+{
+    config_content_t content = config_parser_t(config_file).parse();
+    {
+         config_lazy_content_t lazy(config_file);
+         if (!same_content(content, lazy.to_content())) {
+              fprintf(stdout, "full and lazy parse results differ !\n");
+              return(-1);
+         }
+    }
+    config_lazy_content_t lazy(config_file);
+    size_t num_tiles = count_matching_sections(lazy, 256, 128);
+    size_t num_nxe = count_matching_sections(lazy, -1, -1);
+    if (num_tiles != count_matching_sections(content, 256, 128) || num_nxe != count_matching_sections(content, -1, -1) ||
+        igemm_gtc_tunable_from_config(lazy).size() != igemm_gtc_tunable_from_config(content).size()) {
+         fprintf(stdout, "full and lazy queries differ !\n");
+         return(-1);
+    }
+    config_lazy_content_t queried(config_file);
+    count_matching_sections(queried, 256, 128);
+    size_t num_values = 0;
+    for (const auto &sec : content)
+         num_values += sec.size();
+    fprintf(stdout, "%s: %zu sections, %zu values, %zu 256x128 tiles, %zu nxe==0, %d iterations\n", config_file,
+            content.size(), num_values, num_tiles, num_nxe, iterations);
+    fprintf(stdout, "%-24s %10zu values decoded by the tile query\n", "lazy", queried.num_decoded());
+
+    size_t bytes = config_mapped_file_t(config_file).size();
+    double full_ms = time_ms([&]() { config_parser_t(config_file).parse(); }, iterations);
+    double index_ms = time_ms([&]() { config_lazy_content_t l(config_file); }, iterations);
+    double full_tile_ms = time_ms([&]() { count_matching_sections(config_parser_t(config_file).parse(), 256, 128); }, iterations);
+    double lazy_tile_ms = time_ms([&]() { count_matching_sections(config_lazy_content_t(config_file), 256, 128); }, iterations);
+    double full_nxe_ms = time_ms([&]() { count_matching_sections(config_parser_t(config_file).parse(), -1, -1); }, iterations);
+    double lazy_nxe_ms = time_ms([&]() { count_matching_sections(config_lazy_content_t(config_file), -1, -1); }, iterations);
+    report_throughput("full parse", full_ms, bytes, content.size());
+    report_throughput("lazy index", index_ms, bytes, content.size());
+    report_throughput("tile query, full", full_tile_ms, bytes, content.size());
+    report_throughput("tile query, lazy", lazy_tile_ms, bytes, content.size());
+    report_throughput("nxe query, full", full_nxe_ms, bytes, content.size());
+    report_throughput("nxe query, lazy", lazy_nxe_ms, bytes, content.size());
+    return(0);
+}
+
+// the key by key conversion igemm_gtc_tunable_from_section() was, before going
+// through the schema. Kept as the reference the binder has to match.
+template <typename section_t>
+static std::string fma_type_by_lookups(std::string arch_string, const section_t &sec){
+    const igemm_gtc_tunable_keys_t &keys = igemm_gtc_tunable_keys_t::get();
+    if(sec.count(keys.gemm_m_per_thread) > 0 && sec.count(keys.gemm_n_per_thread) > 0){
+        if(arch_string == "gfx900")
+            return IGEMM_GTC_TUNABLE_FMA_TYPE_MAC;
+        if(arch_string == "gfx906")
+            return IGEMM_GTC_TUNABLE_FMA_TYPE_DLOPS;
+        if(arch_string == "gfx908")
+            return IGEMM_GTC_TUNABLE_FMA_TYPE_DLOPS;
+    }else if(sec.count(keys.wave_tile_m) > 0 && sec.count(keys.wave_tile_n) > 0){
+        assert(arch_string == "gfx908");
+        return IGEMM_GTC_TUNABLE_FMA_TYPE_XDLOPS;
+    }
+    return IGEMM_GTC_TUNABLE_FMA_TYPE_NA;
+}
+
+template <typename section_t>
+static igemm_gtc_tunable_t tunable_by_lookups(const std::string &arch_string, const section_t &sec)
+{
+    const igemm_gtc_tunable_keys_t &keys = igemm_gtc_tunable_keys_t::get();
+    igemm_gtc_tunable_t tunable;
+    tunable.tensor_layout            = sec.count(keys.tensor_layout) > 0 ? sec.at(keys.tensor_layout).get_string_view() : std::string_view("nchw");
+    tunable.gemm_m_per_block         = sec.at(keys.gemm_m_per_block).get_int();
+    tunable.gemm_n_per_block         = sec.at(keys.gemm_n_per_block).get_int();
+    tunable.gemm_k_per_block         = sec.at(keys.gemm_k_per_block).get_int();
+    tunable.fma_type                 = fma_type_by_lookups(arch_string, sec);
+    tunable.precision                = sec.at(keys.precision).get_string_view();
+    assert(tunable.fma_type != IGEMM_GTC_TUNABLE_FMA_TYPE_NA);
+    if(tunable.fma_type == IGEMM_GTC_TUNABLE_FMA_TYPE_MAC || tunable.fma_type == IGEMM_GTC_TUNABLE_FMA_TYPE_DLOPS){
+        tunable.gemm_m_per_thread        = sec.at(keys.gemm_m_per_thread).get_int();
+        tunable.gemm_m_level0_cluster    = sec.at(keys.gemm_m_level0_cluster).get_int();
+        tunable.gemm_m_level1_cluster    = sec.at(keys.gemm_m_level1_cluster).get_int();
+        tunable.gemm_n_per_thread        = sec.at(keys.gemm_n_per_thread).get_int();
+        tunable.gemm_n_level0_cluster    = sec.at(keys.gemm_n_level0_cluster).get_int();
+        tunable.gemm_n_level1_cluster    = sec.at(keys.gemm_n_level1_cluster).get_int();
+    }else{
+        tunable.wave_tile_m              = sec.at(keys.wave_tile_m).get_int();
+        tunable.wave_step_m              = sec.at(keys.wave_step_m).get_int();
+        tunable.wave_repeat_m            = sec.at(keys.wave_repeat_m).get_int();
+        tunable.wave_tile_n              = sec.at(keys.wave_tile_n).get_int();
+        tunable.wave_step_n              = sec.at(keys.wave_step_n).get_int();
+        tunable.wave_repeat_n            = sec.at(keys.wave_repeat_n).get_int();
+        if(tunable.precision == "fp32")
+            tunable.wave_tile_k          = sec.count(keys.wave_tile_k) > 0 ? sec.at(keys.wave_tile_k).get_int() : 1;
+        else if(tunable.precision == "fp16")
+            tunable.wave_tile_k          = sec.count(keys.wave_tile_k) > 0 ? sec.at(keys.wave_tile_k).get_int() : 4;
+        else if(tunable.precision == "bf16")
+            tunable.wave_tile_k          = sec.count(keys.wave_tile_k) > 0 ? sec.at(keys.wave_tile_k).get_int() : 2;
+        else
+            tunable.wave_tile_k          = sec.count(keys.wave_tile_k) > 0 ? sec.at(keys.wave_tile_k).get_int() : 1;
+    }
+    tunable.tensor_a_thread_lengths  = sec.at(keys.tensor_a_thread_lengths).get_list_int_view().to_vector();
+    tunable.tensor_a_cluster_lengths = sec.at(keys.tensor_a_cluster_lengths).get_list_int_view().to_vector();
+    tunable.tensor_b_thread_lengths  = sec.at(keys.tensor_b_thread_lengths).get_list_int_view().to_vector();
+    tunable.tensor_b_cluster_lengths = sec.at(keys.tensor_b_cluster_lengths).get_list_int_view().to_vector();
+    tunable.direction                = sec.at(keys.direction).get_string_view();
+    //tunable.precision                = sec.at(keys.precision).get_string();
+    tunable.nxb                      = sec.at(keys.nxb).get_int();
+    tunable.nxe                      = sec.at(keys.nxe).get_int();
+    tunable.gemm_m_unmerge_cluster   = sec.count(keys.gemm_m_unmerge_cluster) > 0 ? sec.at(keys.gemm_m_unmerge_cluster).get_int() : 0;
+    tunable.gemm_n_unmerge_cluster   = sec.count(keys.gemm_n_unmerge_cluster) > 0 ? sec.at(keys.gemm_n_unmerge_cluster).get_int() : 0;
+    tunable.gemm_k_unmerge_cluster   = sec.count(keys.gemm_k_unmerge_cluster) > 0 ? sec.at(keys.gemm_k_unmerge_cluster).get_int() : 0;
+    tunable.multihead                = sec.count(keys.multihead) > 0 ? sec.at(keys.multihead).get_int() : 0;
+    int default_source_access_order  = tunable.direction == "fwd" ? 1 : 0;
+    tunable.source_access_order      = sec.count(keys.source_access_order) > 0 ? sec.at(keys.source_access_order).get_int() : default_source_access_order;
+    tunable.gemm_k_global_split      = sec.count(keys.gemm_k_global_split) > 0 ? sec.at(keys.gemm_k_global_split).get_int() : 0;
+
+    return tunable;
+}
+
+static std::vector<igemm_gtc_tunable_t> tunables_by_lookups(const config_content_t &content)
+{
+    std::vector<igemm_gtc_tunable_t> tunables;
+    std::string arch_string = content.get_section("codegen").at("arch").get_string();
+    for (const auto &sec : content) {
+         if (igemm_gtc_is_tunable_section(sec))
+              tunables.push_back(tunable_by_lookups(arch_string, sec));
+         else if (igemm_gtc_is_tunable_space_name(sec.get_name()))
+              igemm_gtc_tunable_expand_space(arch_string, sec, [&](igemm_gtc_tunable_t &&t) { tunables.push_back(std::move(t)); });
+    }
+    return tunables;
+}
+
+// every member igemm_gtc_tunable_from_section() sets, for the fma group of the tunables
+static bool same_tunable(const igemm_gtc_tunable_t &a, const igemm_gtc_tunable_t &b)
+{
+    bool same = a.tensor_layout == b.tensor_layout && a.gemm_m_per_block == b.gemm_m_per_block &&
+                a.gemm_n_per_block == b.gemm_n_per_block && a.gemm_k_per_block == b.gemm_k_per_block &&
+                a.fma_type == b.fma_type && a.tensor_a_thread_lengths == b.tensor_a_thread_lengths &&
+                a.tensor_a_cluster_lengths == b.tensor_a_cluster_lengths &&
+                a.tensor_b_thread_lengths == b.tensor_b_thread_lengths &&
+                a.tensor_b_cluster_lengths == b.tensor_b_cluster_lengths && a.direction == b.direction &&
+                a.precision == b.precision && a.nxb == b.nxb && a.nxe == b.nxe &&
+                a.gemm_m_unmerge_cluster == b.gemm_m_unmerge_cluster &&
+                a.gemm_n_unmerge_cluster == b.gemm_n_unmerge_cluster &&
+                a.gemm_k_unmerge_cluster == b.gemm_k_unmerge_cluster && a.multihead == b.multihead &&
+                a.source_access_order == b.source_access_order && a.gemm_k_global_split == b.gemm_k_global_split;
+    if (a.fma_type == IGEMM_GTC_TUNABLE_FMA_TYPE_XDLOPS)
+         return same && a.wave_tile_m == b.wave_tile_m && a.wave_step_m == b.wave_step_m &&
+                a.wave_repeat_m == b.wave_repeat_m && a.wave_tile_n == b.wave_tile_n && a.wave_step_n == b.wave_step_n &&
+                a.wave_repeat_n == b.wave_repeat_n && a.wave_tile_k == b.wave_tile_k;
+    return same && a.gemm_m_per_thread == b.gemm_m_per_thread && a.gemm_m_level0_cluster == b.gemm_m_level0_cluster &&
+           a.gemm_m_level1_cluster == b.gemm_m_level1_cluster && a.gemm_n_per_thread == b.gemm_n_per_thread &&
+           a.gemm_n_level0_cluster == b.gemm_n_level0_cluster && a.gemm_n_level1_cluster == b.gemm_n_level1_cluster;
+}
+
+static std::vector<igemm_gtc_tunable_t> bind_tunables(std::string_view buffer, bool &ok)
+{
+    std::vector<igemm_gtc_tunable_t> tunables;
+    ok = igemm_gtc_tunable_bind_buffer(buffer, [&](igemm_gtc_tunable_t &&tunable) {
+         tunables.push_back(std::move(tunable));
+    });
+    return tunables;
+}
+
+// the schema binder, over the text, over parsed sections and through
+// igemm_gtc_tunable_from_section(), against the key by key lookups
+static int benchmark_bind(const char *config_file, int iterations)
+{
+    config_mapped_file_t mapped_file(config_file);
+    config_content_t content = config_parser_t(config_file).parse();
+    std::vector<igemm_gtc_tunable_t> reference = tunables_by_lookups(content);
+    std::vector<igemm_gtc_tunable_t> converted = igemm_gtc_tunable_from_config(content);
+    bool ok;
+    std::vector<igemm_gtc_tunable_t> bound = bind_tunables(mapped_file.view(), ok);
+    bool same = ok && bound.size() == reference.size() && converted.size() == reference.size();
+    for (size_t i = 0; same && i < bound.size(); i++)
+         same = same_tunable(bound[i], reference[i]) && same_tunable(converted[i], reference[i]);
+    if (!same) {
+         fprintf(stdout, "bound and converted tunables differ !\n");
+         return(-1);
+    }
+
+    // defaults of a complete section, and the report of an incomplete one
+    const char *sections =
+         "[igemm_bwd_gtc]\n"
+         "gemm_m_per_block = 256\ngemm_n_per_block = 128\ngemm_k_per_block = 16\n"
+         "wave_tile_m = 32\nwave_step_m = 1\nwave_repeat_m = 2\nwave_tile_n = 32\nwave_step_n = 1\nwave_repeat_n = 2\n"
+         "tensor_a_thread_lengths = [1, 4, 4, 1]\ntensor_a_cluster_lengths = [1, 4, 1, 64]\n"
+         "tensor_b_thread_lengths = [1, 4, 2, 1]\ntensor_b_cluster_lengths = [1, 4, 1, 64]\n"
+         "direction = 'bwd'\nprecision = 'fp16'\nnxb = 1\nnxe = 0\n"
+         "[codegen]\narch = 'gfx908'\n"
+         "[igemm_fwd_gtc]\n"
+         "gemm_m_per_block = '256'\ngemm_n_per_block = 128\n"
+         "wave_tile_m = 32\nwave_step_m = 1\nwave_repeat_m = 2\nwave_tile_n = 32\nwave_step_n = 1\nwave_repeat_n = 2\n"
+         "tensor_a_thread_lengths = [1, 4, 4, 1]\ntensor_a_cluster_lengths = [1, 4, 1, 64]\n"
+         "tensor_b_thread_lengths = [1, 4, 2, 1]\ntensor_b_cluster_lengths = 64\n"
+         "direction = 'fwd'\nprecision = 'fp16'\nnxb = 1\nnxe = 0\nnxe = 1\n"
+         "[igemm_bwd_gtc]\n"
+         "gemm_m_per_block = 256\ngemm_n_per_block = 128\ngemm_k_per_block = 16\n"
+         "wave_tile_m = 32\nwave_step_m = 1\nwave_repeat_m = 2\nwave_tile_n = 32\nwave_step_n = 1\nwave_repeat_n = 2\n"
+         "tensor_a_thread_lengths = [1, 4, 4, 1]\ntensor_a_cluster_lengths = [1, 4, 1, 64]\n"
+         "tensor_b_thread_lengths = [1, 4, 2, 1]\ntensor_b_cluster_lengths = [1, 4, 1, 64]\n"
+         "direction = 'bwd'\nprecision = 32\nnxb = 1\nnxe = 0\n";
+    std::vector<igemm_gtc_tunable_t> checked = bind_tunables(sections, ok);
+    config_content_t checked_content = config_parser_t(config_file).parse_buffer(
+         std::string_view(sections, strstr(sections, "[igemm_fwd_gtc]") - sections));
+    if (ok || checked.size() != 1 ||
+        !same_tunable(checked[0], tunable_by_lookups("gfx908", checked_content.get_section("igemm_bwd_gtc")))) {
+         fprintf(stdout, "binder misses the errors of the section above, or the defaults !\n");
+         return(-1);
+    }
+    fprintf(stdout, "%s: %zu tunables, %d iterations\n", config_file, reference.size(), iterations);
+
+    double convert_ms = time_ms([&]() { tunables_by_lookups(content); }, iterations);
+    double bind_sections_ms = time_ms([&]() {
+         std::string arch_string = content.get_section("codegen").at("arch").get_string();
+         igemm_gtc_tunable_binder_t binder;
+         igemm_gtc_tunable_t tunable;
+         std::string error;
+         size_t num_tunables = 0;
+         for (const auto &sec : content) {
+              if (!igemm_gtc_is_tunable_section(sec))
+                   continue;
+              binder.begin();
+              for (const auto &kv : sec)
+                   binder.bind(kv.first, kv.second);
+              num_tunables += binder.finish(arch_string, tunable, error);
+         }
+         assert(num_tunables == reference.size());
+    }, iterations);
+    double parse_convert_ms = time_ms([&]() {
+         igemm_gtc_tunable_from_config(config_parser_t(config_file).parse());
+    }, iterations);
+    double bind_text_ms = time_ms([&]() { bind_tunables(mapped_file.view(), ok); }, iterations);
+    size_t n = reference.size();
+    fprintf(stdout, "%-24s %10.3f ms %10.1f ns/tunable\n", "convert by lookups", convert_ms, convert_ms * 1e6 / n);
+    fprintf(stdout, "%-24s %10.3f ms %10.1f ns/tunable\n", "bind parsed sections", bind_sections_ms, bind_sections_ms * 1e6 / n);
+    fprintf(stdout, "%-24s %10.3f ms %10.1f ns/tunable\n", "parse + convert", parse_convert_ms, parse_convert_ms * 1e6 / n);
+    fprintf(stdout, "%-24s %10.3f ms %10.1f ns/tunable\n", "bind while scanning", bind_text_ms, bind_text_ms * 1e6 / n);
+    return(0);
+}
+
+static std::string write_text(const config_content_t &content, bool schema_order)
+{
+    std::ostringstream text;
+    config_text_writer_t writer(text);
+    if (schema_order)
+         igemm_gtc_tunable_set_key_order(writer);
+    writer.write(content);
+    writer.flush();
+    return text.str();
+}
+
+// the canonical writer reads back the same values, and rewrites the same bytes
+static bool round_trips(const config_content_t &content, bool schema_order)
+{
+    std::string text = write_text(content, schema_order);
+    config_content_t parsed = config_parser_t("").parse_buffer(text);
+    return same_content(content, parsed) && write_text(parsed, schema_order) == text;
+}
+
+// the canonical writer against writing every key through iostreams, as dump() does with printf
+static int benchmark_write(const char *config_file, int iterations)
+{
+    std::string output_file = std::string(config_file) + ".written";
+    config_content_t content = config_parser_t(config_file).parse();
+    const char *values =
+         "[values]\n"
+         "int = -7\nfloat = .5\nfloats = [.1, -.125, 3.25e38, .0, inf]\nrange = (2, 11, 3)\nshort_range = (4)\n"
+         "strings = ['a', \"b c\" , 'd']\nstring = 'x y'\nnumbers = [1, -2, 2147483647, -2147483648]\n";
+    config_content_t values_content = config_parser_t(config_file).parse_buffer(values);
+    if (!round_trips(content, false) || !round_trips(content, true) || !round_trips(values_content, false)) {
+         fprintf(stdout, "written content does not read back the same !\n");
+         return(-1);
+    }
+    // strings the parser would cut or split are refused, the rest is written
+    config_content_t unwritable;
+    for (const char *str : {"x;y", "a=b", "c#d", "e\nf", "g,h"}) {
+         bool list = str == std::string("g,h");
+         config_section_t section(list ? "list" : str);
+         std::vector<uint8_t> bytes(str, str + strlen(str) + list);
+         section.at(config_key_t("value")) = config_section_value_t(
+              list ? config_section_value_type_enum::config_section_value_type_list_string
+                   : config_section_value_type_enum::config_section_value_type_string, config_value_bytes_t(bytes));
+         unwritable.add_section(std::move(section));
+    }
+    unwritable.add_section(values_content.get_section("values"));
+    std::ostringstream refused;
+    bool written;
+    {
+         config_text_writer_t writer(refused);
+         written = writer.write(unwritable);
+    }
+    config_content_t read_back = config_parser_t(config_file).parse_buffer(refused.str());
+    if (written || read_back.size() != 1 || refused.str() != write_text(values_content, false)) {
+         fprintf(stdout, "strings the parser can not read back are written !\n");
+         return(-1);
+    }
+
+    std::string text = write_text(content, true);
+    config_binary_writer_t binary_writer;
+    binary_writer.add_content(content);
+    config_binary_reader_t reader;
+    bool ok = reader.open(binary_writer.get_image());
+    std::ostringstream binary_text, lazy_text;
+    {
+         config_text_writer_t writer(binary_text), lazy_writer(lazy_text);
+         igemm_gtc_tunable_set_key_order(writer);
+         igemm_gtc_tunable_set_key_order(lazy_writer);
+         writer.write(reader);
+         lazy_writer.write(config_lazy_content_t(config_file));
+    }
+    if (!ok || binary_text.str() != text || lazy_text.str() != text) {
+         fprintf(stdout, "binary, lazy and parsed contents write differently !\n");
+         return(-1);
+    }
+    fprintf(stdout, "%s: %zu sections, %zu bytes written, %d iterations\n", config_file, content.size(),
+            text.size(), iterations);
+
+    double iostream_ms = time_ms([&]() {
+         std::ofstream ofs(output_file);
+         for (const auto &section : content) {
+              ofs << "[" << section.get_name() << "]" << std::endl;
+              for (const auto &kv : section)
+                   ofs << kv.first.str() << " = " << kv.second.serialize() << std::endl;
+              ofs << std::endl;
+         }
+    }, iterations);
+    double writer_ms = time_ms([&]() {
+         std::ofstream ofs(output_file);
+         config_text_writer_t writer(ofs);
+         igemm_gtc_tunable_set_key_order(writer);
+         writer.write(content);
+    }, iterations);
+    unlink(output_file.c_str());
+    report_throughput("iostream per key", iostream_ms, text.size(), content.size());
+    report_throughput("canonical writer", writer_ms, text.size(), content.size());
+    return(0);
+}
+
+// with the sorter reorder_configs_* uses for the tunables
+template <typename tunable_t>
+static void sort_tunables(std::vector<tunable_t> &tunables, const std::string &direction, const std::string &layout)
+{
+    if (direction == "fwd")
+         std::sort(tunables.begin(), tunables.end(), FwdNchwSorter<tunable_t>);
+    else if (layout == "nchw")
+         std::sort(tunables.begin(), tunables.end(), BwdNchwSorter<tunable_t>);
+    else
+         std::sort(tunables.begin(), tunables.end(), BwdNhwcSorter<tunable_t>);
+}
+
+// igemm_gtc_packed_tunable_t against igemm_gtc_tunable_t: conversions, memory, copies and sorting,
+// and the duplicates dropped by its hash
+static int benchmark_packed(const char *config_file, int iterations)
+{
+    std::vector<igemm_gtc_tunable_t> tunables = igemm_gtc_tunable_from_config(config_parser_t(config_file).parse());
+    if (tunables.empty()) {
+         fprintf(stdout, "%s has no tunables !\n", config_file);
+         return(-1);
+    }
+    std::vector<igemm_gtc_packed_tunable_t> packed = igemm_gtc_tunable_pack(tunables);
+    for (size_t i = 0; i < tunables.size(); i++) {
+         if (!same_tunable(tunables[i], igemm_gtc_tunable_unpack(packed[i]))) {
+              fprintf(stdout, "tunable %zu does not unpack to itself !\n", i);
+              return(-1);
+         }
+    }
+    igemm_gtc_packed_tunable_t refused;
+    igemm_gtc_tunable_t unfit = tunables[0];
+    unfit.tensor_a_thread_lengths.pop_back();
+    bool ok = !igemm_gtc_tunable_pack(unfit, refused);
+    unfit = tunables[0];
+    unfit.precision = "fp64";
+    ok = ok && !igemm_gtc_tunable_pack(unfit, refused);
+    unfit = tunables[0];
+    unfit.nxb = 256;
+    ok = ok && !igemm_gtc_tunable_pack(unfit, refused);
+    if (!ok) {
+         fprintf(stdout, "tunables not fitting igemm_gtc_packed_tunable_t are packed !\n");
+         return(-1);
+    }
+
+    // the packed tunables are their own keys: a tunable twice is dropped once, distinct ones stay
+    std::vector<igemm_gtc_packed_tunable_t> twice = packed;
+    twice.insert(twice.end(), packed.begin(), packed.end());
+    std::vector<igemm_gtc_packed_tunable_t> unique = packed;
+    size_t num_unique = unique.size() - igemm_gtc_tunable_drop_duplicates(unique);
+    std::unordered_set<uint64_t> hashes;
+    for (const auto &tunable : unique)
+         hashes.insert(igemm_gtc_tunable_hash(tunable));
+    if (igemm_gtc_tunable_drop_duplicates(twice) != packed.size() + packed.size() - num_unique ||
+        twice != unique || hashes.size() != unique.size()) {
+         fprintf(stdout, "duplicated tunables are not dropped !\n");
+         return(-1);
+    }
+
+    std::string direction = tunables[0].direction, layout = tunables[0].tensor_layout;
+    std::vector<igemm_gtc_tunable_t> sorted = tunables;
+    std::vector<igemm_gtc_packed_tunable_t> packed_sorted = packed;
+    sort_tunables(sorted, direction, layout);
+    sort_tunables(packed_sorted, direction, layout);
+    for (size_t i = 0; i < sorted.size(); i++) {
+         if (!same_tunable(sorted[i], igemm_gtc_tunable_unpack(packed_sorted[i]))) {
+              fprintf(stdout, "packed tunables sort differently !\n");
+              return(-1);
+         }
+    }
+
+    // into empty vectors, so every byte of the copies is counted
+    size_t n = tunables.size();
+    sorted = std::vector<igemm_gtc_tunable_t>();
+    packed_sorted = std::vector<igemm_gtc_packed_tunable_t>();
+    size_t live_bytes = num_live_bytes;
+    size_t tunable_allocations = count_allocations([&]() { sorted = tunables; });
+    size_t tunable_bytes = num_live_bytes - live_bytes;
+    live_bytes = num_live_bytes;
+    size_t packed_allocations = count_allocations([&]() { packed_sorted = packed; });
+    size_t packed_bytes = num_live_bytes - live_bytes;
+    fprintf(stdout, "%s: %zu tunables, %zu distinct, %d iterations\n", config_file, n, num_unique, iterations);
+    fprintf(stdout, "%-24s %10zu bytes/tunable %8.2f allocations/tunable\n", "igemm_gtc_tunable_t",
+            tunable_bytes / n, (double)tunable_allocations / n);
+    fprintf(stdout, "%-24s %10zu bytes/tunable %8.2f allocations/tunable\n", "packed",
+            packed_bytes / n, (double)packed_allocations / n);
+
+    double copy_ms = time_ms([&]() { sorted = tunables; }, iterations);
+    double packed_copy_ms = time_ms([&]() { packed_sorted = packed; }, iterations);
+    double sort_ms = time_ms([&]() {
+         sorted = tunables;
+         sort_tunables(sorted, direction, layout);
+    }, iterations);
+    double packed_sort_ms = time_ms([&]() {
+         packed_sorted = packed;
+         sort_tunables(packed_sorted, direction, layout);
+    }, iterations);
+    double dedup_ms = time_ms([&]() {
+         packed_sorted = packed;
+         igemm_gtc_tunable_drop_duplicates(packed_sorted);
+    }, iterations);
+    fprintf(stdout, "%-24s %10.3f ms %10.1f ns/tunable\n", "copy", copy_ms, copy_ms * 1e6 / n);
+    fprintf(stdout, "%-24s %10.3f ms %10.1f ns/tunable\n", "copy, packed", packed_copy_ms, packed_copy_ms * 1e6 / n);
+    fprintf(stdout, "%-24s %10.3f ms %10.1f ns/tunable\n", "copy + sort", sort_ms, sort_ms * 1e6 / n);
+    fprintf(stdout, "%-24s %10.3f ms %10.1f ns/tunable\n", "copy + sort, packed", packed_sort_ms, packed_sort_ms * 1e6 / n);
+    fprintf(stdout, "%-24s %10.3f ms %10.1f ns/tunable\n", "copy + dedup, packed", dedup_ms, dedup_ms * 1e6 / n);
+    return(0);
+}
+
+// igemm_gtc_tunable_table_t, vectorized and scalar, against walking the igemm_gtc_tunable_t of the
+// file, on the tunables of the file repeated to a million rows
+static int benchmark_table(const char *config_file, int iterations)
+{
+    std::vector<igemm_gtc_tunable_t> tunables = igemm_gtc_tunable_load(config_file);
+    if (tunables.empty()) {
+         fprintf(stdout, "%s has no tunables !\n", config_file);
+         return(-1);
+    }
+    std::vector<igemm_gtc_packed_tunable_t> packed = igemm_gtc_tunable_pack(tunables);
+    igemm_gtc_tunable_table_t table;
+    size_t n = tunables.size();
+    size_t num_rows = (1000000 + n - 1) / n * n;
+    while (table.size() < num_rows)
+         table.append(packed);
+    for (size_t r = 0; r < num_rows; r += 997) {
+         if (table.row(r) != packed[r % n]) {
+              fprintf(stdout, "row %zu of the table is not the tunable stored !\n", r);
+              return(-1);
+         }
+    }
+    bwd_nhwc_config generator;
+    igemm_gtc_tunable_table_t generated(generator.make_configs("fp32"));
+    igemm_gtc_table_query_t any_nhwc;
+    std::string error;
+    if (!any_nhwc.compile("tensor_layout == nhwc", error) || generated.select(any_nhwc).size() != generated.size() ||
+        generated.size() == 0) {
+         fprintf(stdout, "the generated bwd nhwc tunables are not all nhwc !\n");
+         return(-1);
+    }
+
+    struct query_case_t {
+         const char *text;
+         std::function<bool(const igemm_gtc_tunable_t &)> reference;
+    };
+    std::vector<query_case_t> cases = {
+         {"gemm_n_per_block >= 64 && nxe == 0 && tensor_b_thread_lengths.3 == 4", [](const igemm_gtc_tunable_t &t) {
+              return t.gemm_n_per_block >= 64 && t.nxe == 0 && t.tensor_b_thread_lengths[3] == 4; }},
+         {"gemm_m_per_block<128&&wave_repeat_n!=1||gemm_k_global_split>0&&nxb<=4", [](const igemm_gtc_tunable_t &t) {
+              return (t.gemm_m_per_block < 128 && t.wave_repeat_n != 1) || (t.gemm_k_global_split > 0 && t.nxb <= 4); }},
+         {"precision == fp32 && fma_type == xdlops && tensor_a_cluster_lengths.3 > 16", [](const igemm_gtc_tunable_t &t) {
+              return t.precision == "fp32" && t.fma_type == "xdlops" && t.tensor_a_cluster_lengths[3] > 16; }},
+         {"gemm_k_per_block > 70000 || nxb >= -3 && nxe != 99999", [](const igemm_gtc_tunable_t &t) {
+              (void)t; return true; }},
+         {"gemm_k_per_block < 0", [](const igemm_gtc_tunable_t &t) { (void)t; return false; }},
+    };
+    std::vector<igemm_gtc_table_query_t> queries(cases.size());
+    for (size_t q = 0; q < cases.size(); q++) {
+         if (!queries[q].compile(cases[q].text, error)) {
+              fprintf(stdout, "'%s' does not compile: %s\n", cases[q].text, error.c_str());
+              return(-1);
+         }
+         std::vector<uint32_t> reference;
+         for (size_t r = 0; r < num_rows; r++)
+              if (cases[q].reference(tunables[r % n]))
+                   reference.push_back(static_cast<uint32_t>(r));
+         if (table.select(queries[q], true) != reference || table.select(queries[q], false) != reference) {
+              fprintf(stdout, "'%s' selects other rows than the reference !\n", cases[q].text);
+              return(-1);
+         }
+    }
+    const char *broken[] = {"", "nx == 1", "nxb =< 1", "nxb == 1 &&", "precision == fp64", "nxb == 1 nxe == 0",
+                            "nxb == 1.5"};
+    for (const char *text : broken) {
+         if (igemm_gtc_table_query_t().compile(text, error)) {
+              fprintf(stdout, "'%s' compiles !\n", text);
+              return(-1);
+         }
+    }
+    fprintf(stdout, "%s: %zu tunables repeated to %zu rows, %zu generated, %d iterations\n", config_file, n, num_rows,
+            generated.size(), iterations);
+
+    for (size_t q = 0; q < cases.size(); q++) {
+         size_t selected = 0;
+         double walk_ms = time_ms([&]() {
+              std::vector<uint32_t> selection;
+              for (size_t r = 0; r < num_rows; r++)
+                   if (cases[q].reference(tunables[r % n]))
+                        selection.push_back(static_cast<uint32_t>(r));
+              selected = selection.size();
+         }, iterations);
+         double scalar_ms = time_ms([&]() { table.select(queries[q], false); }, iterations);
+         double vector_ms = time_ms([&]() { table.select(queries[q], true); }, iterations);
+         fprintf(stdout, "%s (%zu rows)\n", cases[q].text, selected);
+         fprintf(stdout, "    %-24s %10.3f ms\n", "walk igemm_gtc_tunable_t", walk_ms);
+         fprintf(stdout, "    %-24s %10.3f ms\n", "table (scalar)", scalar_ms);
+         fprintf(stdout, "    %-24s %10.3f ms\n", "table (vectorized)", vector_ms);
+    }
+    return(0);
+}
+
+// with the key of the sorter reorder_configs_* uses
+static void sort_tunables_keyed(std::vector<igemm_gtc_packed_tunable_t> &tunables,
+                                std::vector<igemm_gtc_tunable_attributes_t> &attributes,
+                                const std::string &direction, const std::string &layout)
+{
+    if (direction == "fwd")
+         igemm_gtc_tunable_sort(tunables, attributes, FwdNchwSortKey, FwdNchwSorter<igemm_gtc_packed_tunable_t>);
+    else if (layout == "nchw")
+         igemm_gtc_tunable_sort(tunables, attributes, BwdNchwSortKey, BwdNchwSorter<igemm_gtc_packed_tunable_t>);
+    else
+         igemm_gtc_tunable_sort(tunables, attributes, BwdNhwcSortKey, BwdNhwcSorter<igemm_gtc_packed_tunable_t>);
+}
+
+static size_t count_inexact_keys(const std::vector<igemm_gtc_packed_tunable_t> &tunables,
+                                 const std::vector<igemm_gtc_tunable_attributes_t> &attributes,
+                                 const std::string &direction, const std::string &layout)
+{
+    size_t inexact = 0;
+    for (size_t i = 0; i < tunables.size(); i++) {
+         if (direction == "fwd")
+              inexact += !FwdNchwSortKey(tunables[i], attributes[i]).exact;
+         else if (layout == "nchw")
+              inexact += !BwdNchwSortKey(tunables[i], attributes[i]).exact;
+         else
+              inexact += !BwdNhwcSortKey(tunables[i], attributes[i]).exact;
+    }
+    return inexact;
+}
+
+// the keyed sort gives the order of the sorter, the attributes following their tunables
+static bool same_sort(const std::vector<igemm_gtc_packed_tunable_t> &tunables, const std::string &direction,
+                      const std::string &layout, size_t &inexact)
+{
+    std::vector<igemm_gtc_packed_tunable_t> sorted = tunables, keyed = tunables;
+    std::vector<igemm_gtc_tunable_attributes_t> attributes = igemm_gtc_tunable_derive(keyed);
+    sort_tunables(sorted, direction, layout);
+    inexact = count_inexact_keys(keyed, attributes, direction, layout);
+    sort_tunables_keyed(keyed, attributes, direction, layout);
+    if (keyed != sorted)
+         return false;
+    for (size_t i = 0; i < keyed.size(); i++) {
+         igemm_gtc_tunable_attributes_t derived = igemm_gtc_tunable_derive(keyed[i]);
+         if (attributes[i].macro_tile != derived.macro_tile || attributes[i].lds_bytes != derived.lds_bytes ||
+             attributes[i].block_size != derived.block_size || attributes[i].vector_a != derived.vector_a ||
+             attributes[i].global_loads_a != derived.global_loads_a || attributes[i].mfma_per_k_step != derived.mfma_per_k_step)
+              return false;
+    }
+    return true;
+}
+
+// the derived attributes against computing them from igemm_gtc_tunable_t, and the keyed sort against the
+// sorters, on the tunables of the file repeated to a million entries and on the generated ones
+static int benchmark_attributes(const char *config_file, int iterations)
+{
+    std::vector<igemm_gtc_tunable_t> tunables = igemm_gtc_tunable_load(config_file);
+    if (tunables.empty()) {
+         fprintf(stdout, "%s has no tunables !\n", config_file);
+         return(-1);
+    }
+    std::vector<igemm_gtc_packed_tunable_t> packed = igemm_gtc_tunable_pack(tunables);
+    for (size_t i = 0; i < tunables.size(); i++) {
+         const igemm_gtc_tunable_t &t = tunables[i];
+         igemm_gtc_tunable_attributes_t attributes = igemm_gtc_tunable_derive(packed[i]);
+         int block_size = t.tensor_a_cluster_lengths[0] * t.tensor_a_cluster_lengths[1] *
+                          t.tensor_a_cluster_lengths[2] * t.tensor_a_cluster_lengths[3];
+         int data_bytes = t.precision == "fp32" ? 4 : 2;
+         if (attributes.block_size != block_size || attributes.waves != block_size / AMDGPU_WAVE_SIZE ||
+             attributes.macro_tile != static_cast<uint32_t>(t.gemm_m_per_block * t.gemm_n_per_block) ||
+             attributes.lds_bytes != static_cast<uint32_t>((t.gemm_m_per_block + t.gemm_n_per_block) * t.gemm_k_per_block * data_bytes) ||
+             attributes.vector_b != t.tensor_b_thread_lengths[3] ||
+             attributes.global_loads_b * attributes.vector_b != t.tensor_b_thread_lengths[0] * t.tensor_b_thread_lengths[1] *
+                                                                t.tensor_b_thread_lengths[2] * t.tensor_b_thread_lengths[3] ||
+             (t.fma_type == "xdlops" && attributes.mfma_per_k_step != t.wave_repeat_m * t.wave_step_m * t.wave_repeat_n *
+                                                                     t.wave_step_n * (t.gemm_k_per_block / t.wave_tile_k))) {
+              fprintf(stdout, "the attributes derived for tunable %zu are wrong !\n", i);
+              return(-1);
+         }
+    }
+    igemm_gtc_tunable_table_t table(packed);
+    igemm_gtc_table_query_t query;
+    std::string error;
+    if (!query.compile("block_size >= 256 && vector_b > 1", error)) {
+         fprintf(stdout, "the derived columns do not compile: %s\n", error.c_str());
+         return(-1);
+    }
+    size_t num_selected = 0;
+    for (size_t i = 0; i < packed.size(); i++) {
+         igemm_gtc_tunable_attributes_t attributes = igemm_gtc_tunable_derive(packed[i]);
+         num_selected += attributes.block_size >= 256 && attributes.vector_b > 1;
+    }
+    if (table.select(query).size() != num_selected) {
+         fprintf(stdout, "the derived columns select other rows than the attributes !\n");
+         return(-1);
+    }
+
+    std::string direction = tunables[0].direction, layout = tunables[0].tensor_layout;
+    size_t n = packed.size();
+    std::vector<igemm_gtc_packed_tunable_t> repeated;
+    repeated.reserve((1000000 + n - 1) / n * n);
+    while (repeated.size() < 1000000)
+         repeated.insert(repeated.end(), packed.begin(), packed.end());
+    size_t inexact = 0;
+    if (!same_sort(repeated, direction, layout, inexact)) {
+         fprintf(stdout, "the keyed sort does not give the order of the sorter !\n");
+         return(-1);
+    }
+    // values too large for their widths in the keys, every other comparison left to the sorter
+    std::vector<igemm_gtc_packed_tunable_t> oversized = packed;
+    for (size_t i = 0; i < oversized.size(); i += 3)
+         oversized[i].gemm_k_per_block = 8192 + 512 * (i % 5);
+    size_t oversized_inexact;
+    if (!same_sort(oversized, direction, layout, oversized_inexact) || oversized_inexact == 0) {
+         fprintf(stdout, "the keyed sort does not give the order of the sorter with inexact keys !\n");
+         return(-1);
+    }
+    // vector lengths over what the attributes hold, 256 and 300 must not compare equal
+    {
+         bwd_nhwc_config bwd_nhwc;
+         std::vector<igemm_gtc_packed_tunable_t> wide = bwd_nhwc.make_configs("fp16");
+         for (size_t i = 0; i < wide.size(); i += 2) {
+              wide[i].tensor_a_thread_lengths[1] = i % 4 == 0 ? 256 : 300;
+              wide[i].tensor_b_thread_lengths[3] = i % 6 == 0 ? 300 : 256;
+         }
+         size_t wide_inexact;
+         if (!same_sort(wide, "bwd", "nhwc", wide_inexact) || wide_inexact == 0) {
+              fprintf(stdout, "the keyed sort does not give the order of the sorter with vector lengths over 255 !\n");
+              return(-1);
+         }
+    }
+    for (const char *precision : {"fp32", "fp16"}) {
+         bwd_nchw_config bwd_nchw;
+         bwd_nhwc_config bwd_nhwc;
+         fwd_nchw_config fwd_nchw;     // fp32 divides by zero in getMaximumSlice_a_c1e()
+         size_t generated_inexact;
+         if (!same_sort(bwd_nchw.make_configs(precision), "bwd", "nchw", generated_inexact) ||
+             !same_sort(bwd_nhwc.make_configs(precision), "bwd", "nhwc", generated_inexact) ||
+             (precision == std::string("fp16") && !same_sort(fwd_nchw.make_configs(precision), "fwd", "nchw", generated_inexact))) {
+              fprintf(stdout, "the keyed sort does not give the order of the sorter on the generated %s tunables !\n", precision);
+              return(-1);
+         }
+    }
+
+    fprintf(stdout, "%s: %zu tunables repeated to %zu, %zu with an inexact key, %d iterations\n", config_file, n,
+            repeated.size(), inexact, iterations);
+    // the attributes derived once, as they are kept next to the tunables, the copies of both timed
+    std::vector<igemm_gtc_packed_tunable_t> sorted;
+    std::vector<igemm_gtc_tunable_attributes_t> attributes, sorted_attributes;
+    double derive_ms = time_ms([&]() { attributes = igemm_gtc_tunable_derive(repeated); }, iterations);
+    double sort_ms = time_ms([&]() {
+         sorted = repeated;
+         sort_tunables(sorted, direction, layout);
+    }, iterations);
+    double keyed_ms = time_ms([&]() {
+         sorted = repeated;
+         sorted_attributes = attributes;
+         sort_tunables_keyed(sorted, sorted_attributes, direction, layout);
+    }, iterations);
+    fprintf(stdout, "%-24s %10.3f ms\n", "derive", derive_ms);
+    fprintf(stdout, "%-24s %10.3f ms\n", "copy + sort", sort_ms);
+    fprintf(stdout, "%-24s %10.3f ms\n", "copy + keyed sort", keyed_ms);
+    return(0);
+}
+
+static std::vector<igemm_gtc_conv_problem_t> random_problems(const igemm_gtc_packed_tunable_t &kind, size_t num_problems)
+{
+    std::mt19937 rng(20211);
+    auto pick = [&](std::initializer_list<int> values) {
+         return *(values.begin() + std::uniform_int_distribution<size_t>(0, values.size() - 1)(rng));
+    };
+    std::vector<igemm_gtc_conv_problem_t> problems(num_problems);
+    for (auto &p : problems) {
+         p.direction = kind.direction;
+         p.tensor_layout = kind.tensor_layout;
+         p.precision = kind.precision;
+         p.n = pick({1, 2, 3, 4, 8, 16, 32, 64, 128, 256});
+         p.group = pick({1, 1, 1, 1, 2, 4});
+         p.c = p.group * pick({3, 16, 24, 32, 64, 96, 128, 256, 512, 1024});
+         p.k = p.group * pick({16, 32, 48, 64, 128, 192, 256, 512, 1024, 2048});
+         p.hi = p.wi = pick({1, 7, 14, 17, 28, 35, 56, 112, 224});
+         if (pick({0, 1})) {
+              p.y = p.x = pick({1, 3, 5, 7});
+              p.stride_h = p.stride_w = pick({1, 2, 3});
+              p.pad_h = p.pad_w = pick({0, 1, 2, 3});
+              p.dilation_h = p.dilation_w = pick({1, 1, 2});
+              p.wi = pick({p.wi, p.wi, 9});
+              p.x = pick({p.x, p.x, 1, 3});
+         }
+    }
+    return problems;
+}
+
+static long select_scalar(const std::vector<igemm_gtc_packed_tunable_t> &tunables, const igemm_gtc_conv_problem_t &problem)
+{
+    for (size_t i = 0; i < tunables.size(); i++)
+         if (igemm_gtc_tunable_is_applicable(problem, tunables[i]))
+              return i;
+    return -1;
+}
+
+static bool same_selection(const std::vector<igemm_gtc_packed_tunable_t> &tunables,
+                           const std::vector<igemm_gtc_conv_problem_t> &problems, size_t &num_selected)
+{
+    igemm_gtc_selector_t selector(tunables);
+    num_selected = 0;
+    for (const auto &problem : problems) {
+         long index = selector.select(problem);
+         if (index != select_scalar(tunables, problem))
+              return false;
+         size_t num_applicable = 0;
+         for (const auto &tunable : tunables)
+              num_applicable += igemm_gtc_tunable_is_applicable(problem, tunable);
+         if (selector.count(problem) != num_applicable)
+              return false;
+         num_selected += index >= 0;
+    }
+    return true;
+}
+
+// the first applicable tunable and the number of them, of the (repeated to 2000) tunables of the file for random problems of their
+// direction, layout and precision, picked by the selector and by checking the tunables one by one
+static int benchmark_select(const char *config_file, int iterations)
+{
+    std::vector<igemm_gtc_packed_tunable_t> packed = igemm_gtc_tunable_pack(igemm_gtc_tunable_load(config_file));
+    if (packed.empty()) {
+         fprintf(stdout, "%s has no tunables !\n", config_file);
+         return(-1);
+    }
+    const size_t num_problems = 10000;
+    std::vector<igemm_gtc_conv_problem_t> problems = random_problems(packed[0], num_problems);
+
+    // each list the generators make, and a mix of them with tunables no problem can take
+    std::vector<igemm_gtc_packed_tunable_t> mixed;
+    for (const char *precision : {"fp32", "fp16"}) {
+         bwd_nchw_config bwd_nchw;
+         bwd_nhwc_config bwd_nhwc;
+         fwd_nchw_config fwd_nchw;     // fp32 divides by zero in getMaximumSlice_a_c1e()
+         std::vector<std::vector<igemm_gtc_packed_tunable_t>> generated = {bwd_nchw.make_configs(precision), bwd_nhwc.make_configs(precision)};
+         if (precision == std::string("fp16"))
+              generated.push_back(fwd_nchw.make_configs(precision));
+         for (const auto &list : generated) {
+              size_t num_selected;
+              if (!same_selection(list, random_problems(list[0], 2000), num_selected)) {
+                   fprintf(stdout, "the selector does not pick or count the tunables the check does on the generated %s %s %s tunables !\n",
+                           list[0].get_direction(), precision, list[0].get_tensor_layout());
+                   return(-1);
+              }
+              mixed.insert(mixed.end(), list.begin(), list.end());
+         }
+    }
+    for (size_t i = 0; i < mixed.size(); i += 7)
+         mixed[i].nxb = 0;
+    for (size_t i = 3; i < mixed.size(); i += 11)
+         mixed[i].gemm_k_per_block = 24;
+    for (const auto &kind : {mixed.front(), mixed.back()}) {
+         size_t num_selected;
+         if (!same_selection(mixed, random_problems(kind, 2000), num_selected)) {
+              fprintf(stdout, "the selector does not pick or count the tunables the check does on the mixed tunables !\n");
+              return(-1);
+         }
+    }
+
+    std::vector<igemm_gtc_packed_tunable_t> tunables;
+    while (tunables.size() < 2000)
+         tunables.insert(tunables.end(), packed.begin(), packed.begin() + std::min(packed.size(), 2000 - tunables.size()));
+    size_t num_selected;
+    if (!same_selection(tunables, problems, num_selected)) {
+         fprintf(stdout, "the selector does not pick or count the tunables the check does !\n");
+         return(-1);
+    }
+    igemm_gtc_selector_t selector(tunables);
+    long sum = 0;
+    double build_ms = time_ms([&]() { igemm_gtc_selector_t built(tunables); sum += built.size(); }, iterations);
+    double select_ms = time_ms([&]() {
+         for (const auto &problem : problems)
+              sum += selector.select(problem);
+    }, iterations);
+    double scalar_ms = time_ms([&]() {
+         for (const auto &problem : problems)
+              sum += select_scalar(tunables, problem);
+    }, iterations);
+    fprintf(stdout, "%s: %zu tunables, %zu problems, %zu with an applicable tunable, %d iterations (%ld)\n", config_file,
+            tunables.size(), problems.size(), num_selected, iterations, sum);
+    fprintf(stdout, "%-24s %10.3f ms\n", "build selector", build_ms);
+    fprintf(stdout, "%-24s %10.3f ns\n", "select", select_ms * 1e6 / problems.size());
+    fprintf(stdout, "%-24s %10.3f ns\n", "check one by one", scalar_ms * 1e6 / problems.size());
+    return(0);
+}
+
+// the rank and unrank of the generator matching the tunables of the file: every candidate of the space
+// round trips, the shards cover the space, and the tunables of the file are located in it
+static int benchmark_rank(const char *config_file, int iterations)
+{
+    std::vector<igemm_gtc_packed_tunable_t> tunables = igemm_gtc_tunable_pack(igemm_gtc_tunable_load(config_file));
+    if (tunables.empty()) {
+         fprintf(stdout, "%s has no tunables !\n", config_file);
+         return(-1);
+    }
+    std::string direction = tunables[0].get_direction(), layout = tunables[0].get_tensor_layout();
+    std::unique_ptr<basic_igemm_config> generator;
+    if (direction == "bwd" && layout == "nchw")
+         generator.reset(new bwd_nchw_config());
+    else if (direction == "bwd" && layout == "nhwc")
+         generator.reset(new bwd_nhwc_config());
+    else if (direction == "fwd" && layout == "nchw")
+         generator.reset(new fwd_nchw_config());
+    else {
+         fprintf(stdout, "no generator for %s %s !\n", direction.c_str(), layout.c_str());
+         return(-1);
+    }
+    std::vector<igemm_gtc_packed_tunable_t> configs = generator->make_configs(tunables[0].get_precision());
+    const config_search_space_t &space = generator->search_space();
+
+    // a candidate ranks back to itself unless an earlier rank gave the same tunable
+    std::unordered_map<igemm_gtc_packed_tunable_t, uint64_t> first_rank;
+    std::vector<uint32_t> valid = generator->valid_ranks(0, space.size());
+    igemm_gtc_packed_tunable_t cfg;
+    for (uint32_t r : valid) {
+         generator->unrank(r, cfg);
+         uint64_t expected = first_rank.emplace(cfg, r).first->second;
+         uint64_t ranked;
+         if (!generator->rank(cfg, ranked) || ranked != expected) {
+              fprintf(stdout, "candidate %u does not rank back to %llu !\n", r, (unsigned long long)expected);
+              return(-1);
+         }
+    }
+    if (first_rank.size() != configs.size()) {
+         fprintf(stdout, "%zu distinct candidates, the generator makes %zu configs !\n", first_rank.size(), configs.size());
+         return(-1);
+    }
+    std::vector<uint32_t> sharded;
+    size_t num_shards = 7;
+    for (size_t shard = 0; shard < num_shards; shard++) {
+         std::vector<uint32_t> ranks = generator->valid_ranks(space.size() * shard / num_shards,
+                                                              space.size() * (shard + 1) / num_shards);
+         sharded.insert(sharded.end(), ranks.begin(), ranks.end());
+    }
+    if (sharded != valid) {
+         fprintf(stdout, "the shards do not cover the space !\n");
+         return(-1);
+    }
+    size_t num_located = 0;
+    std::vector<uint32_t> ids;
+    for (const auto &tunable : tunables) {
+         uint64_t r;
+         if (generator->rank(tunable, r)) {
+              num_located++;
+              ids.push_back(static_cast<uint32_t>(r));
+         }
+    }
+
+    fprintf(stdout, "%s: %zu tunables, %zu in the %s %s %s space, %d iterations\n", config_file, tunables.size(),
+            num_located, direction.c_str(), layout.c_str(), tunables[0].get_precision(), iterations);
+    fprintf(stdout, "space:");
+    for (int axis = 0; axis < space.get_num_axes(); axis++)
+         fprintf(stdout, " %s(%d)", space.get_axis_name(axis), space.get_radix(axis));
+    fprintf(stdout, " = %llu candidates, %zu valid, %zu distinct\n", (unsigned long long)space.size(), valid.size(),
+            configs.size());
+    fprintf(stdout, "%-24s %10zu bytes (%zu bytes as tunables)\n", "ids of the file", ids.size() * sizeof(uint32_t),
+            ids.size() * sizeof(igemm_gtc_packed_tunable_t));
+
+    std::mt19937_64 rng(12345);
+    size_t num_samples = 100000, num_accepted = 0;
+    double walk_ms = time_ms([&]() { generator->valid_ranks(0, space.size()); }, iterations);
+    double sample_ms = time_ms([&]() {
+         num_accepted = 0;
+         for (size_t n = 0; n < num_samples; n++)
+              num_accepted += generator->unrank(rng() % space.size(), cfg);
+    }, iterations);
+    uint64_t checksum = 0;
+    double rank_ms = time_ms([&]() {
+         for (const auto &config : configs) {
+              uint64_t r;
+              generator->rank(config, r);
+              checksum += r;
+         }
+    }, iterations);
+    fprintf(stdout, "%-24s %10.3f ms %10.1f ns/candidate\n", "unrank the space", walk_ms, walk_ms * 1e6 / space.size());
+    fprintf(stdout, "%-24s %10.3f ms %10.1f ns/sample, %.1f%% valid\n", "uniform samples", sample_ms,
+            sample_ms * 1e6 / num_samples, 100.0 * num_accepted / num_samples);
+    fprintf(stdout, "%-24s %10.3f ms %10.1f ns/tunable (checksum %llu)\n", "rank the configs", rank_ms,
+            rank_ms * 1e6 / configs.size(), (unsigned long long)checksum);
+    return(0);
+}
+
+static bool same_tunables(const std::vector<igemm_gtc_tunable_t> &a, const std::vector<igemm_gtc_tunable_t> &b)
+{
+    bool same = a.size() == b.size();
+    for (size_t i = 0; same && i < a.size(); i++)
+         same = same_tunable(a[i], b[i]);
+    return same;
+}
+
+// a space section around the first tunable of 'content': its keys, but the ones 'candidates' gives
+static std::string space_text(const config_content_t &content, const char *candidates)
+{
+    std::vector<igemm_gtc_tunable_t> tunables = igemm_gtc_tunable_from_config(content);
+    assert(!tunables.empty());
+    std::vector<igemm_gtc_tunable_t> first(1, tunables[0]);
+    std::ostringstream text;
+    output_configurations(first, "", "", text);
+    std::string space = text.str();
+    std::string name = std::string("[igemm_") + tunables[0].direction + "_gtc";
+    space.insert(space.find(name) + name.size(), "_space");
+    std::istringstream lines(candidates);
+    for (std::string line; std::getline(lines, line);) {
+         size_t pos = space.find("\n" + line.substr(0, line.find_first_of(" =")) + " ");
+         if (pos != std::string::npos)
+              space.erase(pos + 1, space.find('\n', pos + 1) - pos);
+    }
+    return space + candidates;
+}
+
+// expanding search-space sections, against writing their tunables out and parsing them back
+static int benchmark_space(const char *config_file, int iterations)
+{
+    const char *small_candidates =
+         "gemm_k_per_block           = [4, 8, 16, 32]\n"
+         "wave_repeat_m              = (1, 3)\n"
+         "nxb                        = [1, 4, 16]\n"
+         "nxe                        = [0, 1]\n"
+         "tensor_b_cluster_lengths.3 = [32, 64, 128]\n";
+    const uint64_t small_size = 4 * 2 * 3 * 2 * 3;
+    std::string large_candidates = std::string(small_candidates) +
+         "gemm_m_per_block           = [64, 128, 256]\n"
+         "gemm_n_per_block           = [32, 64, 128, 256]\n"
+         "wave_repeat_n              = (1, 5)\n"
+         "tensor_a_thread_lengths.2  = (1, 9)\n";
+    const uint64_t large_size = small_size * 3 * 4 * 4 * 8;
+
+    config_content_t content = config_parser_t(config_file).parse();
+    std::string arch_string = content.get_section("codegen").at("arch").get_string();
+    std::string small_text = space_text(content, small_candidates);
+    std::string large_text = space_text(content, large_candidates.c_str());
+    config_content_t small_content = config_parser_t(config_file).parse_buffer(small_text);
+    config_content_t large_content = config_parser_t(config_file).parse_buffer(large_text);
+    const config_section_t &small_sec = small_content[1];
+    const config_section_t &large_sec = large_content[1];
+
+    igemm_gtc_tunable_space_t space;
+    std::string error;
+    if (!space.build(small_sec, error) || space.size() != small_size) {
+         fprintf(stdout, "space of %llu candidates, not %llu: %s !\n", (unsigned long long)space.size(),
+                 (unsigned long long)small_size, error.c_str());
+         return(-1);
+    }
+    std::vector<igemm_gtc_tunable_t> expanded;
+    auto push = [&](igemm_gtc_tunable_t &&tunable) { expanded.push_back(std::move(tunable)); };
+    if (!space.expand(arch_string, push, error) || expanded.size() != small_size) {
+         fprintf(stdout, "space expands to %zu tunables: %s !\n", expanded.size(), error.c_str());
+         return(-1);
+    }
+    // odometer order, last key fastest, and the element override in its list
+    if (expanded[0].tensor_b_cluster_lengths[3] != 32 || expanded[1].tensor_b_cluster_lengths[3] != 64 ||
+        expanded[3].nxe != 1 || expanded[small_size - 1].gemm_k_per_block != 32 ||
+        expanded[small_size - 1].wave_repeat_m != 2) {
+         fprintf(stdout, "space expanded out of order !\n");
+         return(-1);
+    }
+
+    // every path of the tools sees the same tunables, and the written ones parse back the same
+    std::ostringstream written;
+    output_configurations(expanded, "", "", written);
+    bool ok;
+    std::vector<igemm_gtc_tunable_t> bound = bind_tunables(small_text, ok);
+    if (!same_tunables(expanded, igemm_gtc_tunable_from_config(small_content)) || !ok ||
+        !same_tunables(expanded, bound) ||
+        !same_tunables(expanded, igemm_gtc_tunable_from_config(config_parser_t(config_file).parse_buffer(written.str())))) {
+         fprintf(stdout, "expanded, converted, bound and written tunables differ !\n");
+         return(-1);
+    }
+    auto k_filter = [](const igemm_gtc_tunable_t &tunable) { return tunable.gemm_k_per_block % 8 == 0; };
+    if (igemm_gtc_tunable_from_config(small_content, k_filter).size() != small_size / 4 * 3) {
+         fprintf(stdout, "filter misses some candidates !\n");
+         return(-1);
+    }
+    const char *broken[] = {"nxb = [1, 2]\nwave_tile_k = 'x'\n", "nxb = [1, 2]\nnxb.1 = 2\n", "nx = 1\n",
+                            "tensor_a_thread_lengths.4 = 1\n"};
+    for (const char *candidates : broken) {
+         config_content_t broken_content = config_parser_t(config_file).parse_buffer(space_text(content, candidates));
+         if (igemm_gtc_tunable_space_t().build(broken_content[1], error)) {
+              fprintf(stdout, "space accepts a broken section:\n%s", candidates);
+              return(-1);
+         }
+    }
+
+    space = igemm_gtc_tunable_space_t();
+    if (!space.build(large_sec, error) || space.size() != large_size) {
+         fprintf(stdout, "space of %llu candidates, not %llu !\n", (unsigned long long)space.size(),
+                 (unsigned long long)large_size);
+         return(-1);
+    }
+    expanded.clear();
+    space.expand(arch_string, push, error);
+    written.str("");
+    output_configurations(expanded, "", "", written);
+    std::string written_text = written.str();
+    fprintf(stdout, "%s: %llu candidates, %zu bytes of space, %zu bytes expanded, %d iterations\n", config_file,
+            (unsigned long long)large_size, large_text.size(), written_text.size(), iterations);
+
+    size_t num_tunables = 0;
+    auto count = [&](igemm_gtc_tunable_t &&tunable) { (void)tunable; num_tunables++; };
+    double expand_ms = time_ms([&]() { space.expand(arch_string, count, error); }, iterations);
+    double bind_ms = time_ms([&]() { igemm_gtc_tunable_bind_buffer(large_text, count); }, iterations);
+    double parse_ms = time_ms([&]() {
+         igemm_gtc_tunable_from_config(config_parser_t(config_file).parse_buffer(written_text));
+    }, iterations);
+    assert(num_tunables == 2 * iterations * large_size);
+    double n = (double)large_size;
+    fprintf(stdout, "%-24s %10.3f ms %10.1f ns/tunable\n", "expand space", expand_ms, expand_ms * 1e6 / n);
+    fprintf(stdout, "%-24s %10.3f ms %10.1f ns/tunable\n", "bind space text", bind_ms, bind_ms * 1e6 / n);
+    fprintf(stdout, "%-24s %10.3f ms %10.1f ns/tunable\n", "parse expanded text", parse_ms, parse_ms * 1e6 / n);
+    return(0);
+}
+
+// lines of 'buffer' through config_lex_line(), the reference of the scanner
+static std::vector<config_line_t> lex_lines_reference(std::string_view buffer)
+{
+    std::vector<config_line_t> lines;
+    size_t pos = 0;
+    while (pos < buffer.size()) {
+        size_t eol = buffer.find('\n', pos);
+        if (eol == std::string_view::npos)
+            eol = buffer.size();
+        lines.push_back(config_lex_line(buffer.substr(pos, eol - pos), pos));
+        pos = eol + 1;
+    }
+    return lines;
+}
+
+static std::vector<config_line_t> lex_lines_scanner(std::string_view buffer, bool vectorized)
+{
+    std::vector<config_line_t> lines;
+    config_line_scanner_t scanner(buffer, vectorized);
+    config_line_t line;
+    while (scanner.next(line))
+        lines.push_back(line);
+    return lines;
+}
+
+// same views, not only same text
+static bool same_view(std::string_view a, std::string_view b)
+{
+    return a.size() == b.size() && (a.empty() || a.data() == b.data());
+}
+
+static bool same_lines(const std::vector<config_line_t> &a, const std::vector<config_line_t> &b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].kind != b[i].kind || a[i].offset != b[i].offset || !same_view(a[i].text, b[i].text) ||
+            !same_view(a[i].key, b[i].key) || !same_view(a[i].value, b[i].value))
+            return false;
+    }
+    return true;
+}
+
+// config_line_scanner_t, vectorized and scalar, against config_lex_line() on
+// the file and on random text made of the bytes the grammar cares about
+static int benchmark_scan(const char *config_file, int iterations)
+{
+    config_mapped_file_t mapped_file(config_file);
+    std::string_view buffer = mapped_file.view();
+    std::vector<config_line_t> reference = lex_lines_reference(buffer);
+    if (!same_lines(reference, lex_lines_scanner(buffer, true)) ||
+        !same_lines(reference, lex_lines_scanner(buffer, false))) {
+         fprintf(stdout, "scanner and reference lines differ on %s !\n", config_file);
+         return(-1);
+    }
+
+    const char alphabet[] = " \t\r\n\n==;#[]]ak1.,'";
+    std::mt19937 rng(12345);
+    size_t num_random = 20000;
+    for (size_t n = 0; n < num_random; n++) {
+         std::string text(rng() % 300, ' ');
+         for (auto &c : text)
+              c = alphabet[rng() % (sizeof(alphabet) - 1)];
+         std::vector<config_line_t> random_reference = lex_lines_reference(text);
+         if (!same_lines(random_reference, lex_lines_scanner(text, true)) ||
+             !same_lines(random_reference, lex_lines_scanner(text, false))) {
+              fprintf(stdout, "scanner and reference lines differ on random text %zu !\n", n);
+              return(-1);
+         }
+    }
+    fprintf(stdout, "%s: %zu lines, %zu random texts, all identical, %d iterations\n", config_file, reference.size(),
+            num_random, iterations);
+
+    size_t checksum = 0;
+    auto count_values = [&](const std::vector<config_line_t> &lines) {
+         for (const auto &line : lines)
+              checksum += line.value.size();
+    };
+    double reference_ms = time_ms([&]() { count_values(lex_lines_reference(buffer)); }, iterations);
+    double scalar_ms = time_ms([&]() { count_values(lex_lines_scanner(buffer, false)); }, iterations);
+    double vector_ms = time_ms([&]() { count_values(lex_lines_scanner(buffer, true)); }, iterations);
+    report_throughput("line by line", reference_ms, buffer.size(), reference.size());
+    report_throughput("scanner (scalar)", scalar_ms, buffer.size(), reference.size());
+    report_throughput("scanner (vectorized)", vector_ms, buffer.size(), reference.size());
+    fprintf(stdout, "(throughput in lines/s, checksum %zu)\n", checksum);
+    return(0);
+}
+
+int main(int argc, char **argv)
+{
+    if ( argc < 3 ) {
+         fprintf(stdout, "Usage: %s, <benchmark(parse,alloc,convert,cache,classify,scan,gzip,lazy,bind,space,write,packed,table,rank,attributes,select)> <configuration file> [iterations] [threads] \n", argv[0]);
+         return(-1);
+    };
+
+    std::string benchmark(argv[1]);
+    const char *config_file = argv[2];
+    int iterations = argc > 3 ? atoi(argv[3]) : 5;
+    int num_threads = argc > 4 ? atoi(argv[4]) : (int)std::thread::hardware_concurrency();
+
+    if ( benchmark == "parse" )
+         return benchmark_parse(config_file, iterations, num_threads);
+    if ( benchmark == "alloc" )
+         return benchmark_alloc(config_file);
+    if ( benchmark == "convert" )
+         return benchmark_convert(config_file, iterations);
+    if ( benchmark == "attributes" )
+         return benchmark_attributes(config_file, iterations);
+    if ( benchmark == "select" )
+         return benchmark_select(config_file, iterations);
+    if ( benchmark == "rank" )
+         return benchmark_rank(config_file, iterations);
+    if ( benchmark == "table" )
+         return benchmark_table(config_file, iterations);
+    if ( benchmark == "packed" )
+         return benchmark_packed(config_file, iterations);
+    if ( benchmark == "write" )
+         return benchmark_write(config_file, iterations);
+    if ( benchmark == "space" )
+         return benchmark_space(config_file, iterations);
+    if ( benchmark == "bind" )
+         return benchmark_bind(config_file, iterations);
+    if ( benchmark == "lazy" )
+         return benchmark_lazy(config_file, iterations);
+    if ( benchmark == "gzip" )
+         return benchmark_gzip(config_file, iterations);
+    if ( benchmark == "scan" )
+         return benchmark_scan(config_file, iterations);
+    if ( benchmark == "classify" )
+         return benchmark_classify(config_file, iterations);
+    if ( benchmark == "cache" )
+         return benchmark_cache(config_file, iterations, num_threads);
+
+    std::cout << "Invalid benchmark!" << std::endl;
+    return(-2);
+};
@@ -52,18 +52,22 @@ public:
     bwd_nchw_config& operator=(bwd_nchw_config&) = delete;
 
     void generate_configs(const char *precision, const char *config_file);
+protected:
+    const std::vector<int> &get_nxb_values() const;
+    void add_search_axes(config_search_space_t &space_) const;
+    bool make_candidate(const config_search_digits_t &digits, igemm_gtc_packed_tunable_t &cfg) const;
 private:
-    std::vector<igemm_gtc_tunable_t> configs;
+    bool make_c0_n0_slices(igemm_gtc_packed_tunable_t &cfg, bool use_k1e, int unmerge_sub_n) const;
 
-    int get_num_soffset_sgprs(int d0_length, int d1_length, int max_vector_size);
-    int get_available_sgprs_for_soffset(bool is_zero_nxe); 
+    int get_num_soffset_sgprs(int d0_length, int d1_length, int max_vector_size) const;
+    int get_available_sgprs_for_soffset(bool is_zero_nxe) const; 
 }; 
 
 // try to adjust this if the generator codes improved the usage of sgprs
 
 // d0_length is the length of d0-dimension 
 // d1_length is the length os d1-dimension
-int bwd_nchw_config::get_num_soffset_sgprs(int d0_length, int d1_length, int max_vector_size)
+int bwd_nchw_config::get_num_soffset_sgprs(int d0_length, int d1_length, int max_vector_size) const
 {
     assert(d0_length > 0 && d1_length > 0 && max_vector_size > 0); 
 
@@ -84,7 +88,7 @@ int bwd_nchw_config::get_num_soffset_sgprs(int d0_length, int d1_length, int max
 }; 
 
 // This function heavily depends on the implementation of the generator for bwd-fp16
-int bwd_nchw_config::get_available_sgprs_for_soffset(bool is_zero_nxe)
+int bwd_nchw_config::get_available_sgprs_for_soffset(bool is_zero_nxe) const
 {
     if ( is_zero_nxe ) 
 	 return(103-1-6-45); // "-1" is considering for "s_tmp" aligned allocation
@@ -92,362 +96,222 @@ int bwd_nchw_config::get_available_sgprs_for_soffset(bool is_zero_nxe)
 	 return(103-1-6-63); // "-1" is considering for "s_tmp" aligned allocation
 }; 
 
-void bwd_nchw_config::generate_configs(const char *precision, const char *config_file)
+const std::vector<int> &bwd_nchw_config::get_nxb_values() const
+{
+    static const std::vector<int> nxb_values = { 1, 4 };   // no use for nxb bigger than 1
+
+    return(nxb_values);
+}; 
+
+// k_dim 0 uses dimension k0 for thread slice for gemm_k of tensor_a/tensor_b, k_dim 1 uses dimension k1e, the slice 
+// sizes are the powers of 2 up to gemm_k_per_block. m_n_scheme 0 uses c0/n0 for thread slice for gemm_m/gemm_n, 
+// m_n_scheme 1 uses c1/n1b with nxe == 0 and c1/n0 with nxe == 1 
+void bwd_nchw_config::add_search_axes(config_search_space_t &space_) const
+{
+    int max_gemm_k_per_block = 0; 
+
+    for (int i=0; i < get_num_mappings(); i++) 
+         max_gemm_k_per_block = std::max<int>(max_gemm_k_per_block, get_mapping(i).wave_tile_k << (get_lower_k_shifts() + 1)); 
+
+    int num_slices = 0; 
+
+    for(int sliceSize=1; sliceSize <= max_gemm_k_per_block; sliceSize *= 2) 
+         num_slices++; 
+
+    space_.add_axis("k_dim", 2);
+    space_.add_axis("slice", num_slices);
+    space_.add_axis("m_n_scheme", 2);
+}; 
+
+bool bwd_nchw_config::make_candidate(const config_search_digits_t &digits, igemm_gtc_packed_tunable_t &cfg) const
 {
-    std::ofstream ofs(config_file, std::ofstream::out);
+    int blockSize; 
+
+    make_common(digits, cfg, blockSize); 
+
+    cfg.tensor_layout = igemm_gtc_tensor_layout_enum::nchw; 
+    cfg.direction = igemm_gtc_direction_enum::bwd; 
+
+    int max_vector_size = (precision == "fp16") ? 8 : 4; 
+
+    int unmerge_sub_n = cfg.gemm_n_per_block / cfg.nxb;    // assuming gemm_n_unmerge_cluster == 0 is used for generated configs 
+
+    // consider the gemm_k_per_block sizes to be 2x, 4x, 8x that of the k_per_inst of the specific xlops instruction
+
+    if ( cfg.gemm_k_per_block / 8 > blockSize )  // this should not occurr easily
+         return(false);
+
+    // blockSize/(cfg.gemm_k_per_block/1) indicates the least required cluster size in gemm_m dimension
+    if ( blockSize / (cfg.gemm_k_per_block/1) > cfg.gemm_m_per_block ) 
+         return(false);
+
+    // blockSize/std::min(blockSize,cfg.gemm_n_per_block) indicates the least required cluster size in gemm_k dimension 
+    if ( blockSize / std::min<int>(blockSize, cfg.gemm_n_per_block) > cfg.gemm_k_per_block )
+         return(false);
+
+    // We have the following assumption to generate configs:
+    // 1) tensor_a and tensor_b tries to be same in gemm_k dimensions (k0, k1e) 
+    // 2) cluster dimension is always the lower dimension of gemm_k/gemm_m/gemm_n (k1e/c1/n1b)
+    // 3) For fp16, since gemm_k_pack is used, the per-block size on k1e should not be less than gemm_k_pack size 4 
+
+    cfg.tensor_a_cluster_lengths[0] = 1; 
+    cfg.tensor_b_cluster_lengths[0] = 1; 
+    cfg.tensor_a_cluster_lengths[2] = 1; 
+    cfg.tensor_b_cluster_lengths[2] = 1; 
+
+    // only check this for nxe == 0 since for nxe == 1,  nhw is padded according to nxb
+    if ( cfg.nxe == 0 && cfg.gemm_n_per_block % cfg.nxb != 0 ) 
+         return(false);
+
+    bool use_k1e = digits[config_search_num_common_axes] == 1; 
+    int sliceSize = 1 << digits[config_search_num_common_axes+1]; 
+    int m_n_scheme = digits[config_search_num_common_axes+2]; 
+
+    if ( sliceSize > cfg.gemm_k_per_block || (use_k1e && sliceSize < 2) ) 
+         return(false); 
+
+#if GENERATE_REDUCED_CONFIGS 
+    // with nxe == 0 only k1e and c1/n1b are used, with nxe == 1 k0 only uses c0/n0 
+    if ( cfg.nxe == 0 && (!use_k1e || m_n_scheme == 0) ) 
+         return(false); 
+    if ( cfg.nxe == 1 && !use_k1e && m_n_scheme == 1 ) 
+         return(false); 
+#endif
+    // with nxe == 1, k1e is only used with c1/n0 
+    if ( cfg.nxe == 1 && use_k1e && m_n_scheme == 0 ) 
+         return(false); 
+
+    cfg.tensor_a_thread_lengths[0] = use_k1e ? 1 : sliceSize;
+    cfg.tensor_a_thread_lengths[1] = use_k1e ? sliceSize : 1;
+    cfg.tensor_a_cluster_lengths[1] = cfg.gemm_k_per_block / sliceSize;
 
-    int num_mappings = (std::string(precision) == "fp32")? NUM_XDLOPS_MAPPING_FP32 : NUM_XDLOPS_MAPPING_FP16; 
+    int n_k1e = cfg.tensor_a_thread_lengths[1] * cfg.tensor_a_cluster_lengths[1];
 
-    for (int i=0; i < num_mappings; i++) {
-         auto xm = (std::string(precision) == "fp32")? xdlops_mappings_fp32[i] : xdlops_mappings_fp16[i];
+    // this is a situation difficult to handle, so just give it up
+    if ( precision == "fp16" && n_k1e < 4 )
+         return(false);
 
-         igemm_gtc_tunable_t cfg;
+    cfg.tensor_a_cluster_lengths[3] = blockSize / cfg.tensor_a_cluster_lengths[1];
 
-         cfg.gemm_m_per_block = xm.macro_tile_m;
-         cfg.gemm_n_per_block = xm.macro_tile_n;
-         cfg.wave_tile_m = xm.wave_tile_m;
-         cfg.wave_tile_n = xm.wave_tile_n;
-         cfg.wave_tile_k = xm.wave_tile_k;
-         cfg.wave_repeat_m = xm.wave_repeat_m;
-         cfg.wave_repeat_n = xm.wave_repeat_n;
-         cfg.wave_step_m = xm.wave_step_m;
-         cfg.wave_step_n = xm.wave_step_n;
+    cfg.tensor_b_cluster_lengths[1] = cfg.tensor_a_cluster_lengths[1];
+    cfg.tensor_b_cluster_lengths[3] = cfg.tensor_a_cluster_lengths[3];
+    cfg.tensor_b_thread_lengths[0] = cfg.tensor_a_thread_lengths[0];
+    cfg.tensor_b_thread_lengths[1] = cfg.tensor_a_thread_lengths[1];
 
-         cfg.tensor_a_thread_lengths.resize(4);
-         cfg.tensor_a_cluster_lengths.resize(4);
-         cfg.tensor_b_thread_lengths.resize(4);
-         cfg.tensor_b_cluster_lengths.resize(4);
+    if ( cfg.tensor_a_cluster_lengths[3] > cfg.gemm_m_per_block  || cfg.tensor_b_cluster_lengths[3] > cfg.gemm_n_per_block )
+         return(false);
 
-         cfg.tensor_layout = "nchw"; 
-         cfg.direction = "bwd"; 
-	 cfg.precision = precision; 
+    if ( m_n_scheme == 0 ) 
+         return( make_c0_n0_slices(cfg, use_k1e, unmerge_sub_n) ); 
+
+    if ( cfg.nxe == 0 ) { 
+#if GENERATE_REDUCED_CONFIGS == 0 
+         // c1/n1b is not needed when c0/n0 was selected with slices of 1
+         igemm_gtc_packed_tunable_t c0_n0_cfg = cfg; 
+
+         if ( make_c0_n0_slices(c0_n0_cfg, use_k1e, unmerge_sub_n) && c0_n0_cfg.tensor_a_thread_lengths[2] == 1 && c0_n0_cfg.tensor_b_thread_lengths[2] == 1 )
+              return(false); 
+#endif
+         // use c1/n1b for thread slice for gemm_m/gemm_n
+         cfg.tensor_a_thread_lengths[3] = cfg.gemm_m_per_block / cfg.tensor_a_cluster_lengths[3];
+         cfg.tensor_b_thread_lengths[3] = cfg.gemm_n_per_block / cfg.tensor_b_cluster_lengths[3];
+         cfg.tensor_a_thread_lengths[2] = 1;
+         cfg.tensor_b_thread_lengths[2] = 1;
+
+         // global vector load puts limitations on the sizes of the thread slices (at most dwordx4 can be used) 
+         if ( cfg.tensor_a_thread_lengths[3] > max_vector_size || cfg.tensor_b_thread_lengths[3] > max_vector_size )
+              return(false); 
 
-         int blockSize = waveSize * xm.waves;
          int tensor_a_soffset_sgprs; 
          int tensor_b_soffset_sgprs; 
 
-         int max_vector_size = (std::string(precision) == "fp16") ? 8 : 4; 
-
-         for (int nxe=0; nxe < 2; nxe += 1)  {
-              cfg.nxe = nxe;
-              for (int nxb=1; nxb < 5; nxb *= 4) { // no use for nxb bigger than 1
-                   cfg.nxb = nxb;
-
-                   int unmerge_sub_n = cfg.gemm_n_per_block / cfg.nxb;    // assuming gemm_n_unmerge_cluster == 0 is used for generated configs 
-
-                   // consider the gemm_k_per_block sizes to be 2x, 4x, 8x that of the k_per_inst of the specific xlops instruction
-		   
-                   // for fp32, gemm_k_per_block must be at lest 4-times multiplier of k_per_inst
-                   int lower_k_shifts = std::string(precision) == "fp16"? 1 : 2; 
-                   int upper_k_shifts = std::string(precision) == "fp16"? 3 : 4;
-
-                   for (int k=lower_k_shifts; k < upper_k_shifts; k++) { 
-                        cfg.gemm_k_per_block = xm.wave_tile_k << k;
-
-                        if ( cfg.gemm_k_per_block / 8 > blockSize )  // this should not occurr easily
-                             continue;
-
-                        // blockSize/(cfg.gemm_k_per_block/1) indicates the least required cluster size in gemm_m dimension
-                        if ( blockSize / (cfg.gemm_k_per_block/1) > cfg.gemm_m_per_block ) 
-                             continue;
-
-                        // blockSize/std::min(blockSize,cfg.gemm_n_per_block) indicates the least required cluster size in gemm_k dimension 
-                        if ( blockSize / std::min(blockSize, cfg.gemm_n_per_block) > cfg.gemm_k_per_block )
-                             continue;
-
-                        // We have the following assumption to generate configs:
-			// 1) tensor_a and tensor_b tries to be same in gemm_k dimensions (k0, k1e) 
-			// 2) cluster dimension is always the lower dimension of gemm_k/gemm_m/gemm_n (k1e/c1/n1b)
-			// 3) For fp16, since gemm_k_pack is used, the per-block size on k1e should not be less than gemm_k_pack size 4 
-		
-                        cfg.tensor_a_cluster_lengths[0] = 1; 
-			cfg.tensor_b_cluster_lengths[0] = 1; 
-			cfg.tensor_a_cluster_lengths[2] = 1; 
-			cfg.tensor_b_cluster_lengths[2] = 1; 
-
-                        if ( cfg.nxe == 0 ) {
-                            if ( cfg.gemm_n_per_block % nxb != 0 )   // only check this for nxe == 0 since for nxe == 1,  nhw is padded according to nxb
-                                 continue;
-                            
-#if GENERATE_REDUCED_CONFIGS == 0 			    
-                            // use dimension k0 for thread slice for gemm_k of tensor_a/tensor_b
-                            for(int sliceSize=1; sliceSize <= cfg.gemm_k_per_block; sliceSize *= 2) {
-                                cfg.tensor_a_thread_lengths[0] = sliceSize;
-                                cfg.tensor_a_thread_lengths[1] = 1;
-                                cfg.tensor_a_cluster_lengths[1] = cfg.gemm_k_per_block / sliceSize;
-
-                                int n_k1e = cfg.tensor_a_thread_lengths[1] * cfg.tensor_a_cluster_lengths[1];
-
-                                // this is a situation difficult to handle, so just give it up
-                                if ( std::string(precision) == "fp16" && n_k1e < 4 )
-                                     continue;
-
-                                cfg.tensor_a_cluster_lengths[3] = blockSize / cfg.tensor_a_cluster_lengths[1];
-
-                                cfg.tensor_b_cluster_lengths[1] = cfg.tensor_a_cluster_lengths[1];
-                                cfg.tensor_b_cluster_lengths[3] = cfg.tensor_a_cluster_lengths[3];
-                                cfg.tensor_b_thread_lengths[0] = cfg.tensor_a_thread_lengths[0];
-                                cfg.tensor_b_thread_lengths[1] = cfg.tensor_a_thread_lengths[1];
-
-                                if ( cfg.tensor_a_cluster_lengths[3] > cfg.gemm_m_per_block  || cfg.tensor_b_cluster_lengths[3] > cfg.gemm_n_per_block )
-                                     continue;
-				
-                                bool last_cfg_selected = false; 
-
-                                // use c0/n0 for thread slice for gemm_m/gemm_n
-			        do {	
-                                    cfg.tensor_a_thread_lengths[2] = cfg.gemm_m_per_block / cfg.tensor_a_cluster_lengths[3];
-                                    cfg.tensor_b_thread_lengths[2] = cfg.gemm_n_per_block / cfg.tensor_b_cluster_lengths[3];
-                                    cfg.tensor_a_thread_lengths[3] = 1;
-                                    cfg.tensor_b_thread_lengths[3] = 1;
-
-                                    tensor_a_soffset_sgprs = get_num_soffset_sgprs(cfg.tensor_a_thread_lengths[0], cfg.tensor_a_thread_lengths[2], 1); 
-                                    tensor_b_soffset_sgprs = get_num_soffset_sgprs(cfg.tensor_b_thread_lengths[0], cfg.tensor_b_thread_lengths[2], 1); 
-
-                                    // Limitation due to large sgpr consumption in precache soffset
-                                    if ( tensor_a_soffset_sgprs + tensor_b_soffset_sgprs > get_available_sgprs_for_soffset(true) ) 
-                                         break;
-
-                                    if ( unmerge_sub_n % cfg.tensor_b_thread_lengths[2] != 0) 
-					 break; 
-
-                                    this->configs.push_back(cfg);
-                                    last_cfg_selected = true; 
-                                } while(0);
-
-                                if ( last_cfg_selected && cfg.tensor_a_thread_lengths[2] == 1 && cfg.tensor_b_thread_lengths[2] == 1 )
-				     continue; 
-
-                                // use c1/n1b for thread slice for gemm_m/gemm_n
-                                do {
-                                    cfg.tensor_a_thread_lengths[3] = cfg.gemm_m_per_block / cfg.tensor_a_cluster_lengths[3];
-                                    cfg.tensor_b_thread_lengths[3] = cfg.gemm_n_per_block / cfg.tensor_b_cluster_lengths[3];
-                                    cfg.tensor_a_thread_lengths[2] = 1;
-                                    cfg.tensor_b_thread_lengths[2] = 1;
-
-                                    // global vector load puts limitations on the sizes of the thread slices (at most dwordx4 can be used) 
-                                    if ( cfg.tensor_a_thread_lengths[3] > max_vector_size || cfg.tensor_b_thread_lengths[3] > max_vector_size )
-				         break; 
-
-                                    tensor_a_soffset_sgprs = get_num_soffset_sgprs(cfg.tensor_a_thread_lengths[0], cfg.tensor_a_thread_lengths[3], max_vector_size); 
-                                    tensor_b_soffset_sgprs = get_num_soffset_sgprs(cfg.tensor_a_thread_lengths[0], cfg.tensor_a_thread_lengths[3], max_vector_size); 
-
-                                    // Limitation due to large sgpr consumption in precache soffset
-                                    if ( tensor_a_soffset_sgprs + tensor_b_soffset_sgprs > get_available_sgprs_for_soffset(true) )
-                                         break;
-
-                                    this->configs.push_back(cfg);
-                                } while(0); 
-                            };
-#endif                               
-                            // use dimension k1e for thread slice for gemm_k of tensor_a/tensor_b
-                            for(int sliceSize=2; sliceSize <= cfg.gemm_k_per_block; sliceSize *= 2) {
-                                cfg.tensor_a_thread_lengths[1] = sliceSize;
-                                cfg.tensor_a_thread_lengths[0] = 1;
-                                cfg.tensor_a_cluster_lengths[1] = cfg.gemm_k_per_block / sliceSize;
-
-                                int n_k1e = cfg.tensor_a_thread_lengths[1] * cfg.tensor_a_cluster_lengths[1];
-
-                                // this is a situation difficult to handle, so just give it up
-                                if ( std::string(precision) == "fp16" && n_k1e < 4 )
-                                     continue;
-
-                                cfg.tensor_a_cluster_lengths[3] = blockSize / cfg.tensor_a_cluster_lengths[1];
-
-                                cfg.tensor_b_cluster_lengths[1] = cfg.tensor_a_cluster_lengths[1];
-                                cfg.tensor_b_cluster_lengths[3] = cfg.tensor_a_cluster_lengths[3];
-                                cfg.tensor_b_thread_lengths[0] = cfg.tensor_a_thread_lengths[0];
-                                cfg.tensor_b_thread_lengths[1] = cfg.tensor_a_thread_lengths[1];
-
-                                if ( cfg.tensor_a_cluster_lengths[3] > cfg.gemm_m_per_block  || cfg.tensor_b_cluster_lengths[3] > cfg.gemm_n_per_block )
-                                     continue;
-#if GENERATE_REDUCED_CONFIGS == 0 
-                                bool last_cfg_selected = false; 
-                                
-                                // use c0/n0 for thread slice for gemm_m/gemm_n
-                                do {
-                                    cfg.tensor_a_thread_lengths[2] = cfg.gemm_m_per_block / cfg.tensor_a_cluster_lengths[3];
-                                    cfg.tensor_b_thread_lengths[2] = cfg.gemm_n_per_block / cfg.tensor_b_cluster_lengths[3];
-                                    cfg.tensor_a_thread_lengths[3] = 1;
-                                    cfg.tensor_b_thread_lengths[3] = 1;
+         if ( use_k1e ) {
+              tensor_a_soffset_sgprs = get_num_soffset_sgprs(cfg.tensor_a_thread_lengths[1], cfg.tensor_a_thread_lengths[3], max_vector_size); 
+              tensor_b_soffset_sgprs = get_num_soffset_sgprs(cfg.tensor_b_thread_lengths[1], cfg.tensor_b_thread_lengths[3], max_vector_size);
+         }
+         else {
+              tensor_a_soffset_sgprs = get_num_soffset_sgprs(cfg.tensor_a_thread_lengths[0], cfg.tensor_a_thread_lengths[3], max_vector_size); 
+              tensor_b_soffset_sgprs = get_num_soffset_sgprs(cfg.tensor_a_thread_lengths[0], cfg.tensor_a_thread_lengths[3], max_vector_size); 
+         }; 
 
-                                    tensor_a_soffset_sgprs = get_num_soffset_sgprs(cfg.tensor_a_thread_lengths[1], cfg.tensor_a_thread_lengths[2], 1);
-                                    tensor_b_soffset_sgprs = get_num_soffset_sgprs(cfg.tensor_b_thread_lengths[1], cfg.tensor_b_thread_lengths[2], 1);
+         // Limitation due to large sgpr consumption in precache soffset
+         if ( tensor_a_soffset_sgprs + tensor_b_soffset_sgprs > get_available_sgprs_for_soffset(true) )
+              return(false);
 
-                                    // Limitation due to large sgpr consumption in precache soffset
-                                    if ( tensor_a_soffset_sgprs + tensor_b_soffset_sgprs > get_available_sgprs_for_soffset(true) )
-                                         break; 
+         return(true); 
+    }; 
 
-                                    if ( unmerge_sub_n % cfg.tensor_b_thread_lengths[2] != 0) 
-					 break; 
+    // with nxe == 1, vector load can be used with Wei on dim-c1 when x == y == 1, wo we still need to generate configs where tensor_a_thread_length[3] > 1.
+    // for tensor_b, we only generate configs where tensor_b_thread_length[1], tensor_b_thread_length[3] are forced to be 1
 
-                                    this->configs.push_back(cfg);
+    // use dimension c1/n0 for thread slice for gemm_m/gemm_n
+    cfg.tensor_a_thread_lengths[3] = cfg.gemm_m_per_block / cfg.tensor_a_cluster_lengths[3];
+    cfg.tensor_b_thread_lengths[2] = cfg.gemm_n_per_block / cfg.tensor_b_cluster_lengths[3];  // tensor_b keep using n0 since it could not use vector load/store
+    cfg.tensor_a_thread_lengths[2] = 1; 
+    cfg.tensor_b_thread_lengths[3] = 1; 
 
-                                    last_cfg_selected = true;
-                                } while(0); 
+    // we don't need this config 
+    if ( cfg.tensor_a_thread_lengths[3] == 1) 
+         return(false); 
 
-                                if ( last_cfg_selected && cfg.tensor_a_thread_lengths[2] == 1 && cfg.tensor_b_thread_lengths[2] == 1 )
-                                     continue;				
-#endif
-                                // use c1/n1b for thread slice for gemm_m/gemm_n
-                                do {
-                                    cfg.tensor_a_thread_lengths[3] = cfg.gemm_m_per_block / cfg.tensor_a_cluster_lengths[3];
-                                    cfg.tensor_b_thread_lengths[3] = cfg.gemm_n_per_block / cfg.tensor_b_cluster_lengths[3];
-                                    cfg.tensor_a_thread_lengths[2] = 1;
-                                    cfg.tensor_b_thread_lengths[2] = 1;
-
-                                    // global vector load puts limitations on the sizes of the thread slices (at most dwordx4 can be used) 
-                                    if ( cfg.tensor_a_thread_lengths[3] > max_vector_size || cfg.tensor_b_thread_lengths[3] > max_vector_size )
-				         break; 
-
-                                    tensor_a_soffset_sgprs = get_num_soffset_sgprs(cfg.tensor_a_thread_lengths[1], cfg.tensor_a_thread_lengths[3], max_vector_size); 
-                                    tensor_b_soffset_sgprs = get_num_soffset_sgprs(cfg.tensor_b_thread_lengths[1], cfg.tensor_b_thread_lengths[3], max_vector_size);
-
-                                    // Limitation due to large sgpr consumption in precache soffset
-                                    if ( tensor_a_soffset_sgprs + tensor_b_soffset_sgprs > get_available_sgprs_for_soffset(true) )
-                                         break;
-
-                                    this->configs.push_back(cfg);
-                                } while(0);
-                            };   // end of for(...)
-		        }
-			else { 
-			    // with nxe == 1, vector load can be used with Wei on dim-c1 when x == y == 1, wo we still need to generate configs where tensor_a_thread_length[3] > 1.
-			    // for tensor_b, we only generate configs where tensor_b_thread_length[1], tensor_b_thread_length[3] are forced to be 1
-			   
-                            // use dimension k0 for thread slice for gemm_k of tensor_a/tensor_b
-                            for(int sliceSize=1; sliceSize <= cfg.gemm_k_per_block; sliceSize *= 2) {
-                                cfg.tensor_a_thread_lengths[0] = sliceSize; 
-				cfg.tensor_a_thread_lengths[1] = 1; 
-				cfg.tensor_a_cluster_lengths[1] = cfg.gemm_k_per_block / sliceSize; 
-
-                                int n_k1e = cfg.tensor_a_thread_lengths[1] * cfg.tensor_a_cluster_lengths[1]; 
-
-                                // this is a situation difficult to handle, so just give it up
-                                if ( std::string(precision) == "fp16" && n_k1e < 4 ) 
-				     continue; 
-
-				cfg.tensor_a_cluster_lengths[3] = blockSize / cfg.tensor_a_cluster_lengths[1]; 
-                                cfg.tensor_b_cluster_lengths[1] = cfg.tensor_a_cluster_lengths[1]; 
-                                cfg.tensor_b_cluster_lengths[3] = cfg.tensor_a_cluster_lengths[3]; 
-
-                                if ( cfg.tensor_a_cluster_lengths[3] > cfg.gemm_m_per_block  || cfg.tensor_b_cluster_lengths[3] > cfg.gemm_n_per_block )
-			             continue; 
-
-                                cfg.tensor_b_thread_lengths[0] = cfg.tensor_a_thread_lengths[0]; 
-                                cfg.tensor_b_thread_lengths[1] = cfg.tensor_a_thread_lengths[1]; 
-
-			        // use dimension c0/n0 for thread slice for gemm_m/gemm_n
-                                do {
-                                    cfg.tensor_a_thread_lengths[2] = cfg.gemm_m_per_block / cfg.tensor_a_cluster_lengths[3]; 
-                                    cfg.tensor_b_thread_lengths[2] = cfg.gemm_n_per_block / cfg.tensor_b_cluster_lengths[3]; 
-                                    cfg.tensor_a_thread_lengths[3] = 1; 
-                                    cfg.tensor_b_thread_lengths[3] = 1; 
-
-                                    tensor_a_soffset_sgprs = get_num_soffset_sgprs(cfg.tensor_a_thread_lengths[0], cfg.tensor_a_thread_lengths[2], 1);
-                                    tensor_b_soffset_sgprs = get_num_soffset_sgprs(cfg.tensor_b_thread_lengths[0], cfg.tensor_b_thread_lengths[2], 1);
-                         
-                                    // This is needed since some configurations consume too many scale registers
-                                    if ( tensor_a_soffset_sgprs + tensor_b_soffset_sgprs > get_available_sgprs_for_soffset(false) )
-				         break; 
-			        	
-                                    if ( unmerge_sub_n % cfg.tensor_b_thread_lengths[2] != 0) 
-			                 break; 
-
-                                    this->configs.push_back(cfg); 
-                                } while(0); 
-#if GENERATE_REDUCED_CONFIGS == 0
-                                // use dimension c1/n0 for thread slice for gemm_m/gemm_n
-                                do {
-                                    cfg.tensor_a_thread_lengths[3] = cfg.gemm_m_per_block / cfg.tensor_a_cluster_lengths[3];
-                                    cfg.tensor_b_thread_lengths[2] = cfg.gemm_n_per_block / cfg.tensor_b_cluster_lengths[3];  // tensor_b keep using n0 since it could not use vector load/store
-                                    cfg.tensor_a_thread_lengths[2] = 1; 
-                                    cfg.tensor_b_thread_lengths[3] = 1; 
-
-                                    if ( cfg.tensor_a_thread_lengths[3] == 1) 
-					 break; 
-
-                                    // global vector load puts limitations on the sizes of the thread slices (at most dwordx4 can be used) 
-                                    if ( cfg.tensor_a_thread_lengths[3] > max_vector_size)
-                                         break;
-
-                                    tensor_a_soffset_sgprs = get_num_soffset_sgprs(cfg.tensor_a_thread_lengths[0], cfg.tensor_a_thread_lengths[3], max_vector_size);
-                                    tensor_b_soffset_sgprs = get_num_soffset_sgprs(cfg.tensor_b_thread_lengths[0], cfg.tensor_b_thread_lengths[2], 1);
-
-                                    // This is needed since some configurations consume too many scale registers
-                                    if ( tensor_a_soffset_sgprs + tensor_b_soffset_sgprs > get_available_sgprs_for_soffset(false) )
-                                         break;
-
-                                    if ( unmerge_sub_n % cfg.tensor_b_thread_lengths[2] != 0)
-                                         break;
-
-                                    this->configs.push_back(cfg);
-                                } while(0);
-#endif				
-			    }; 
-			    
-                            // use dimension k1e for thread slice for gemm_K of tensor_a/tensor_b
-			    for(int sliceSize=2; sliceSize <= cfg.gemm_k_per_block; sliceSize *= 2) {
-                                cfg.tensor_a_thread_lengths[0] = 1;
-                                cfg.tensor_a_thread_lengths[1] = sliceSize;
-                                cfg.tensor_a_cluster_lengths[1] = cfg.gemm_k_per_block / sliceSize;
-
-                                int n_k1e = cfg.tensor_a_thread_lengths[1] * cfg.tensor_a_cluster_lengths[1];
-
-                                // this is a situation difficult to handle, so just give it up
-                                if ( std::string(precision) == "fp16" && n_k1e < 4 )
-                                     continue;
-
-                                cfg.tensor_a_cluster_lengths[3] = blockSize / cfg.tensor_a_cluster_lengths[1];
-                                cfg.tensor_b_cluster_lengths[1] = cfg.tensor_a_cluster_lengths[1];
-                                cfg.tensor_b_cluster_lengths[3] = cfg.tensor_a_cluster_lengths[3];
-
-                                if ( cfg.tensor_a_cluster_lengths[3] > cfg.gemm_m_per_block  || cfg.tensor_b_cluster_lengths[3] > cfg.gemm_n_per_block )
-                                     continue;
-
-                                cfg.tensor_b_thread_lengths[0] = cfg.tensor_a_thread_lengths[0]; 
-                                cfg.tensor_b_thread_lengths[1] = cfg.tensor_a_thread_lengths[1]; 
-
-                                // use dimension c1/n0 for thread slice for gemm_m/gemm_n
-                                do {
-                                    cfg.tensor_a_thread_lengths[3] = cfg.gemm_m_per_block / cfg.tensor_a_cluster_lengths[3];
-                                    cfg.tensor_b_thread_lengths[2] = cfg.gemm_n_per_block / cfg.tensor_b_cluster_lengths[3];
-                                    cfg.tensor_a_thread_lengths[2] = 1; 
-                                    cfg.tensor_b_thread_lengths[3] = 1; 
-
-                                    // we don't need this config 
-                                    if ( cfg.tensor_a_thread_lengths[3] == 1)
-                                         break;
-
-                                    // global vector load puts limitations on the sizes of the thread slices (at most dwordx4 can be used) 
-                                    if ( cfg.tensor_a_thread_lengths[3] > max_vector_size)
-                                         break; 
-
-                                    tensor_a_soffset_sgprs = get_num_soffset_sgprs(cfg.tensor_a_thread_lengths[1], cfg.tensor_a_thread_lengths[3], max_vector_size);
-                                    tensor_b_soffset_sgprs = get_num_soffset_sgprs(cfg.tensor_b_thread_lengths[1], cfg.tensor_b_thread_lengths[2], 1);
-
-                                    // This is needed since some configurations consume too many scale registers
-                                    if ( tensor_a_soffset_sgprs + tensor_b_soffset_sgprs > get_available_sgprs_for_soffset(false) )
-                                         break;
-
-                                    if ( unmerge_sub_n % cfg.tensor_b_thread_lengths[2] != 0)
-                                         break;
-
-                                    this->configs.push_back(cfg);
-                                } while(0);
-			    }; 
-		        }; 			
-                   };
-             };
-         };
-    };
+    // global vector load puts limitations on the sizes of the thread slices (at most dwordx4 can be used) 
+    if ( cfg.tensor_a_thread_lengths[3] > max_vector_size)
+         return(false);
+
+    int k_slice_a = use_k1e ? cfg.tensor_a_thread_lengths[1] : cfg.tensor_a_thread_lengths[0]; 
+    int k_slice_b = use_k1e ? cfg.tensor_b_thread_lengths[1] : cfg.tensor_b_thread_lengths[0]; 
+
+    int tensor_a_soffset_sgprs = get_num_soffset_sgprs(k_slice_a, cfg.tensor_a_thread_lengths[3], max_vector_size);
+    int tensor_b_soffset_sgprs = get_num_soffset_sgprs(k_slice_b, cfg.tensor_b_thread_lengths[2], 1);
+
+    // This is needed since some configurations consume too many scale registers
+    if ( tensor_a_soffset_sgprs + tensor_b_soffset_sgprs > get_available_sgprs_for_soffset(false) )
+         return(false);
+
+    if ( unmerge_sub_n % cfg.tensor_b_thread_lengths[2] != 0)
+         return(false);
+
+    return(true); 
+}; 
+
+// use c0/n0 for thread slice for gemm_m/gemm_n
+bool bwd_nchw_config::make_c0_n0_slices(igemm_gtc_packed_tunable_t &cfg, bool use_k1e, int unmerge_sub_n) const
+{
+    cfg.tensor_a_thread_lengths[2] = cfg.gemm_m_per_block / cfg.tensor_a_cluster_lengths[3];
+    cfg.tensor_b_thread_lengths[2] = cfg.gemm_n_per_block / cfg.tensor_b_cluster_lengths[3];
+    cfg.tensor_a_thread_lengths[3] = 1;
+    cfg.tensor_b_thread_lengths[3] = 1;
+
+    int k_slice_a = use_k1e ? cfg.tensor_a_thread_lengths[1] : cfg.tensor_a_thread_lengths[0]; 
+    int k_slice_b = use_k1e ? cfg.tensor_b_thread_lengths[1] : cfg.tensor_b_thread_lengths[0]; 
+
+    int tensor_a_soffset_sgprs = get_num_soffset_sgprs(k_slice_a, cfg.tensor_a_thread_lengths[2], 1); 
+    int tensor_b_soffset_sgprs = get_num_soffset_sgprs(k_slice_b, cfg.tensor_b_thread_lengths[2], 1); 
+
+    // Limitation due to large sgpr consumption in precache soffset, which is larger with nxe == 0
+    if ( tensor_a_soffset_sgprs + tensor_b_soffset_sgprs > get_available_sgprs_for_soffset(cfg.nxe == 0) ) 
+         return(false);
+
+    if ( unmerge_sub_n % cfg.tensor_b_thread_lengths[2] != 0) 
+         return(false); 
+
+    return(true); 
+}; 
+
+void bwd_nchw_config::generate_configs(const char *precision, const char *config_file)
+{
+    make_configs(precision);
+
+    config_ofstream_t ofs(config_file);
 
     output_configurations(this->configs, "k0xk1ExC0xC1", "K0xK1ExN0xN1B", ofs);
 
     std::cout << std::endl << this->configs.size() << " configs produced !" << std::endl;
 }; 
 
-bool BwdNchwSorter(igemm_gtc_tunable_t &cfg1, igemm_gtc_tunable_t &cfg2)
+// igemm_gtc_packed_tunable_t, or igemm_gtc_tunable_t
+template <typename tunable_t>
+bool BwdNchwSorter(tunable_t &cfg1, tunable_t &cfg2)
 {
      if ( cfg1.gemm_m_per_block > cfg2.gemm_m_per_block )
           return(true);
@@ -543,4 +407,29 @@ bool BwdNchwSorter(igemm_gtc_tunable_t &cfg1, igemm_gtc_tunable_t &cfg2)
      return(false);
 };
 
+// BwdNchwSorter() as a key, larger first, read from the tunable and its derived attributes
+static inline igemm_gtc_sort_key_t BwdNchwSortKey(const igemm_gtc_packed_tunable_t &cfg, const igemm_gtc_tunable_attributes_t &attributes)
+{
+     igemm_gtc_sort_key_t key;
+
+     // the sorter counts the threads on the k1e and n1b clusters of B only, and for nxe == 1 picks the order
+     // on tb_k1 from the tb_n1b of both tunables, which a key of one of them can not tell
+     key.exact = attributes.block_size == cfg.tensor_b_cluster_lengths[1] * cfg.tensor_b_cluster_lengths[3] &&
+                 !(cfg.nxe != 0 && cfg.tensor_b_thread_lengths[3] > 1);
+
+     key.push(cfg.gemm_m_per_block, 12, true);
+     key.push(attributes.block_size, 12, true);
+     key.push(cfg.tensor_b_cluster_lengths[3], 12, true);
+     key.push(cfg.gemm_k_per_block, 12, true);
+     key.push(cfg.nxe, 1, false);
+     key.push(cfg.nxb, 8, true);
+     key.push(cfg.wave_tile_k, 8, false);
+     key.push(cfg.nxe == 0 ? attributes.vector_b : 0, 6, true);
+     key.push(attributes.vector_a, 6, true);
+     key.push(cfg.tensor_b_thread_lengths[1], 6, cfg.tensor_b_thread_lengths[3] > 1);
+     key.push(cfg.tensor_a_thread_lengths[1], 6, cfg.tensor_a_thread_lengths[3] > 1);
+
+     return(key);
+};
+
 #endif
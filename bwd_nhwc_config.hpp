@@ -52,123 +52,119 @@ public:
     bwd_nhwc_config& operator=(bwd_nhwc_config&) = delete;
 
     void generate_configs(const char *precision, const char *config_file);
-private:
-    std::vector<igemm_gtc_tunable_t> configs;
+protected:
+    const std::vector<int> &get_nxb_values() const;
+    void add_search_axes(config_search_space_t &space_) const;
+    bool make_candidate(const config_search_digits_t &digits, igemm_gtc_packed_tunable_t &cfg) const;
+}; 
+
+const std::vector<int> &bwd_nhwc_config::get_nxb_values() const
+{
+    static const std::vector<int> nxb_values = { 1 };     // nxb is not used by bwd nhwc 
+
+    return(nxb_values);
+}; 
+
+void bwd_nhwc_config::add_search_axes(config_search_space_t &space_) const
+{
+    int max_vector_size = (precision == "fp16") ? 8 : 4; 
+    int max_k1_slice_size = max_vector_size; 
+    int min_k1_slice_size = (precision == "fp16")? 4 : 1; 
+    int max_c1_slice_size = max_vector_size; 
+    int min_c1_slice_size = 1; 
+
+    int num_k1_slices = 0; 
+    int num_c1_slices = 0; 
+
+    for (int k1_slice=min_k1_slice_size; k1_slice <= max_k1_slice_size; k1_slice *= 2) 
+         num_k1_slices++; 
+    for (int c1_slice=min_c1_slice_size; c1_slice <= max_c1_slice_size; c1_slice *= 2) 
+         num_c1_slices++; 
+
+    space_.add_axis("k1_slice", num_k1_slices);
+    space_.add_axis("c1_slice", num_c1_slices);
+}; 
+
+bool bwd_nhwc_config::make_candidate(const config_search_digits_t &digits, igemm_gtc_packed_tunable_t &cfg) const
+{
+    int blockSize; 
+
+    make_common(digits, cfg, blockSize); 
+
+    cfg.tensor_layout = igemm_gtc_tensor_layout_enum::nhwc; 
+    cfg.direction = igemm_gtc_direction_enum::bwd; 
+
+    int min_k1_slice_size = (precision == "fp16")? 4 : 1; 
+    int min_c1_slice_size = 1; 
+
+    // the following fields have constant value 1
+    cfg.tensor_a_thread_lengths[0] = 1; 
+    cfg.tensor_a_thread_lengths[3] = 1; 
+    cfg.tensor_a_cluster_lengths[1] = 1;
+    cfg.tensor_a_cluster_lengths[2] = 1; 
+
+    cfg.tensor_b_thread_lengths[1] = 1; 
+    cfg.tensor_b_thread_lengths[2] = 1; 
+    cfg.tensor_b_cluster_lengths[0] = 1; 
+    cfg.tensor_b_cluster_lengths[2] = 1; 
+
+    int k1_slice = min_k1_slice_size << digits[config_search_num_common_axes]; 
+
+    cfg.tensor_a_thread_lengths[1] = k1_slice; 
+    cfg.tensor_a_cluster_lengths[0] = cfg.gemm_k_per_block / k1_slice; 
+    if ( cfg.tensor_a_cluster_lengths[0] == 0 )
+         return(false); 
+    cfg.tensor_a_cluster_lengths[3] = blockSize / cfg.tensor_a_cluster_lengths[0]; 
+    if ( cfg.tensor_a_cluster_lengths[3] == 0 )
+         return(false); 
+    cfg.tensor_a_thread_lengths[2] = cfg.gemm_m_per_block / cfg.tensor_a_cluster_lengths[3]; 
+    if ( cfg.tensor_a_thread_lengths[2] == 0 )
+         return(false); 
+
+    // for fp16, lower gemm_k dim size must be at least 4 so that the gemm_k_pack can be accurately implemented
+    if ( precision == "fp16" && cfg.tensor_a_thread_lengths[1] < 4 ) 
+         return(false); 	
+
+    int c1_slice = min_c1_slice_size << digits[config_search_num_common_axes+1]; 
+
+    cfg.tensor_b_thread_lengths[3] = c1_slice; 
+    cfg.tensor_b_cluster_lengths[3] = cfg.gemm_n_per_block / c1_slice; 
+    if ( cfg.tensor_b_cluster_lengths[3] == 0 )
+         return(false);  
+    cfg.tensor_b_cluster_lengths[1] = blockSize / cfg.tensor_b_cluster_lengths[3]; 
+    if ( cfg.tensor_b_cluster_lengths[1] == 0 )
+         return(false);  
+    cfg.tensor_b_thread_lengths[0] = cfg.gemm_k_per_block / cfg.tensor_b_cluster_lengths[1]; 
+    if ( cfg.tensor_b_thread_lengths[0] == 0 )
+         return(false);  
+
+    // for fp16, lower gemm_k dim size must be at least 4 so that the gemm_k_pack can be accurately implemented
+    if ( precision == "fp16" && cfg.tensor_b_cluster_lengths[1] < 4 )
+         return(false);  
+
+    int k0_slice = cfg.tensor_b_thread_lengths[0]; 
+
+    // gemm_k_per_block must be divided exactly by k0*k1 (required by the bwd nhwc kernel implementation)
+    if ( cfg.gemm_k_per_block % (k0_slice*k1_slice) != 0 )
+         return(false); 
+
+    return(true); 
 }; 
 
 void bwd_nhwc_config::generate_configs(const char *precision, const char *config_file)
 {
-    std::ofstream ofs(config_file, std::ofstream::out);
-
-    int num_mappings = (std::string(precision) == "fp32")? NUM_XDLOPS_MAPPING_FP32 : NUM_XDLOPS_MAPPING_FP16; 
-
-    for (int i=0; i < num_mappings; i++) {
-         auto xm = (std::string(precision) == "fp32")? xdlops_mappings_fp32[i] : xdlops_mappings_fp16[i];
-
-         igemm_gtc_tunable_t cfg;
-
-         cfg.gemm_m_per_block = xm.macro_tile_m;
-         cfg.gemm_n_per_block = xm.macro_tile_n;
-         cfg.wave_tile_m = xm.wave_tile_m;
-         cfg.wave_tile_n = xm.wave_tile_n;
-         cfg.wave_tile_k = xm.wave_tile_k;
-         cfg.wave_repeat_m = xm.wave_repeat_m;
-         cfg.wave_repeat_n = xm.wave_repeat_n;
-         cfg.wave_step_m = xm.wave_step_m;
-         cfg.wave_step_n = xm.wave_step_n;
-
-         cfg.tensor_a_thread_lengths.resize(4);
-         cfg.tensor_a_cluster_lengths.resize(4);
-         cfg.tensor_b_thread_lengths.resize(4);
-         cfg.tensor_b_cluster_lengths.resize(4);
-
-         cfg.tensor_layout = "nhwc"; 
-         cfg.direction = "bwd"; 
-	 cfg.precision = precision; 
-
-         int blockSize = waveSize * xm.waves;
-
-         int max_vector_size = (std::string(precision) == "fp16") ? 8 : 4; 
-         int max_k1_slice_size = max_vector_size; 
-	 int min_k1_slice_size = (std::string(precision) == "fp16")? 4 : 1; 
-         int max_c1_slice_size = max_vector_size; 
-	 int min_c1_slice_size = 1; 
-
-         // the following fields have constant value 1
-         cfg.tensor_a_thread_lengths[0] = 1; 
-	 cfg.tensor_a_thread_lengths[3] = 1; 
-	 cfg.tensor_a_cluster_lengths[1] = 1;
-	 cfg.tensor_a_cluster_lengths[2] = 1; 
-
-	 cfg.tensor_b_thread_lengths[1] = 1; 
-	 cfg.tensor_b_thread_lengths[2] = 1; 
-	 cfg.tensor_b_cluster_lengths[0] = 1; 
-	 cfg.tensor_b_cluster_lengths[2] = 1; 
-
-         for (int nxe=0; nxe < 2; nxe += 1)  {
-              cfg.nxe = nxe;
-              cfg.nxb = 1;      // nxb is not used by bwd nhwc 
-
-              // consider the gemm_k_per_block sizes to be 2x, 4x, 8x that of the k_per_inst of the specific xlops instruction
-		   
-              // for fp32, gemm_k_per_block must be at lest 4-times multiplier of k_per_inst
-              int lower_k_shifts = std::string(precision) == "fp16"? 1 : 2; 
-              int upper_k_shifts = std::string(precision) == "fp16"? 3 : 4;
-
-              for (int k=lower_k_shifts; k < upper_k_shifts; k++) { 
-                   cfg.gemm_k_per_block = xm.wave_tile_k << k;
- 
-		   for (int k1_slice=min_k1_slice_size; k1_slice <= max_k1_slice_size; k1_slice *= 2) {
-                        cfg.tensor_a_thread_lengths[1] = k1_slice; 
-		        cfg.tensor_a_cluster_lengths[0] = cfg.gemm_k_per_block / k1_slice; 
-                        if ( cfg.tensor_a_cluster_lengths[0] == 0 )
-			     continue; 
-                        cfg.tensor_a_cluster_lengths[3] = blockSize / cfg.tensor_a_cluster_lengths[0]; 
-                        if ( cfg.tensor_a_cluster_lengths[3] == 0 )
-			     continue; 
-                        cfg.tensor_a_thread_lengths[2] = cfg.gemm_m_per_block / cfg.tensor_a_cluster_lengths[3]; 
-                        if ( cfg.tensor_a_thread_lengths[2] == 0 )
-			     continue; 
-
-                        // for fp16, lower gemm_k dim size must be at least 4 so that the gemm_k_pack can be accurately implemented
-                        if ( std::string(precision) == "fp16" && cfg.tensor_a_thread_lengths[1] < 4 ) 
-			     continue; 	
-
-			for (int c1_slice=min_c1_slice_size; c1_slice <= max_c1_slice_size; c1_slice *= 2) {
-                             cfg.tensor_b_thread_lengths[3] = c1_slice; 
-			     cfg.tensor_b_cluster_lengths[3] = cfg.gemm_n_per_block / c1_slice; 
-                             if ( cfg.tensor_b_cluster_lengths[3] == 0 )
-				  continue;  
-			     cfg.tensor_b_cluster_lengths[1] = blockSize / cfg.tensor_b_cluster_lengths[3]; 
-                             if ( cfg.tensor_b_cluster_lengths[1] == 0 )
-				  continue;  
-			     cfg.tensor_b_thread_lengths[0] = cfg.gemm_k_per_block / cfg.tensor_b_cluster_lengths[1]; 
-                             if ( cfg.tensor_b_thread_lengths[0] == 0 )
-				  continue;  
-
-                             // for fp16, lower gemm_k dim size must be at least 4 so that the gemm_k_pack can be accurately implemented
-                             if ( std::string(precision) == "fp16" && cfg.tensor_b_cluster_lengths[1] < 4 )
-				  continue;  
-
-                             int k0_slice = cfg.tensor_b_thread_lengths[0]; 
-
-                             // gemm_k_per_block must be divided exactly by k0*k1 (required by the bwd nhwc kernel implementation)
-			     if ( cfg.gemm_k_per_block % (k0_slice*k1_slice) != 0 )
-				  continue; 
-
-                             this->configs.push_back(cfg); 
-			}; 
-		   };  
-              };
-         };
-    };
+    make_configs(precision);
+
+    config_ofstream_t ofs(config_file);
 
     output_configurations(this->configs, "EK2K0xK1xN0xN1B", "K0xK1K2ExC0xC1", ofs);
 
     std::cout << std::endl << this->configs.size() << " configs produced !" << std::endl;
 }; 
 
-bool BwdNhwcSorter(igemm_gtc_tunable_t &cfg1, igemm_gtc_tunable_t &cfg2)
+// igemm_gtc_packed_tunable_t, or igemm_gtc_tunable_t
+template <typename tunable_t>
+bool BwdNhwcSorter(tunable_t &cfg1, tunable_t &cfg2)
 {
      // larger work-group size is preferred
      int blockSize_1 = cfg1.tensor_a_cluster_lengths[0] * cfg1.tensor_a_cluster_lengths[3];
@@ -229,4 +225,26 @@ bool BwdNhwcSorter(igemm_gtc_tunable_t &cfg1, igemm_gtc_tunable_t &cfg2)
      return(false);
 };
 
+// BwdNhwcSorter() as a key, larger first, read from the tunable and its derived attributes
+static inline igemm_gtc_sort_key_t BwdNhwcSortKey(const igemm_gtc_packed_tunable_t &cfg, const igemm_gtc_tunable_attributes_t &attributes)
+{
+     igemm_gtc_sort_key_t key;
+
+     // the sorter counts the threads on k0 and n1b only
+     key.exact = attributes.block_size == cfg.tensor_a_cluster_lengths[0] * cfg.tensor_a_cluster_lengths[3];
+
+     key.push(attributes.block_size, 12, true);
+     key.push(cfg.gemm_n_per_block, 12, true);
+     // not the saturated attributes.vector_a/b, a length over 255 has to leave the key inexact
+     key.push(cfg.tensor_a_thread_lengths[1], 8, true);
+     key.push(cfg.tensor_b_thread_lengths[3], 8, true);
+     key.push(cfg.tensor_a_thread_lengths[2], 8, true);
+     key.push(cfg.gemm_k_per_block, 12, true);
+     key.push(cfg.tensor_b_thread_lengths[0], 8, true);
+     key.push(cfg.nxe, 1, false);
+     key.push(cfg.wave_tile_k, 8, true);
+
+     return(key);
+};
+
 #endif
@@ -0,0 +1,131 @@
+/*******************************************************************************
+ *
+ * MIT License
+ *
+ * Copyright (c) 2020 Advanced Micro Devices, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "config_parser.hpp"
+#include "igemm_gtc_base.hpp"
+#include "igemm_gtc_set.hpp"
+#include "config_comm.hpp"
+
+int main(int argc, char **argv)
+{
+    if ( argc < 5 ) {
+         fprintf(stdout, "Usage: %s, <operation(union,intersection,difference,symmetric_difference)> <input configuration file> <input configuration file> [...] <output configuration file>\n", argv[0]);
+         return(-1);
+    };
+
+    int op = igemm_gtc_set_find_op(argv[1]);
+    if ( op < 0 ) {
+         std::cout << "Invalid set operation!" << std::endl;
+         return(-2);
+    };
+
+    auto start = std::chrono::steady_clock::now();
+
+    // a file given twice is loaded once, both lists are the same
+    std::vector<std::string> config_files(argv + 2, argv + argc - 1);
+    std::vector<std::string> distinct_files;
+    std::vector<size_t> file_index;
+    for (const auto &config_file : config_files) {
+         auto it = std::find(distinct_files.begin(), distinct_files.end(), config_file);
+         file_index.push_back(it - distinct_files.begin());
+         if ( it == distinct_files.end() )
+              distinct_files.push_back(config_file);
+    };
+
+    int num_threads = std::max(1, (int)std::thread::hardware_concurrency());
+    std::vector<std::vector<igemm_gtc_packed_tunable_t>> loaded(distinct_files.size());
+    igemm_gtc_parallel_for(distinct_files.size(), num_threads, [&](size_t i) {
+         loaded[i] = igemm_gtc_tunable_load_packed(distinct_files[i]);
+    });
+
+    // moved on the last use of a file, copied before
+    std::vector<std::vector<igemm_gtc_packed_tunable_t>> lists;
+    for (size_t l = 0; l < file_index.size(); l++) {
+         size_t i = file_index[l];
+         if ( std::find(file_index.begin() + l + 1, file_index.end(), i) == file_index.end() )
+              lists.push_back(std::move(loaded[i]));
+         else
+              lists.push_back(loaded[i]);
+    };
+
+    // output_configurations() writes a single direction, precision and layout
+    const igemm_gtc_packed_tunable_t *first = nullptr;
+    for (size_t l = 0; l < lists.size(); l++) {
+         fprintf(stdout, "%s: %zu tunables\n", config_files[l].c_str(), lists[l].size());
+         for (const auto &tunable : lists[l]) {
+              if ( first == nullptr )
+                   first = &tunable;
+              if ( tunable.direction != first->direction || tunable.precision != first->precision ||
+                   tunable.tensor_layout != first->tensor_layout ) {
+                   fprintf(stdout, "%s has %s %s %s tunables, the first ones are %s %s %s\n", config_files[l].c_str(),
+                           tunable.get_direction(), tunable.get_precision(), tunable.get_tensor_layout(),
+                           first->get_direction(), first->get_precision(), first->get_tensor_layout());
+                   return(-2);
+              };
+         };
+    };
+
+    std::vector<igemm_gtc_packed_tunable_t> result = igemm_gtc_tunable_set_op(lists, static_cast<igemm_gtc_set_op_enum>(op), num_threads);
+
+    const char *tensor_a_desc = "";
+    const char *tensor_b_desc = "";
+    if ( first != nullptr ) {
+         std::string direction(first->get_direction());
+         std::string layout(first->get_tensor_layout());
+
+         if ( direction == "fwd" && layout == "nchw" ) {
+              tensor_a_desc = "C0xC1ExK0xK1";
+              tensor_b_desc = "C0xC1ExN0xN1B";
+         }
+         else
+         if ( direction == "bwd" && layout == "nchw" ) {
+              tensor_a_desc = "k0xk1ExC0xC1";
+              tensor_b_desc = "K0xK1ExN0xN1B";
+         }
+         else
+         if ( direction == "bwd" && layout == "nhwc" ) {
+              tensor_a_desc = "EK2K0xK1xN0xN1B";
+              tensor_b_desc = "K0xK1K2ExC0xC1";
+         }
+         else
+              throw std::runtime_error("Not implemented at present");
+    };
+
+    config_ofstream_t ofs(argv[argc - 1]);
+    output_configurations(result, tensor_a_desc, tensor_b_desc, ofs);
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::endl << result.size() << " configs in the " << igemm_gtc_set_op_names[op] << ", " << seconds << " s" << std::endl;
+};
@@ -0,0 +1,626 @@
+/*******************************************************************************
+ *
+ * MIT License
+ *
+ * Copyright (c) 2020 Advanced Micro Devices, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef __CONFIG_BINARY_HPP__
+#define __CONFIG_BINARY_HPP__
+
+#include <assert.h>
+#include <memory>
+#include <stdexcept>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <string_view>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+#include "config_parser.hpp"
+#include "utility.hpp"
+
+/*
+* compiled form of a config file, laid out so that it can be used straight from
+* a read-only mapping. All fields are native endian and fixed width:
+*
+*   config_binary_header_t
+*   key table       num_keys     x config_binary_key_t
+*   section table   num_sections x config_binary_section_t
+*   value table     num_values   x config_binary_value_t, grouped by section
+*   string pool     key and section names, not null terminated
+*   data pool       encoded value bytes (see section_meta_value_t<>), 4 byte aligned
+*
+* the header also records size, mtime and content hash of the text file it was
+* compiled from, so it can serve as a cache of that file, and every section its
+* place and hash in that text (see config_parser_t::split_sections()), so a
+* recompile only has to parse the sections that changed.
+*/
+#define CONFIG_BINARY_MAGIC "IGCFGBIN"
+#define CONFIG_BINARY_VERSION 3
+
+struct config_binary_header_t {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t source_size;
+    int64_t source_mtime_ns;
+    uint64_t source_hash;
+    uint32_t num_keys;
+    uint32_t num_sections;
+    uint32_t num_values;
+    uint32_t reserved;
+    uint64_t keys_offset;
+    uint64_t sections_offset;
+    uint64_t values_offset;
+    uint64_t strings_offset;
+    uint64_t strings_size;
+    uint64_t data_offset;
+    uint64_t data_size;
+};
+
+struct config_binary_key_t {
+    uint32_t name_offset;
+    uint32_t name_length;
+};
+
+struct config_binary_section_t {
+    uint32_t name_offset;
+    uint32_t name_length;
+    uint32_t first_value;
+    uint32_t num_values;
+    uint64_t source_offset;     // config_section_span_t of the section in the text
+    uint64_t source_length;
+    uint64_t source_hash;
+};
+
+struct config_binary_value_t {
+    uint32_t key;           // index into the key table
+    uint32_t type;          // config_section_value_type_enum
+    uint32_t data_offset;   // into the data pool
+    uint32_t data_length;
+};
+
+// size and modification time of 'file', false if it can not be stat'ed
+static inline bool config_binary_stat_file(const std::string &file, uint64_t &size, int64_t &mtime_ns)
+{
+    struct stat st;
+    if (stat(file.c_str(), &st) != 0)
+        return false;
+    size = static_cast<uint64_t>(st.st_size);
+    mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+    return true;
+}
+
+/*
+* a value inside a compiled file, it only points into the mapping and has the
+* same accessors as config_section_value_t
+*/
+class config_binary_value_view_t
+    : public config_value_accessor_t<config_binary_value_view_t> {
+  public:
+    config_binary_value_view_t(config_section_value_type_enum type_, config_value_bytes_t bytes_)
+        : value_type(type_), bytes(bytes_) {}
+
+    config_section_value_type_enum get_type() const { return value_type; }
+    config_value_bytes_t get_bytes() const { return bytes; }
+
+  private:
+    config_section_value_type_enum value_type;
+    config_value_bytes_t bytes;
+};
+
+/*
+* a section inside a compiled file. Lookups are a scan over the few values of
+* the section, comparing interned key ids.
+*/
+class config_binary_section_view_t {
+  public:
+    config_binary_section_view_t(std::string_view name_,
+                                 const config_binary_value_t *values_,
+                                 uint32_t num_values_,
+                                 const uint8_t *data_,
+                                 const config_key_t *keys_,
+                                 config_section_span_t span_ = config_section_span_t{0, 0, 0})
+        : name(name_), values(values_), num_values(num_values_), data(data_), keys(keys_), span(span_) {}
+
+    std::string_view get_name() const { return name; }
+    size_t size() const { return num_values; }
+    const config_section_span_t &get_span() const { return span; }
+
+    config_key_t key(size_t i) const { return keys[values[i].key]; }
+    config_binary_value_view_t value(size_t i) const {
+        const config_binary_value_t &v = values[i];
+        return config_binary_value_view_t(static_cast<config_section_value_type_enum>(v.type),
+                                          config_value_bytes_t(data + v.data_offset, v.data_length));
+    }
+
+    size_t count(config_key_t k) const { return find(k) < 0 ? 0 : 1; }
+    config_binary_value_view_t at(config_key_t k) const {
+        int pos = find(k);
+        if (pos < 0)
+            throw std::out_of_range("config_binary_section_view_t::at");
+        return value(pos);
+    }
+    size_t count(std::string_view k) const { return count(config_key_t::find(k)); }
+    config_binary_value_view_t at(std::string_view k) const { return at(config_key_t::find(k)); }
+
+    // deep copy into a regular section
+    config_section_t to_section() const {
+        config_section_t section{std::string(name)};
+        for (size_t i = 0; i < num_values; i++) {
+            config_value_bytes_t bytes = value(i).get_bytes();
+            section.at(key(i)) = config_section_value_t(value(i).get_type(),
+                                                        std::vector<uint8_t>(bytes.begin(), bytes.end()));
+        }
+        section.shrink_to_fit();
+        return section;
+    }
+
+  private:
+    std::string_view name;
+    const config_binary_value_t *values;
+    uint32_t num_values;
+    const uint8_t *data;
+    const config_key_t *keys;   // key table of the file, mapped to interned keys
+    config_section_span_t span;
+
+    int find(config_key_t k) const {
+        for (uint32_t i = 0; i < num_values; i++) {
+            if (keys[values[i].key] == k)
+                return static_cast<int>(i);
+        }
+        return -1;
+    }
+};
+
+/*
+* builds the compiled image of a config file, section by section, so it can be
+* fed directly from config_parser_t::parse_sections()
+*/
+class config_binary_writer_t {
+  public:
+    config_binary_writer_t() : source_size(0), source_mtime_ns(0), source_hash(0) {}
+
+    void set_source(uint64_t size, int64_t mtime_ns, uint64_t hash) {
+        source_size = size;
+        source_mtime_ns = mtime_ns;
+        source_hash = hash;
+    }
+
+    // 'span' locates the section in the text it comes from, if any
+    void add_section(const config_section_t &section,
+                     const config_section_span_t &span = config_section_span_t{0, 0, 0}) {
+        begin_section(section.get_name(), section.size(), span);
+        for (const auto &kv : section)
+            add_value(kv.first, kv.second.get_type(), kv.second.get_bytes());
+    }
+    // copy of a section of another compiled file, without decoding it
+    void add_section(const config_binary_section_view_t &section,
+                     const config_section_span_t &span) {
+        begin_section(section.get_name(), section.size(), span);
+        for (size_t i = 0; i < section.size(); i++)
+            add_value(section.key(i), section.value(i).get_type(), section.value(i).get_bytes());
+    }
+
+    void add_content(const config_content_t &content) {
+        for (const auto &section : content)
+            add_section(section);
+    }
+
+    std::vector<uint8_t> get_image() const {
+        config_binary_header_t header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, CONFIG_BINARY_MAGIC, sizeof(header.magic));
+        header.version = CONFIG_BINARY_VERSION;
+        header.header_size = sizeof(config_binary_header_t);
+        header.source_size = source_size;
+        header.source_mtime_ns = source_mtime_ns;
+        header.source_hash = source_hash;
+        header.num_keys = static_cast<uint32_t>(keys.size());
+        header.num_sections = static_cast<uint32_t>(sections.size());
+        header.num_values = static_cast<uint32_t>(values.size());
+        header.keys_offset = align(sizeof(config_binary_header_t));
+        header.sections_offset = align(header.keys_offset + keys.size() * sizeof(config_binary_key_t));
+        header.values_offset = align(header.sections_offset + sections.size() * sizeof(config_binary_section_t));
+        header.strings_offset = align(header.values_offset + values.size() * sizeof(config_binary_value_t));
+        header.strings_size = strings.size();
+        header.data_offset = align(header.strings_offset + strings.size());
+        header.data_size = data.size();
+
+        std::vector<uint8_t> image(header.data_offset + data.size(), 0);
+        memcpy(image.data(), &header, sizeof(header));
+        copy_to(image, header.keys_offset, keys.data(), keys.size() * sizeof(config_binary_key_t));
+        copy_to(image, header.sections_offset, sections.data(), sections.size() * sizeof(config_binary_section_t));
+        copy_to(image, header.values_offset, values.data(), values.size() * sizeof(config_binary_value_t));
+        copy_to(image, header.strings_offset, strings.data(), strings.size());
+        copy_to(image, header.data_offset, data.data(), data.size());
+        return image;
+    }
+
+    // the file is written aside and renamed into place, so a reader never sees
+    // a partial image. Returns false if the file could not be written.
+    static bool write_image(const std::string &file, const std::vector<uint8_t> &image) {
+        std::string tmp_file = file + ".tmp." + std::to_string(getpid());
+        FILE *fp = fopen(tmp_file.c_str(), "wb");
+        if (!fp)
+            return false;
+        bool ok = fwrite(image.data(), 1, image.size(), fp) == image.size();
+        ok = (fclose(fp) == 0) && ok;
+        if (ok)
+            ok = rename(tmp_file.c_str(), file.c_str()) == 0;
+        if (!ok)
+            unlink(tmp_file.c_str());
+        return ok;
+    }
+
+    bool write(const std::string &file) const { return write_image(file, get_image()); }
+
+  private:
+    uint64_t source_size;
+    int64_t source_mtime_ns;
+    uint64_t source_hash;
+
+    std::vector<config_binary_key_t> keys;
+    std::vector<uint32_t> key_index;    // interned key id -> index in 'keys' + 1
+    std::vector<config_binary_section_t> sections;
+    std::vector<config_binary_value_t> values;
+    std::string strings;
+    std::unordered_map<std::string, uint32_t> section_names;
+    std::vector<uint8_t> data;
+
+    static uint64_t align(uint64_t offset) { return (offset + 7) & ~static_cast<uint64_t>(7); }
+    static void copy_to(std::vector<uint8_t> &image, uint64_t offset, const void *src, size_t length) {
+        if (length != 0)
+            memcpy(image.data() + offset, src, length);
+    }
+
+    void begin_section(std::string_view section_name, size_t num_values,
+                       const config_section_span_t &span) {
+        config_binary_section_t s;
+        auto it = section_names.find(std::string(section_name));
+        if (it == section_names.end())
+            it = section_names.emplace(std::string(section_name), add_string(section_name)).first;
+        s.name_offset = it->second;
+        s.name_length = static_cast<uint32_t>(section_name.size());
+        s.first_value = static_cast<uint32_t>(values.size());
+        s.num_values = static_cast<uint32_t>(num_values);
+        s.source_offset = span.offset;
+        s.source_length = span.length;
+        s.source_hash = span.hash;
+        sections.push_back(s);
+    }
+    void add_value(config_key_t key, config_section_value_type_enum type, config_value_bytes_t bytes) {
+        config_binary_value_t v;
+        v.key = add_key(key);
+        v.type = static_cast<uint32_t>(type);
+        v.data_offset = static_cast<uint32_t>(data.size());
+        v.data_length = static_cast<uint32_t>(bytes.size());
+        data.insert(data.end(), bytes.begin(), bytes.end());
+        data.resize((data.size() + 3) & ~static_cast<size_t>(3), 0);
+        values.push_back(v);
+        assert(data.size() <= 0xffffffffULL && strings.size() <= 0xffffffffULL);
+    }
+    uint32_t add_string(std::string_view s) {
+        uint32_t offset = static_cast<uint32_t>(strings.size());
+        strings.append(s.data(), s.size());
+        return offset;
+    }
+    uint32_t add_key(config_key_t key) {
+        uint32_t id = key.get_id();
+        if (id >= key_index.size())
+            key_index.resize(id + 1, 0);
+        if (key_index[id] == 0) {
+            const std::string &name = key.str();
+            config_binary_key_t k;
+            k.name_offset = add_string(name);
+            k.name_length = static_cast<uint32_t>(name.size());
+            keys.push_back(k);
+            key_index[id] = static_cast<uint32_t>(keys.size());
+        }
+        return key_index[id] - 1;
+    }
+};
+
+/*
+* zero-copy reader of a compiled file. Opening validates the tables once, after
+* that sections and values are views into the mapping (or the in-memory image),
+* which must stay open as long as they are used.
+*/
+class config_binary_reader_t {
+  public:
+    class const_iterator {
+      public:
+        const_iterator(const config_binary_reader_t *reader_, size_t index_)
+            : reader(reader_), index(index_) {}
+        config_binary_section_view_t operator*() const { return reader->get_section(index); }
+        const_iterator &operator++() {
+            index++;
+            return *this;
+        }
+        bool operator==(const const_iterator &other) const { return index == other.index; }
+        bool operator!=(const const_iterator &other) const { return index != other.index; }
+
+      private:
+        const config_binary_reader_t *reader;
+        size_t index;
+    };
+
+    config_binary_reader_t() : header(NULL), sections(NULL), values(NULL), strings(NULL), data(NULL) {}
+    config_binary_reader_t(const config_binary_reader_t &) = delete;
+    config_binary_reader_t &operator=(const config_binary_reader_t &) = delete;
+
+    // false if 'file' is missing or not a valid compiled file
+    bool open(const std::string &file) {
+        close();
+        mapped_file.reset(new config_mapped_file_t(file, false));
+        if (!mapped_file->is_open() ||
+            !attach(reinterpret_cast<const uint8_t *>(mapped_file->data()), mapped_file->size())) {
+            close();
+            return false;
+        }
+        return true;
+    }
+    bool open(std::vector<uint8_t> &&image_) {
+        close();
+        image = std::move(image_);
+        if (!attach(image.data(), image.size())) {
+            close();
+            return false;
+        }
+        return true;
+    }
+    void close() {
+        header = NULL;
+        sections = NULL;
+        values = NULL;
+        strings = NULL;
+        data = NULL;
+        keys.clear();
+        mapped_file.reset();
+        image.clear();
+    }
+    bool is_open() const { return header != NULL; }
+
+    const config_binary_header_t &get_header() const { return *header; }
+    size_t size() const { return header ? header->num_sections : 0; }
+
+    config_binary_section_view_t get_section(size_t i) const {
+        const config_binary_section_t &s = sections[i];
+        return config_binary_section_view_t(std::string_view(strings + s.name_offset, s.name_length),
+                                            values + s.first_value, s.num_values, data, keys.data(),
+                                            config_section_span_t{static_cast<size_t>(s.source_offset),
+                                                                  static_cast<size_t>(s.source_length),
+                                                                  s.source_hash});
+    }
+    // first section with name 'sec_name', like config_content_t::get_section()
+    config_binary_section_view_t get_section(std::string_view sec_name) const {
+        for (size_t i = 0; i < size(); i++) {
+            const config_binary_section_t &s = sections[i];
+            if (std::string_view(strings + s.name_offset, s.name_length) == sec_name)
+                return get_section(i);
+        }
+        return config_binary_section_view_t("sec_na", NULL, 0, data, keys.data());
+    }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+
+    config_content_t to_content() const {
+        config_content_t content;
+        for (const auto &section : *this)
+            content.add_section(section.to_section());
+        return content;
+    }
+
+  private:
+    std::unique_ptr<config_mapped_file_t> mapped_file;
+    std::vector<uint8_t> image;
+
+    const config_binary_header_t *header;
+    const config_binary_section_t *sections;
+    const config_binary_value_t *values;
+    const char *strings;
+    const uint8_t *data;
+    std::vector<config_key_t> keys;
+
+    static bool in_range(uint64_t offset, uint64_t length, uint64_t limit) {
+        return offset <= limit && length <= limit - offset;
+    }
+
+    bool attach(const uint8_t *base, size_t length) {
+        if (length < sizeof(config_binary_header_t))
+            return false;
+        const config_binary_header_t *h = reinterpret_cast<const config_binary_header_t *>(base);
+        if (memcmp(h->magic, CONFIG_BINARY_MAGIC, sizeof(h->magic)) != 0 ||
+            h->version != CONFIG_BINARY_VERSION ||
+            h->header_size != sizeof(config_binary_header_t))
+            return false;
+        if ((h->keys_offset | h->sections_offset | h->values_offset | h->data_offset) & 7)
+            return false;
+        if (!in_range(h->keys_offset, uint64_t(h->num_keys) * sizeof(config_binary_key_t), length) ||
+            !in_range(h->sections_offset, uint64_t(h->num_sections) * sizeof(config_binary_section_t), length) ||
+            !in_range(h->values_offset, uint64_t(h->num_values) * sizeof(config_binary_value_t), length) ||
+            !in_range(h->strings_offset, h->strings_size, length) ||
+            !in_range(h->data_offset, h->data_size, length))
+            return false;
+
+        const config_binary_key_t *k = reinterpret_cast<const config_binary_key_t *>(base + h->keys_offset);
+        const config_binary_section_t *s = reinterpret_cast<const config_binary_section_t *>(base + h->sections_offset);
+        const config_binary_value_t *v = reinterpret_cast<const config_binary_value_t *>(base + h->values_offset);
+        const char *str = reinterpret_cast<const char *>(base + h->strings_offset);
+
+        for (uint32_t i = 0; i < h->num_sections; i++) {
+            if (!in_range(s[i].name_offset, s[i].name_length, h->strings_size) ||
+                !in_range(s[i].first_value, s[i].num_values, h->num_values))
+                return false;
+        }
+        for (uint32_t i = 0; i < h->num_values; i++) {
+            if (v[i].key >= h->num_keys ||
+                v[i].type > static_cast<uint32_t>(config_section_value_type_enum::config_section_value_type_string) ||
+                (v[i].data_offset & 3) != 0 ||
+                !in_range(v[i].data_offset, v[i].data_length, h->data_size))
+                return false;
+        }
+        keys.reserve(h->num_keys);
+        for (uint32_t i = 0; i < h->num_keys; i++) {
+            if (!in_range(k[i].name_offset, k[i].name_length, h->strings_size))
+                return false;
+            keys.emplace_back(std::string_view(str + k[i].name_offset, k[i].name_length));
+        }
+
+        header = h;
+        sections = s;
+        values = v;
+        strings = str;
+        data = base + h->data_offset;
+        return true;
+    }
+};
+
+/*
+* '<config_file>.bin' next to a text config, holding its compiled image. The
+* cache is only used while size, mtime and content hash of the text still match
+* what it was compiled from, otherwise the text is parsed and the cache rewritten.
+* Failing to write the cache (e.g. read-only directory) is not an error.
+*/
+class config_binary_cache_t {
+  public:
+    config_binary_cache_t(std::string config_file_, int num_threads_ = 0)
+        : config_file(config_file_), cache_file(config_file_ + ".bin"), num_threads(num_threads_) {}
+
+    const std::string &get_cache_file() const { return cache_file; }
+
+    // true if the cache is up to date, and then 'reader' is open on it
+    bool load(config_binary_reader_t &reader) const {
+        uint64_t size;
+        int64_t mtime_ns;
+        if (!config_binary_stat_file(config_file, size, mtime_ns))
+            return false;
+        if (!reader.open(cache_file))
+            return false;
+        const config_binary_header_t &header = reader.get_header();
+        if (header.source_size == size && header.source_mtime_ns == mtime_ns) {
+            config_mapped_file_t mapped_file(config_file);
+            if (utility_hash64(mapped_file.data(), mapped_file.size()) == header.source_hash)
+                return true;
+        }
+        reader.close();
+        return false;
+    }
+
+    // compile the text, rewrite the cache and open 'reader' on the result. The
+    // sections whose hash is found in the previous cache are copied from it,
+    // only the others are parsed, in runs of adjacent sections.
+    //
+    // a gzip file is identified by its compressed bytes, and parsed as a whole
+    // through the streaming inflate of config_parser_t, without reuse
+    void rebuild(config_binary_reader_t &reader) const {
+        uint64_t size = 0;
+        int64_t mtime_ns = 0;
+        config_binary_stat_file(config_file, size, mtime_ns);
+        config_mapped_file_t mapped_file(config_file);
+        std::string_view text = mapped_file.view();
+        config_binary_writer_t writer;
+        writer.set_source(mapped_file.size(), mtime_ns, utility_hash64(text.data(), text.size()));
+        if (config_gzip_is_compressed(config_file)) {
+            config_parser_t(config_file).parse_sections([&](config_section_t &&section) {
+                writer.add_section(section);
+            });
+            write_and_open(writer, reader);
+            return;
+        }
+
+        std::vector<config_section_span_t> spans = config_parser_t::split_sections(text);
+        config_binary_reader_t previous;
+        std::unordered_map<uint64_t, uint32_t> previous_sections;
+        if (previous.open(cache_file)) {
+            previous_sections.reserve(previous.size());
+            for (size_t i = 0; i < previous.size(); i++)
+                previous_sections.emplace(previous.get_section(i).get_span().hash, static_cast<uint32_t>(i));
+        }
+
+        std::vector<size_t> reused(spans.size(), invalid_section);
+        std::vector<size_t> parsed_spans;
+        std::vector<std::string_view> runs;
+        // text before the first section holds no key, parsing it only reports the error if it does
+        if (spans.empty() || spans[0].offset != 0)
+            runs.push_back(text.substr(0, spans.empty() ? text.size() : spans[0].offset));
+        for (size_t i = 0; i < spans.size(); i++) {
+            auto it = previous_sections.find(spans[i].hash);
+            if (it != previous_sections.end()) {
+                reused[i] = it->second;
+                continue;
+            }
+            parsed_spans.push_back(i);
+            if (!runs.empty() && runs.back().data() + runs.back().size() == text.data() + spans[i].offset &&
+                runs.back().size() < run_bytes)
+                runs.back() = std::string_view(runs.back().data(), runs.back().size() + spans[i].length);
+            else
+                runs.push_back(text.substr(spans[i].offset, spans[i].length));
+        }
+
+        // parsed sections come in file order, the reused ones are copied in between
+        size_t next_span = 0;
+        size_t next_parsed = 0;
+        auto copy_reused = [&](size_t until) {
+            for (; next_span < until; next_span++)
+                writer.add_section(previous.get_section(reused[next_span]), spans[next_span]);
+        };
+        config_parser_t parser(config_file, config_parse_mode_enum::config_parse_mode_parallel, num_threads);
+        parser.parse_chunks_parallel(runs, [&](config_section_t &&section) {
+            size_t i = parsed_spans[next_parsed++];
+            copy_reused(i);
+            writer.add_section(section, spans[i]);
+            next_span = i + 1;
+        });
+        assert(next_parsed == parsed_spans.size());
+        copy_reused(spans.size());
+        previous.close();
+        write_and_open(writer, reader);
+    }
+
+    void open(config_binary_reader_t &reader) const {
+        if (!load(reader))
+            rebuild(reader);
+    }
+
+  private:
+    void write_and_open(const config_binary_writer_t &writer, config_binary_reader_t &reader) const {
+        std::vector<uint8_t> image = writer.get_image();
+        config_binary_writer_t::write_image(cache_file, image);
+        bool ok = reader.open(std::move(image));
+        assert(ok);
+        (void)ok;
+    }
+
+    static constexpr size_t invalid_section = static_cast<size_t>(-1);
+    static constexpr size_t run_bytes = 1024 * 1024;
+
+    std::string config_file;
+    std::string cache_file;
+    int num_threads;
+};
+
+#endif
@@ -26,6 +26,7 @@
 #ifndef __CONFIG_COMM_HPP__
 #define __CONFIG_COMM_HPP__
 
+#include <array>
 #include <cassert>
 #include <cstdio>
 #include <cstdlib>
@@ -35,6 +36,7 @@
 #include <map> 
 #include <memory>
 #include <fstream>
+#include <limits>
 #include <iostream>
 #include <string>
 
@@ -62,6 +64,11 @@ typedef struct {
 #define GENERATE_REDUCED_CONFIGS 1
 #endif
 
+// the generators and reorder_configs_* drop the configs they would output twice
+#ifndef DROP_DUPLICATED_CONFIGS
+#define DROP_DUPLICATED_CONFIGS 1
+#endif
+
 // The mappings are strictly ranked in macro-tile sizes (gemm_m_per_block, gemm_n_per_block)
 static xdlops_mapping_t xdlops_mappings_fp16[] = {
         { 256, 128,  64,  32,  4, 4,  2,  2,  1,  1,  },
@@ -223,12 +230,12 @@ static xdlops_mapping_t xdlops_mappings_fp32[] = {
 
 static const int waveSize = 64; 
 
-static inline void output_single_config(const igemm_gtc_tunable_t & cfg, const std::string & direction, const std::string & precision, const std::string & layout,
+static inline void output_single_config(const igemm_gtc_packed_tunable_t & cfg, const std::string & direction, const std::string & precision, const std::string & layout,
 	                                const char *tensor_a_desc, const char *tensor_b_desc, std::ostream &myout)
 {
-         assert( direction == cfg.direction && precision == cfg.precision && layout == cfg.tensor_layout ); 
+         assert( direction == cfg.get_direction() && precision == cfg.get_precision() && layout == cfg.get_tensor_layout() ); 
 
-         myout << "#--------------------------- " << cfg.gemm_m_per_block << "x" << cfg.gemm_n_per_block << std::endl;
+         myout << "#--------------------------- " << cfg.gemm_m_per_block << "x" << cfg.gemm_n_per_block << '\n';
          
 	 const char *sectionMark;
 	
@@ -237,68 +244,158 @@ static inline void output_single_config(const igemm_gtc_tunable_t & cfg, const s
 	 else 
 	     sectionMark = "[igemm_bwd_gtc]";
 
-         myout << sectionMark  << std::endl;
-         myout << "gemm_m_per_block         = " << cfg.gemm_m_per_block << std::endl;
-         myout << "gemm_n_per_block         = " << cfg.gemm_n_per_block << std::endl;
-         myout << "gemm_k_per_block         = " << cfg.gemm_k_per_block << std::endl;
-         myout << "wave_tile_m              = " << cfg.wave_tile_m << std::endl;
-         myout << "wave_step_m              = " << cfg.wave_step_m << std::endl;
-         myout << "wave_repeat_m            = " << cfg.wave_repeat_m << std::endl;
-         myout << "wave_tile_n              = " << cfg.wave_tile_n << std::endl;
-         myout << "wave_step_n              = " << cfg.wave_step_n << std::endl;
-         myout << "wave_repeat_n            = " << cfg.wave_repeat_n << std::endl;
+         myout << sectionMark  << '\n';
+         myout << "gemm_m_per_block         = " << cfg.gemm_m_per_block << '\n';
+         myout << "gemm_n_per_block         = " << cfg.gemm_n_per_block << '\n';
+         myout << "gemm_k_per_block         = " << cfg.gemm_k_per_block << '\n';
+         myout << "wave_tile_m              = " << cfg.wave_tile_m << '\n';
+         myout << "wave_step_m              = " << cfg.wave_step_m << '\n';
+         myout << "wave_repeat_m            = " << cfg.wave_repeat_m << '\n';
+         myout << "wave_tile_n              = " << cfg.wave_tile_n << '\n';
+         myout << "wave_step_n              = " << cfg.wave_step_n << '\n';
+         myout << "wave_repeat_n            = " << cfg.wave_repeat_n << '\n';
 
-         myout << "wave_tile_k              = " << cfg.wave_tile_k << std::endl;
+         myout << "wave_tile_k              = " << cfg.wave_tile_k << '\n';
 
 	 std::string tensor_a_comment =  std::string("    #  ") + tensor_a_desc; 
 	 std::string tensor_b_comment =  std::string("    #  ") + tensor_b_desc; 
 
          myout << "tensor_a_thread_lengths  = [" << cfg.tensor_a_thread_lengths[0] <<  ", " << cfg.tensor_a_thread_lengths[1] << ", ";
-         myout << cfg.tensor_a_thread_lengths[2] << ", " << cfg.tensor_a_thread_lengths[3]   << "]" << tensor_a_comment << std::endl;
+         myout << cfg.tensor_a_thread_lengths[2] << ", " << cfg.tensor_a_thread_lengths[3]   << "]" << tensor_a_comment << '\n';
 
          myout << "tensor_a_cluster_lengths = [" << cfg.tensor_a_cluster_lengths[0] << ", " << cfg.tensor_a_cluster_lengths[1] << ", ";
-         myout << cfg.tensor_a_cluster_lengths[2] << ", " << cfg.tensor_a_cluster_lengths[3] << "]" << tensor_a_comment << std::endl;
+         myout << cfg.tensor_a_cluster_lengths[2] << ", " << cfg.tensor_a_cluster_lengths[3] << "]" << tensor_a_comment << '\n';
 
          myout << "tensor_b_thread_lengths  = [" << cfg.tensor_b_thread_lengths[0] <<  ", " << cfg.tensor_b_thread_lengths[1] << ", ";
-         myout << cfg.tensor_b_thread_lengths[2] << ", " << cfg.tensor_b_thread_lengths[3]   << "]" << tensor_b_comment << std::endl;
+         myout << cfg.tensor_b_thread_lengths[2] << ", " << cfg.tensor_b_thread_lengths[3]   << "]" << tensor_b_comment << '\n';
 
          myout << "tensor_b_cluster_lengths = [" << cfg.tensor_b_cluster_lengths[0] << ", " << cfg.tensor_b_cluster_lengths[1] << ", ";
-         myout << cfg.tensor_b_cluster_lengths[2] << ", " << cfg.tensor_b_cluster_lengths[3] << "]" << tensor_b_comment << std::endl;
+         myout << cfg.tensor_b_cluster_lengths[2] << ", " << cfg.tensor_b_cluster_lengths[3] << "]" << tensor_b_comment << '\n';
 
-         myout << "tensor_layout            = " << '\'' << cfg.tensor_layout << '\'' << std::endl; 
+         myout << "tensor_layout            = " << '\'' << cfg.get_tensor_layout() << '\'' << '\n'; 
 
-         myout << "direction                = " << '\'' << direction << '\'' << std::endl;
-         myout << "precision                = " << '\'' << precision << '\'' << std::endl;
+         myout << "direction                = " << '\'' << direction << '\'' << '\n';
+         myout << "precision                = " << '\'' << precision << '\'' << '\n';
 
-         myout << "nxb                      = " << cfg.nxb << std::endl;
-         myout << "nxe                      = " << cfg.nxe << std::endl;
+         myout << "nxb                      = " << (int)cfg.nxb << '\n';
+         myout << "nxe                      = " << (int)cfg.nxe << '\n';
 };
 
-static void output_configurations(std::vector<igemm_gtc_tunable_t> &configs, const char *tensor_a_desc, const char *tensor_b_desc, std::ostream &myout)
+static void output_configurations(std::vector<igemm_gtc_packed_tunable_t> &configs, const char *tensor_a_desc, const char *tensor_b_desc, std::ostream &myout)
 {
     static const char *arch="\'gfx908\'";
     static const char *code_object="\'cov3\'";
     static const char *mode = "\'flat\'";
 
-    myout << "[codegen]" << std::endl;
-    myout << "arch = " << arch << std::endl;
-    myout << "code_object = " << code_object << std::endl;
-    myout << "mode = " << mode << std::endl;
+    myout << "[codegen]" << '\n';
+    myout << "arch = " << arch << '\n';
+    myout << "code_object = " << code_object << '\n';
+    myout << "mode = " << mode << '\n';
 
-    myout << std::endl;
+    myout << '\n';
 
     if (configs.size() <= 0)
 	return; 
 
-    std::string direction(configs[0].direction);
-    std::string precision(configs[0].precision);
-    std::string layout(configs[0].tensor_layout);  
+    std::string direction(configs[0].get_direction());
+    std::string precision(configs[0].get_precision());
+    std::string layout(configs[0].get_tensor_layout());  
 
     for (const auto& cfg : configs) {
          myout << std::dec;
-         myout << std::endl;
+         myout << '\n';
          output_single_config(cfg, direction, precision, layout, tensor_a_desc, tensor_b_desc, myout);
     };
+
+    // lines end with '\n' rather than std::endl, the stream is flushed once for the whole file
+    myout.flush();
+};
+
+static inline void drop_duplicated_configurations(std::vector<igemm_gtc_packed_tunable_t> &configs)
+{
+#if DROP_DUPLICATED_CONFIGS
+    size_t dropped = igemm_gtc_tunable_drop_duplicates(configs);
+    if ( dropped > 0 )
+         std::cout << dropped << " duplicated configs dropped" << std::endl;
+#endif
+};
+
+// tunables loaded from a config file
+static void output_configurations(const std::vector<igemm_gtc_tunable_t> &configs, const char *tensor_a_desc, const char *tensor_b_desc, std::ostream &myout)
+{
+    std::vector<igemm_gtc_packed_tunable_t> packed_configs = igemm_gtc_tunable_pack(configs);
+    output_configurations(packed_configs, tensor_a_desc, tensor_b_desc, myout);
+};
+
+// at most this many axes in the search space of a generator
+#define CONFIG_SEARCH_MAX_AXES 8
+
+typedef std::array<int, CONFIG_SEARCH_MAX_AXES> config_search_digits_t;
+
+/*
+* mixed radix numbering of the candidates the nested loops of a generator
+* visit: one axis per loop, the first axis the outermost loop and the last one
+* the innermost, so counting the ranks up visits the candidates in the order the
+* loops did. A rank is a plain integer, so a space can be cut into contiguous
+* shards, sampled uniformly, or its candidates kept as 32 bits ids.
+*/
+class config_search_space_t
+{
+public:
+    config_search_space_t() : num_axes(0) {}
+
+    void add_axis(const char *name, int radix)
+    {
+         assert( num_axes < CONFIG_SEARCH_MAX_AXES && radix > 0 );
+         names[num_axes] = name;
+         radices[num_axes] = radix;
+         num_axes++;
+    };
+
+    int get_num_axes() const { return(num_axes); };
+    const char *get_axis_name(int axis) const { return(names[axis]); };
+    int get_radix(int axis) const { return(radices[axis]); };
+
+    uint64_t size() const
+    {
+         uint64_t n = 1;
+         for (int axis=0; axis < num_axes; axis++)
+              n *= radices[axis];
+         return(n);
+    };
+
+    uint64_t rank(const config_search_digits_t &digits) const
+    {
+         uint64_t r = 0;
+         for (int axis=0; axis < num_axes; axis++) {
+              assert( digits[axis] >= 0 && digits[axis] < radices[axis] );
+              r = r * radices[axis] + digits[axis];
+         };
+         return(r);
+    };
+
+    void unrank(uint64_t rank, config_search_digits_t &digits) const
+    {
+         assert( rank < size() );
+         for (int axis=num_axes-1; axis >= 0; axis--) {
+              digits[axis] = static_cast<int>(rank % radices[axis]);
+              rank /= radices[axis];
+         };
+    };
+
+private:
+    const char *names[CONFIG_SEARCH_MAX_AXES];
+    int radices[CONFIG_SEARCH_MAX_AXES];
+    int num_axes;
+};
+
+// the axes every generator starts its search space with, the generator adds its own after them
+enum config_search_axis_enum {
+    config_search_axis_mapping = 0,    // index in xdlops_mappings_fp32/fp16
+    config_search_axis_nxe,            // 0 or 1
+    config_search_axis_nxb,            // index in get_nxb_values()
+    config_search_axis_k_shift,        // gemm_k_per_block is wave_tile_k << (get_lower_k_shifts() + k_shift)
+    config_search_num_common_axes,
 };
 
 class basic_igemm_config
@@ -310,8 +407,152 @@ public:
     basic_igemm_config(const basic_igemm_config&) = delete;
     basic_igemm_config& operator=(basic_igemm_config&) = delete;
 
+    // binds the generator to 'precision_' and lays out its search space
+    void set_precision(const char *precision_)
+    {
+         precision = precision_;
+         space = config_search_space_t();
+         space.add_axis("mapping", get_num_mappings());
+         space.add_axis("nxe", 2);
+         space.add_axis("nxb", static_cast<int>(get_nxb_values().size()));
+         space.add_axis("k_shift", 2);
+         add_search_axes(space);
+         assert( space.size() <= std::numeric_limits<uint32_t>::max() );
+    };
+
+    const config_search_space_t &search_space() const { return(space); };
+
+    // the candidate of rank 'rank', false when the generator rejects it
+    bool unrank(uint64_t rank, igemm_gtc_packed_tunable_t &cfg) const
+    {
+         config_search_digits_t digits;
+         space.unrank(rank, digits);
+         return( make_candidate(digits, cfg) );
+    };
+
+    // the lowest rank giving 'cfg', which is the one the generator keeps when it drops the
+    // duplicated configs. The common axes come from the fields of 'cfg', only the axes of the
+    // generator are searched
+    bool rank(const igemm_gtc_packed_tunable_t &cfg, uint64_t &r) const
+    {
+         const std::vector<int> &nxb_values = get_nxb_values();
+         uint64_t inner_size = 1;
+         for (int axis=config_search_num_common_axes; axis < space.get_num_axes(); axis++)
+              inner_size *= space.get_radix(axis);
+
+         config_search_digits_t digits;
+         digits.fill(0);
+         digits[config_search_axis_nxe] = cfg.nxe;
+         digits[config_search_axis_nxb] = static_cast<int>(std::find(nxb_values.begin(), nxb_values.end(), cfg.nxb) - nxb_values.begin());
+         if ( cfg.nxe > 1 || digits[config_search_axis_nxb] == static_cast<int>(nxb_values.size()) )
+              return(false);
+
+         igemm_gtc_packed_tunable_t candidate;
+         for (int i=0; i < get_num_mappings(); i++) {
+              const xdlops_mapping_t &xm = get_mapping(i);
+              if ( cfg.gemm_m_per_block != xm.macro_tile_m || cfg.gemm_n_per_block != xm.macro_tile_n ||
+                   cfg.wave_tile_m != xm.wave_tile_m || cfg.wave_tile_n != xm.wave_tile_n || cfg.wave_tile_k != xm.wave_tile_k ||
+                   cfg.wave_repeat_m != xm.wave_repeat_m || cfg.wave_repeat_n != xm.wave_repeat_n ||
+                   cfg.wave_step_m != xm.wave_step_m || cfg.wave_step_n != xm.wave_step_n )
+                   continue;
+              digits[config_search_axis_mapping] = i;
+              for (int k_shift=0; k_shift < 2; k_shift++) {
+                   if ( cfg.gemm_k_per_block != (xm.wave_tile_k << (get_lower_k_shifts() + k_shift)) )
+                        continue;
+                   digits[config_search_axis_k_shift] = k_shift;
+                   uint64_t first = space.rank(digits) / inner_size * inner_size;
+                   for (uint64_t candidate_rank=first; candidate_rank < first + inner_size; candidate_rank++) {
+                        if ( unrank(candidate_rank, candidate) && candidate == cfg ) {
+                             r = candidate_rank;
+                             return(true);
+                        };
+                   };
+              };
+         };
+         return(false);
+    };
+
+    // the ranks in [first, last) of the candidates the generator accepts
+    std::vector<uint32_t> valid_ranks(uint64_t first, uint64_t last) const
+    {
+         std::vector<uint32_t> ranks;
+         igemm_gtc_packed_tunable_t cfg;
+         for (uint64_t r=first; r < std::min<uint64_t>(last, space.size()); r++)
+              if ( unrank(r, cfg) )
+                   ranks.push_back(static_cast<uint32_t>(r));
+         return(ranks);
+    };
+
+    // the deduplicated tunables of the whole space, without writing them anywhere
+    const std::vector<igemm_gtc_packed_tunable_t> &make_configs(const char *precision_)
+    {
+         set_precision(precision_);
+
+         this->configs.clear();
+
+         igemm_gtc_packed_tunable_t cfg;
+         for (uint64_t r=0; r < space.size(); r++)
+              if ( unrank(r, cfg) )
+                   this->configs.push_back(cfg);
+
+         drop_duplicated_configurations(this->configs);
+
+         return(this->configs);
+    };
+
     virtual void generate_configs(const char *precision, const char *config_file) = 0;
-private:
+
+protected:
+    // the nxb values the generator tries, in order
+    virtual const std::vector<int> &get_nxb_values() const = 0;
+    // the axes of the generator, after the common ones
+    virtual void add_search_axes(config_search_space_t &space_) const = 0;
+    // the candidate at 'digits', false for the ones the loops of the generator skip
+    virtual bool make_candidate(const config_search_digits_t &digits, igemm_gtc_packed_tunable_t &cfg) const = 0;
+
+    int get_num_mappings() const
+    {
+         return( precision == "fp32" ? NUM_XDLOPS_MAPPING_FP32 : NUM_XDLOPS_MAPPING_FP16 );
+    };
+
+    const xdlops_mapping_t &get_mapping(int i) const
+    {
+         return( precision == "fp32" ? xdlops_mappings_fp32[i] : xdlops_mappings_fp16[i] );
+    };
+
+    // for fp32, gemm_k_per_block must be at lest 4-times multiplier of k_per_inst
+    int get_lower_k_shifts() const { return( precision == "fp16" ? 1 : 2 ); };
+
+    // the fields the common axes give, the block size of the mapping in 'blockSize'
+    void make_common(const config_search_digits_t &digits, igemm_gtc_packed_tunable_t &cfg, int &blockSize) const
+    {
+         const xdlops_mapping_t &xm = get_mapping(digits[config_search_axis_mapping]);
+
+         cfg = igemm_gtc_packed_tunable_t();
+
+         cfg.gemm_m_per_block = xm.macro_tile_m;
+         cfg.gemm_n_per_block = xm.macro_tile_n;
+         cfg.wave_tile_m = xm.wave_tile_m;
+         cfg.wave_tile_n = xm.wave_tile_n;
+         cfg.wave_tile_k = xm.wave_tile_k;
+         cfg.wave_repeat_m = xm.wave_repeat_m;
+         cfg.wave_repeat_n = xm.wave_repeat_n;
+         cfg.wave_step_m = xm.wave_step_m;
+         cfg.wave_step_n = xm.wave_step_n;
+
+         igemm_gtc_enum_from_name(igemm_gtc_precision_names, precision.c_str(), cfg.precision);
+         cfg.fma_type = igemm_gtc_fma_type_enum::xdlops;     // as the wave_tile_* fields make igemm_gtc_tunable_from_config() read it
+
+         cfg.nxe = digits[config_search_axis_nxe];
+         cfg.nxb = get_nxb_values()[digits[config_search_axis_nxb]];
+         cfg.gemm_k_per_block = xm.wave_tile_k << (get_lower_k_shifts() + digits[config_search_axis_k_shift]);
+
+         blockSize = waveSize * xm.waves;
+    };
+
+    std::string precision;
+    config_search_space_t space;
+    std::vector<igemm_gtc_packed_tunable_t> configs;
 };
 
 /*
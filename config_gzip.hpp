@@ -0,0 +1,177 @@
+/*******************************************************************************
+ *
+ * MIT License
+ *
+ * Copyright (c) 2020 Advanced Micro Devices, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef __CONFIG_GZIP_HPP__
+#define __CONFIG_GZIP_HPP__
+
+#include <errno.h>
+#include <fstream>
+#include <ostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <streambuf>
+#include <string>
+#include <zlib.h>
+
+/*
+* gzip support for config files, through zlib. Inputs are recognized by their
+* magic bytes whatever their name, outputs are compressed when the file name
+* ends with ".gz".
+*/
+
+// true if 'file_name' starts with the gzip magic bytes
+static inline bool config_gzip_is_compressed(const std::string &file_name)
+{
+    unsigned char magic[2];
+    FILE *fp = fopen(file_name.c_str(), "rb");
+    if (!fp)
+        return false;
+    bool compressed = fread(magic, 1, 2, fp) == 2 && magic[0] == 0x1f && magic[1] == 0x8b;
+    fclose(fp);
+    return compressed;
+}
+
+static inline bool config_gzip_has_suffix(const std::string &file_name)
+{
+    return file_name.size() > 3 && file_name.compare(file_name.size() - 3, 3, ".gz") == 0;
+}
+
+/*
+* inflates a gzip file block by block, concatenated members included
+*/
+class config_gzip_reader_t {
+  public:
+    config_gzip_reader_t(const std::string &file_name) : file(gzopen(file_name.c_str(), "rb")) {
+        if (!file) {
+            printf("fail to open file:%s, %s\n", file_name.c_str(), strerror(errno));
+            exit(-1);
+        }
+        gzbuffer(file, read_buffer_bytes);
+    }
+    ~config_gzip_reader_t() { gzclose(file); }
+    config_gzip_reader_t(const config_gzip_reader_t &) = delete;
+    config_gzip_reader_t &operator=(const config_gzip_reader_t &) = delete;
+
+    // up to 'length' bytes of text into 'data', 0 at the end of the file
+    size_t read(char *data, size_t length) {
+        int n = gzread(file, data, static_cast<unsigned>(length));
+        if (n < 0) {
+            int err;
+            printf("fail to inflate file, %s\n", gzerror(file, &err));
+            exit(-1);
+        }
+        return static_cast<size_t>(n);
+    }
+
+  private:
+    static constexpr unsigned read_buffer_bytes = 256 * 1024;
+    gzFile file;
+};
+
+/*
+* std::streambuf deflating into a gzip file. sync() only hands the buffered
+* text to zlib, it does not flush the compressor, so std::endl stays cheap.
+*/
+class config_gzip_streambuf_t : public std::streambuf {
+  public:
+    config_gzip_streambuf_t() : file(NULL) {}
+    ~config_gzip_streambuf_t() { close(); }
+
+    bool open(const std::string &file_name, int level = Z_DEFAULT_COMPRESSION) {
+        std::string mode = level == Z_DEFAULT_COMPRESSION ? "wb" : "wb" + std::to_string(level);
+        file = gzopen(file_name.c_str(), mode.c_str());
+        setp(buffer, buffer + sizeof(buffer));
+        return file != NULL;
+    }
+    bool is_open() const { return file != NULL; }
+    bool close() {
+        if (!file)
+            return true;
+        bool ok = write_buffer();
+        ok &= gzclose(file) == Z_OK;
+        file = NULL;
+        return ok;
+    }
+
+  protected:
+    int_type overflow(int_type c) override {
+        if (!file || !write_buffer())
+            return traits_type::eof();
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+    int sync() override { return file && write_buffer() ? 0 : -1; }
+
+  private:
+    bool write_buffer() {
+        int length = static_cast<int>(pptr() - pbase());
+        if (length != 0 && gzwrite(file, pbase(), static_cast<unsigned>(length)) != length)
+            return false;
+        setp(buffer, buffer + sizeof(buffer));
+        return true;
+    }
+
+    gzFile file;
+    char buffer[64 * 1024];
+};
+
+/*
+* output file stream that writes gzip when 'file_name' ends with ".gz", and
+* plain text like std::ofstream otherwise
+*/
+class config_ofstream_t : public std::ostream {
+  public:
+    config_ofstream_t(const std::string &file_name) : std::ostream(NULL) {
+        bool ok;
+        if (config_gzip_has_suffix(file_name)) {
+            ok = gzip_buffer.open(file_name);
+            rdbuf(&gzip_buffer);
+        } else {
+            ok = file_buffer.open(file_name, std::ios_base::out | std::ios_base::trunc) != NULL;
+            rdbuf(&file_buffer);
+        }
+        if (!ok)
+            setstate(std::ios_base::failbit);
+    }
+    ~config_ofstream_t() { flush(); }
+
+    // finish the file, false if any write failed
+    bool close() {
+        flush();
+        bool ok = !fail();
+        ok &= gzip_buffer.is_open() ? gzip_buffer.close() : file_buffer.close() != NULL;
+        return ok;
+    }
+
+  private:
+    std::filebuf file_buffer;
+    config_gzip_streambuf_t gzip_buffer;
+};
+
+#endif
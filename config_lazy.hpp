@@ -0,0 +1,274 @@
+/*******************************************************************************
+ *
+ * MIT License
+ *
+ * Copyright (c) 2020 Advanced Micro Devices, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef __CONFIG_LAZY_HPP__
+#define __CONFIG_LAZY_HPP__
+
+#include <assert.h>
+#include <deque>
+#include <memory>
+#include <stdexcept>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "config_gzip.hpp"
+#include "config_parser.hpp"
+
+/*
+* two phase loading of a config file. Opening it only runs the line scanner
+* over the text and records, for every section, its name and byte range, and
+* for every key the place of its raw value. A value is classified and decoded
+* on its first access and cached from then on, so a tool filtering on a couple
+* of keys never decodes the others.
+*
+* the cache is filled from const accessors, so concurrent first accesses to
+* one config_lazy_content_t are not safe.
+*/
+struct config_lazy_entry_t {
+    config_key_t key;
+    mutable uint32_t decoded;   // index in the value cache, or not_decoded
+    uint32_t value_offset;      // raw value, relative to the section start
+    uint32_t value_length;
+
+    static constexpr uint32_t not_decoded = 0xffffffff;
+};
+
+typedef std::deque<config_section_value_t> config_lazy_value_cache_t;
+
+/*
+* a section of a config_lazy_content_t, with the lookups of config_section_t
+*/
+class config_lazy_section_view_t {
+  public:
+    config_lazy_section_view_t(std::string_view name_,
+                               std::string_view text_,
+                               const config_lazy_entry_t *entries_,
+                               uint32_t num_entries_,
+                               config_lazy_value_cache_t *cache_)
+        : name(name_), text(text_), entries(entries_), num_entries(num_entries_), cache(cache_) {}
+
+    std::string_view get_name() const { return name; }
+    // bytes of the section in the file, from its '[name]' line to the next section
+    std::string_view get_text() const { return text; }
+    size_t size() const { return num_entries; }
+
+    config_key_t key(size_t i) const { return entries[i].key; }
+    std::string_view raw_value(size_t i) const {
+        return text.substr(entries[i].value_offset, entries[i].value_length);
+    }
+    const config_section_value_t &value(size_t i) const {
+        const config_lazy_entry_t &entry = entries[i];
+        if (entry.decoded == config_lazy_entry_t::not_decoded) {
+            cache->push_back(config_section_value_t::parse_value(raw_value(i)));
+            entry.decoded = static_cast<uint32_t>(cache->size() - 1);
+        }
+        return (*cache)[entry.decoded];
+    }
+
+    size_t count(config_key_t k) const { return find(k) < 0 ? 0 : 1; }
+    const config_section_value_t &at(config_key_t k) const {
+        int pos = find(k);
+        if (pos < 0)
+            throw std::out_of_range("config_lazy_section_view_t::at");
+        return value(pos);
+    }
+    size_t count(std::string_view k) const { return count(config_key_t::find(k)); }
+    const config_section_value_t &at(std::string_view k) const { return at(config_key_t::find(k)); }
+
+    // decode every value into a regular section
+    config_section_t to_section() const {
+        config_section_t section(name);
+        for (size_t i = 0; i < num_entries; i++)
+            section.at(key(i)) = value(i);
+        section.shrink_to_fit();
+        return section;
+    }
+
+  private:
+    std::string_view name;
+    std::string_view text;
+    const config_lazy_entry_t *entries;
+    uint32_t num_entries;
+    config_lazy_value_cache_t *cache;
+
+    int find(config_key_t k) const {
+        for (uint32_t i = 0; i < num_entries; i++) {
+            if (entries[i].key == k)
+                return static_cast<int>(i);
+        }
+        return -1;
+    }
+};
+
+class config_lazy_content_t {
+  public:
+    class const_iterator {
+      public:
+        const_iterator(const config_lazy_content_t *content_, size_t index_)
+            : content(content_), index(index_) {}
+        config_lazy_section_view_t operator*() const { return content->get_section(index); }
+        const_iterator &operator++() {
+            index++;
+            return *this;
+        }
+        bool operator==(const const_iterator &other) const { return index == other.index; }
+        bool operator!=(const const_iterator &other) const { return index != other.index; }
+
+      private:
+        const config_lazy_content_t *content;
+        size_t index;
+    };
+
+    config_lazy_content_t() {}
+    config_lazy_content_t(const std::string &config_file) { open(config_file); }
+    config_lazy_content_t(const config_lazy_content_t &) = delete;
+    config_lazy_content_t &operator=(const config_lazy_content_t &) = delete;
+
+    // map the file, or inflate it if it is gzip, and index it
+    void open(const std::string &config_file) {
+        if (config_gzip_is_compressed(config_file)) {
+            config_gzip_reader_t reader(config_file);
+            std::string inflated;
+            std::vector<char> block(1024 * 1024);
+            for (size_t length; (length = reader.read(block.data(), block.size())) != 0;)
+                inflated.append(block.data(), length);
+            attach(std::move(inflated));
+            return;
+        }
+        std::unique_ptr<config_mapped_file_t> mapped(new config_mapped_file_t(config_file));
+        std::string_view view = mapped->view();
+        attach(view);
+        mapped_file = std::move(mapped);
+        owned_text.clear();
+    }
+    void attach(std::string &&text_) {
+        owned_text = std::move(text_);
+        attach(std::string_view(owned_text));
+    }
+    // index 'text_', which has to outlive this content
+    void attach(std::string_view text_) {
+        text = text_;
+        sections.clear();
+        entries.clear();
+        cache.clear();
+        index();
+    }
+
+    size_t size() const { return sections.size(); }
+    // number of values decoded so far
+    size_t num_decoded() const { return cache.size(); }
+
+    config_lazy_section_view_t get_section(size_t i) const {
+        const section_record_t &s = sections[i];
+        return config_lazy_section_view_t(s.name, text.substr(s.offset, s.length), entries.data() + s.first_entry,
+                                          s.num_entries, &cache);
+    }
+    // first section with name 'sec_name', like config_content_t::get_section()
+    config_lazy_section_view_t get_section(std::string_view sec_name) const {
+        for (size_t i = 0; i < size(); i++) {
+            if (sections[i].name == sec_name)
+                return get_section(i);
+        }
+        return config_lazy_section_view_t("sec_na", std::string_view(), NULL, 0, &cache);
+    }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+
+    config_content_t to_content() const {
+        config_content_t content;
+        for (const auto &section : *this)
+            content.add_section(section.to_section());
+        return content;
+    }
+
+  private:
+    struct section_record_t {
+        std::string_view name;
+        size_t offset;
+        size_t length;
+        uint32_t first_entry;
+        uint32_t num_entries;
+    };
+
+    std::unique_ptr<config_mapped_file_t> mapped_file;
+    std::string owned_text;
+    std::string_view text;
+    std::vector<section_record_t> sections;
+    std::vector<config_lazy_entry_t> entries;
+    mutable config_lazy_value_cache_t cache;
+
+    // the first phase, same line grammar and errors as config_parser_t::parse_buffer(),
+    // but no value is looked at
+    void index() {
+        config_line_scanner_t scanner(text);
+        config_line_t line;
+        while (scanner.next(line)) {
+            if (line.kind == config_line_kind_enum::config_line_kind_blank)
+                continue;
+            if (line.kind == config_line_kind_enum::config_line_kind_section) {
+                close_section(line.offset);
+                sections.push_back({line.key, line.offset, 0, static_cast<uint32_t>(entries.size()), 0});
+                continue;
+            }
+            if (sections.empty()) {
+                printf("no current section, should not happen\n");
+                exit(-1);
+            }
+            if (line.kind == config_line_kind_enum::config_line_kind_bad) {
+                printf("fail to parse current line:%.*s, not enough tokens\n",
+                       (int)line.text.length(), line.text.data());
+                exit(-1);
+            }
+            if (line.key.empty() || line.value.empty()) {
+                printf("fail to parse current line:%.*s, token empty\n",
+                       (int)line.text.length(), line.text.data());
+            }
+            section_record_t &section = sections.back();
+            config_key_t key(line.key);
+            for (size_t i = section.first_entry; i < entries.size(); i++) {
+                if (entries[i].key == key) {
+                    printf("duplicate key %s in current section\n", key.c_str());
+                    exit(-1);
+                }
+            }
+            size_t value_offset = line.value.empty() ? 0 : static_cast<size_t>(line.value.data() - text.data()) - section.offset;
+            assert(value_offset + line.value.size() <= 0xffffffff);
+            entries.push_back({key, config_lazy_entry_t::not_decoded, static_cast<uint32_t>(value_offset),
+                               static_cast<uint32_t>(line.value.size())});
+            section.num_entries++;
+        }
+        close_section(text.size());
+    }
+    void close_section(size_t end) {
+        if (!sections.empty())
+            sections.back().length = end - sections.back().offset;
+    }
+};
+
+#endif
@@ -26,16 +26,42 @@
 #ifndef __CONFIG_PARSER_HPP__
 #define __CONFIG_PARSER_HPP__
 
+#include <algorithm>
 #include <assert.h>
+#include <atomic>
+#include <charconv>
+#include <condition_variable>
+#include <deque>
+#include <errno.h>
+#include <fcntl.h>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <shared_mutex>
 #include <sstream>
+#include <stdexcept>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
 #include <unordered_map>
 #include <vector>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "config_gzip.hpp"
+#include "utility.hpp"
 
 std::string ParseBaseArg(int argc, char* argv[])
 {
@@ -63,6 +89,8 @@ static inline std::string &sltrim(std::string &s) {
     size_t startpos = s.find_first_not_of(" \t\r\n\v\f");
     if (std::string::npos != startpos) {
         s = s.substr(startpos);
+    } else {
+        s.clear();
     }
     return s;
 }
@@ -71,6 +99,8 @@ static inline std::string &srtrim(std::string &s) {
     size_t endpos = s.find_last_not_of(" \t\r\n\v\f");
     if (std::string::npos != endpos) {
         s = s.substr(0, endpos + 1);
+    } else {
+        s.clear();
     }
     return s;
 }
@@ -86,6 +116,23 @@ static inline std::string remove_trailing_comment(std::string & s)
     return s;
 }
 
+// string_view flavor of the helpers above, they only move the view bounds
+static inline std::string_view svtrim(std::string_view s) {
+    size_t startpos = s.find_first_not_of(" \t\r\n\v\f");
+    if (std::string_view::npos == startpos)
+        return std::string_view();
+    size_t endpos = s.find_last_not_of(" \t\r\n\v\f");
+    return s.substr(startpos, endpos - startpos + 1);
+}
+
+static inline std::string_view sv_remove_trailing_comment(std::string_view s)
+{
+    size_t pos = s.find_first_of(";#");
+    if(std::string_view::npos != pos)
+        s = s.substr(0, pos);
+    return s;
+}
+
 static inline std::vector<std::string> ssplit(const std::string &s,
                                               char delim) {
     std::stringstream ss(s);
@@ -108,19 +155,98 @@ enum class config_section_value_type_enum {
     config_section_value_type_non = 7
 };
 
+/*
+* non-owning view over a run of decoded elements, this is what the
+* zero-allocation accessors of config_section_value_t return
+*/
+template <typename T>
+struct config_value_span_t {
+    config_value_span_t() : ptr(NULL), len(0) {}
+    config_value_span_t(const T *ptr_, size_t len_) : ptr(ptr_), len(len_) {}
+    config_value_span_t(const std::vector<T> &v) : ptr(v.data()), len(v.size()) {}
+
+    const T *data() const { return ptr; }
+    size_t size() const { return len; }
+    bool empty() const { return len == 0; }
+    const T *begin() const { return ptr; }
+    const T *end() const { return ptr + len; }
+    const T &operator[](size_t i) const { return ptr[i]; }
+    const T &back() const { return ptr[len - 1]; }
+    std::vector<T> to_vector() const { return std::vector<T>(ptr, ptr + len); }
+
+  private:
+    const T *ptr;
+    size_t len;
+};
+
+/*
+* lazy (start, end, step) range of ints, with the elements of python's range():
+* start, start + step, ... up to 'end' excluded. A step of 0 gives no elements.
+* Elements are computed on access, nothing is materialized.
+*/
+struct config_value_range_t {
+    class iterator {
+      public:
+        iterator(const config_value_range_t *range_, size_t index_) : range(range_), index(index_) {}
+        int operator*() const { return (*range)[index]; }
+        iterator &operator++() { index++; return *this; }
+        bool operator==(const iterator &other) const { return index == other.index; }
+        bool operator!=(const iterator &other) const { return index != other.index; }
+
+      private:
+        const config_value_range_t *range;
+        size_t index;
+    };
+
+    config_value_range_t() : range_start(0), range_end(0), range_step(1) {}
+    config_value_range_t(int start, int end, int step)
+        : range_start(start), range_end(end), range_step(step) {}
+
+    int get_start() const { return range_start; }
+    int get_end() const { return range_end; }
+    int get_step() const { return range_step; }
+
+    size_t size() const {
+        if (range_step > 0 && range_end > range_start)
+            return static_cast<size_t>(((int64_t)range_end - range_start + range_step - 1) / range_step);
+        if (range_step < 0 && range_end < range_start)
+            return static_cast<size_t>(((int64_t)range_start - range_end - range_step - 1) / -(int64_t)range_step);
+        return 0;
+    }
+    bool empty() const { return size() == 0; }
+    int operator[](size_t i) const { return static_cast<int>(range_start + (int64_t)i * range_step); }
+    int back() const { return (*this)[size() - 1]; }
+    iterator begin() const { return iterator(this, 0); }
+    iterator end() const { return iterator(this, size()); }
+    std::vector<int> to_vector() const {
+        std::vector<int> v(size());
+        for (size_t i = 0; i < v.size(); i++)
+            v[i] = (*this)[i];
+        return v;
+    }
+
+  private:
+    int range_start;
+    int range_end;
+    int range_step;
+};
+
+// encoded bytes of a value, in the layout produced by section_meta_value_t<>::encode
+typedef config_value_span_t<uint8_t> config_value_bytes_t;
+
 class config_section_value_t;
 
 template <config_section_value_type_enum value_type>
 struct section_meta_value_t {
     typedef decltype(value_type) type;
-    static type decode(const std::vector<uint8_t> &buffer) {
+    static type decode(config_value_bytes_t buffer) {
         return value_type;
     }
     static void encode(std::vector<uint8_t> &buffer, std::string value) {
         (void)buffer;
         (void)value;
     }
-    static std::string serialize(const std::vector<uint8_t> &buffer) {
+    static std::string serialize(config_value_bytes_t buffer) {
         return std::string("");
     }
 };
@@ -129,7 +255,7 @@ template <>
 struct section_meta_value_t<
     config_section_value_type_enum::config_section_value_type_int> {
     typedef int type;
-    static type decode(const std::vector<uint8_t> &buffer) {
+    static type decode(config_value_bytes_t buffer) {
         assert(buffer.size() == 4);
         int res;
         memcpy(&res, buffer.data(), 4);
@@ -140,7 +266,7 @@ struct section_meta_value_t<
         int res = std::stoi(value);
         memcpy(buffer.data(), &res, 4);
     }
-    static std::string serialize(const std::vector<uint8_t> &buffer) {
+    static std::string serialize(config_value_bytes_t buffer) {
         int value = decode(buffer);
         return std::to_string(value);
     }
@@ -150,7 +276,7 @@ template <>
 struct section_meta_value_t<
     config_section_value_type_enum::config_section_value_type_float> {
     typedef float type;
-    static type decode(const std::vector<uint8_t> &buffer) {
+    static type decode(config_value_bytes_t buffer) {
         assert(buffer.size() == 4);
         float res;
         memcpy(&res, buffer.data(), 4);
@@ -161,7 +287,7 @@ struct section_meta_value_t<
         float res = std::stof(value);
         memcpy(buffer.data(), &res, 4);
     }
-    static std::string serialize(const std::vector<uint8_t> &buffer) {
+    static std::string serialize(config_value_bytes_t buffer) {
         float value = decode(buffer);
         return std::to_string(value);
     }
@@ -170,18 +296,19 @@ struct section_meta_value_t<
 template <>
 struct section_meta_value_t<
     config_section_value_type_enum::config_section_value_type_range> {
-    typedef std::vector<int> type;
-    static type decode(const std::vector<uint8_t> &buffer) {
-        assert(buffer.size() != 0 && buffer.size() % 4 == 0);
-        int range_index_length = buffer.size() / 4;
-        std::vector<int> range_index;
-        range_index.resize(range_index_length);
-        for (int i = 0; i < range_index_length; i++) {
-            int res;
-            memcpy(&res, buffer.data()+ 4 * i, 4);
-            range_index[i] = res;
-        }
-        return range_index;
+    // start, end and step, the elements are never expanded
+    typedef config_value_range_t type;
+    static type decode(config_value_bytes_t buffer) {
+        assert(buffer.size() == 12);
+        int bounds[3];
+        memcpy(bounds, buffer.data(), 12);
+        return config_value_range_t(bounds[0], bounds[1], bounds[2]);
+    }
+    static void encode(std::vector<uint8_t> &buffer, int start, int end, int step) {
+        int bounds[3] = {start, end, step};
+        size_t offset = buffer.size();
+        buffer.resize(offset + 12);
+        memcpy(buffer.data() + offset, bounds, 12);
     }
     static void encode(std::vector<uint8_t> &buffer, std::string value) {
         int start, end, step;
@@ -202,27 +329,16 @@ struct section_meta_value_t<
         } else {
             assert(false);
         }
-
-        std::vector<int> range_index;
-        if (step >= 0)
-            for (int i = start; i < end; i += step)
-                range_index.push_back(i);
-        else
-            for (int i = start; i > end; i += step)
-                range_index.push_back(i);
-
-        buffer.resize(4 * range_index.size());
-        for (int i = 0; i < (int)range_index.size(); i++) {
-            int res = range_index[i];
-            memcpy(buffer.data() + 4 * i, &res, 4);
-        }
+        buffer.clear();
+        encode(buffer, start, end, step);
     }
-    static std::string serialize(const std::vector<uint8_t> &buffer) {
-        std::vector<int> value = decode(buffer);
+    // the expanded list, as when ranges were stored expanded
+    static std::string serialize(config_value_bytes_t buffer) {
+        config_value_range_t value = decode(buffer);
         std::string str = "[";
-        str += std::to_string(value[0]);
-        for (int i = 1; i < (int)value.size(); i++) {
-            str += std::string(",");
+        for (size_t i = 0; i < value.size(); i++) {
+            if (i != 0)
+                str += std::string(",");
             str += std::to_string(value[i]);
         }
         str += "]";
@@ -234,7 +350,7 @@ template <>
 struct section_meta_value_t<
     config_section_value_type_enum::config_section_value_type_list_int> {
     typedef std::vector<int> type;
-    static type decode(const std::vector<uint8_t> &buffer) {
+    static type decode(config_value_bytes_t buffer) {
         assert(buffer.size() != 0 && buffer.size() % 4 == 0);
         std::vector<int> list_value;
         list_value.resize(buffer.size() / 4);
@@ -254,7 +370,7 @@ struct section_meta_value_t<
             memcpy(buffer.data() + 4 * i, &res, 4);
         }
     }
-    static std::string serialize(const std::vector<uint8_t> &buffer) {
+    static std::string serialize(config_value_bytes_t buffer) {
         std::vector<int> value = decode(buffer);
         std::string str = "[";
         str += std::to_string(value[0]);
@@ -271,7 +387,7 @@ template <>
 struct section_meta_value_t<
     config_section_value_type_enum::config_section_value_type_list_float> {
     typedef std::vector<float> type;
-    static type decode(const std::vector<uint8_t> &buffer) {
+    static type decode(config_value_bytes_t buffer) {
         assert(buffer.size() != 0 && buffer.size() % 4 == 0);
         std::vector<float> list_value;
         list_value.resize(buffer.size() / 4);
@@ -291,7 +407,7 @@ struct section_meta_value_t<
             memcpy(buffer.data() + 4 * i, &res, 4);
         }
     }
-    static std::string serialize(const std::vector<uint8_t> &buffer) {
+    static std::string serialize(config_value_bytes_t buffer) {
         std::vector<float> value = decode(buffer);
         std::string str = "[";
         str += std::to_string(value[0]);
@@ -308,7 +424,7 @@ template <>
 struct section_meta_value_t<
     config_section_value_type_enum::config_section_value_type_list_string> {
     typedef std::vector<std::string> type;
-    static type decode(const std::vector<uint8_t> &buffer) {
+    static type decode(config_value_bytes_t buffer) {
         assert(buffer.size() != 0);
         std::vector<std::string> list_value;
         std::string v;
@@ -335,7 +451,7 @@ struct section_meta_value_t<
             buffer.push_back(static_cast<uint8_t>('\0'));
         }
     }
-    static std::string serialize(const std::vector<uint8_t> &buffer) {
+    static std::string serialize(config_value_bytes_t buffer) {
         std::vector<std::string> value = decode(buffer);
         std::string str = "[";
         str += (std::string("\'") + value[0] + std::string("\'"));
@@ -352,7 +468,7 @@ template <>
 struct section_meta_value_t<
     config_section_value_type_enum::config_section_value_type_string> {
     typedef std::string type;
-    static type decode(const std::vector<uint8_t> &buffer) {
+    static type decode(config_value_bytes_t buffer) {
         assert(buffer.size() != 0);
         std::string value_string;
         value_string.resize(buffer.size());
@@ -370,7 +486,7 @@ struct section_meta_value_t<
         }
         //buffer.back() = static_cast<uint8_t>('\0');
     }
-    static std::string serialize(const std::vector<uint8_t> &buffer) {
+    static std::string serialize(config_value_bytes_t buffer) {
         return std::string("\'") + decode(buffer) + std::string("\'");
     }
 };
@@ -379,7 +495,7 @@ struct section_meta_value_t<
     static typename section_meta_value_t<                                      \
         config_section_value_type_enum::                                       \
             config_section_value_type_##type_enum_trait>::type                 \
-        decode_##type_enum_trait(const std::vector<uint8_t> &buffer) {         \
+        decode_##type_enum_trait(config_value_bytes_t buffer) {         \
         return section_meta_value_t<                                           \
             config_section_value_type_enum::                                   \
                 config_section_value_type_##type_enum_trait>::decode(buffer);  \
@@ -391,7 +507,7 @@ struct section_meta_value_t<
         return section_meta_value_t<                                           \
             config_section_value_type_enum::                                   \
                 config_section_value_type_##type_enum_trait>::                 \
-            decode(value_buffer);                                              \
+            decode(self().get_bytes());                                        \
     }
 
 #define CENCODE(type_enum_trait)                                               \
@@ -403,35 +519,291 @@ struct section_meta_value_t<
                                                                      value);   \
     }
 
-class config_section_value_t {
+/*
+* accessors shared by every flavor of value (parsed, memory-mapped binary, ...),
+* 'value_t' only has to provide get_type() and get_bytes()
+*/
+template <typename value_t>
+class config_value_accessor_t {
   public:
-    config_section_value_t() {}
-    config_section_value_t(std::string value_,
-                           config_section_value_type_enum type_)
-        : value_string(value_), value_type(type_) {}
-    config_section_value_t(const config_section_value_t &other) {
-        this->value_string = other.value_string;
-        this->value_type = other.value_type;
-        this->value_buffer = other.value_buffer;
+    template <config_section_value_type_enum value_type>
+    static typename section_meta_value_t<value_type>::type
+    decode(config_value_bytes_t buffer) {
+        return section_meta_value_t<value_type>::decode(buffer);
     }
-    config_section_value_t(config_section_value_t &&other) {
-        this->value_string = other.value_string;
-        this->value_type = other.value_type;
-        this->value_buffer = other.value_buffer;
+
+    template <config_section_value_type_enum value_type>
+    typename section_meta_value_t<value_type>::type get_value() const {
+        return section_meta_value_t<value_type>::decode(self().get_bytes());
+    }
+
+    CDECODE(int)
+    CDECODE(float)
+    CDECODE(range)
+    CDECODE(list_int)
+    CDECODE(list_float)
+    CDECODE(list_string)
+    CDECODE(string)
+
+    // zero-allocation accessors, the returned views live as long as the value
+    config_value_span_t<int> get_list_int_view() const {
+        assert(self().get_type() == config_section_value_type_enum::config_section_value_type_list_int);
+        return config_value_span_t<int>(reinterpret_cast<const int *>(self().get_bytes().data()),
+                                        self().get_bytes().size() / 4);
+    }
+    config_value_span_t<float> get_list_float_view() const {
+        assert(self().get_type() == config_section_value_type_enum::config_section_value_type_list_float);
+        return config_value_span_t<float>(reinterpret_cast<const float *>(self().get_bytes().data()),
+                                          self().get_bytes().size() / 4);
+    }
+    std::string_view get_string_view() const {
+        assert(self().get_type() == config_section_value_type_enum::config_section_value_type_string);
+        return std::string_view(reinterpret_cast<const char *>(self().get_bytes().data()), self().get_bytes().size());
+    }
+
+    std::string serialize() const {
+        return serialize(self().get_type(), self().get_bytes());
+    }
+    static std::string serialize(config_section_value_type_enum value_type,
+                                 config_value_bytes_t bytes) {
+        if (value_type ==
+            config_section_value_type_enum::config_section_value_type_int)
+            return section_meta_value_t<
+                config_section_value_type_enum::config_section_value_type_int>::
+                serialize(bytes);
+        if (value_type ==
+            config_section_value_type_enum::config_section_value_type_float)
+            return section_meta_value_t<
+                config_section_value_type_enum::
+                    config_section_value_type_float>::serialize(bytes);
+        if (value_type ==
+            config_section_value_type_enum::config_section_value_type_range)
+            return section_meta_value_t<
+                config_section_value_type_enum::
+                    config_section_value_type_range>::serialize(bytes);
+        if (value_type ==
+            config_section_value_type_enum::config_section_value_type_list_int)
+            return section_meta_value_t<
+                config_section_value_type_enum::
+                    config_section_value_type_list_int>::
+                serialize(bytes);
+        if (value_type == config_section_value_type_enum::
+                              config_section_value_type_list_float)
+            return section_meta_value_t<
+                config_section_value_type_enum::
+                    config_section_value_type_list_float>::
+                serialize(bytes);
+        if (value_type == config_section_value_type_enum::
+                              config_section_value_type_list_string)
+            return section_meta_value_t<
+                config_section_value_type_enum::
+                    config_section_value_type_list_string>::
+                serialize(bytes);
+        if (value_type ==
+            config_section_value_type_enum::config_section_value_type_string)
+            return section_meta_value_t<
+                config_section_value_type_enum::
+                    config_section_value_type_string>::serialize(bytes);
+        assert(false);
+        return std::string("");
+    }
+
+  private:
+    const value_t &self() const { return static_cast<const value_t &>(*this); }
+};
+
+/*
+* a value keeps only its encoded bytes (see section_meta_value_t<>), inline when
+* they fit in 'inline_bytes', which covers int/float, int lists up to 8 entries
+* and the short strings used by tunables. Decoding a scalar is then a memcpy and
+* the *_view() accessors hand out spans into the storage without allocating.
+*/
+class config_section_value_t
+    : public config_value_accessor_t<config_section_value_t> {
+  public:
+    static constexpr size_t inline_bytes = 32;
+    // values stored in a section allocate from the section's arena, if any
+    typedef std::pmr::polymorphic_allocator<uint8_t> allocator_type;
+
+    config_section_value_t()
+        : value_type(config_section_value_type_enum::config_section_value_type_non),
+          value_length(0) {}
+    explicit config_section_value_t(const allocator_type &alloc)
+        : value_type(config_section_value_type_enum::config_section_value_type_non),
+          value_length(0), value_heap(alloc) {}
+    config_section_value_t(config_section_value_type_enum type_,
+                           config_value_bytes_t bytes,
+                           const allocator_type &alloc = allocator_type())
+        : value_type(type_), value_length(0), value_heap(alloc) {
+        set_bytes(bytes);
+    }
+    config_section_value_t(config_section_value_type_enum type_,
+                           std::vector<uint8_t> &&buffer)
+        : config_section_value_t(type_, config_value_bytes_t(buffer)) {}
+    config_section_value_t(const config_section_value_t &other)
+        : value_type(other.value_type), value_length(other.value_length),
+          value_heap(other.value_heap) {
+        copy_inline(other);
+    }
+    config_section_value_t(const config_section_value_t &other, const allocator_type &alloc)
+        : value_type(other.value_type), value_length(other.value_length),
+          value_heap(other.value_heap, alloc) {
+        copy_inline(other);
+    }
+    config_section_value_t(config_section_value_t &&other) noexcept
+        : value_type(other.value_type), value_length(other.value_length),
+          value_heap(std::move(other.value_heap)) {
+        copy_inline(other);
+    }
+    // a real move if 'alloc' is the one of 'other', a copy otherwise
+    config_section_value_t(config_section_value_t &&other, const allocator_type &alloc)
+        : value_type(other.value_type), value_length(other.value_length),
+          value_heap(std::move(other.value_heap), alloc) {
+        copy_inline(other);
     }
     config_section_value_t &operator=(const config_section_value_t &other) {
-        this->value_string = other.value_string;
         this->value_type = other.value_type;
-        this->value_buffer = other.value_buffer;
+        this->value_length = other.value_length;
+        this->value_heap = other.value_heap;
+        copy_inline(other);
         return *this;
     }
     config_section_value_t &operator=(config_section_value_t &&other) {
-        this->value_string = other.value_string;
         this->value_type = other.value_type;
-        this->value_buffer = other.value_buffer;
+        this->value_length = other.value_length;
+        this->value_heap = std::move(other.value_heap);
+        copy_inline(other);
         return *this;
     }
 
+    // std::stoi() without the exceptions: leading white space, an optional
+    // sign and at least one digit, anything after the digits is ignored
+    static bool lex_int(std::string_view v, int &value) {
+        size_t pos = v.find_first_not_of(" \t\r\n\v\f");
+        if (pos == std::string_view::npos)
+            return false;
+        if (v[pos] == '+' && pos + 1 < v.size() && v[pos + 1] != '-')
+            pos++;
+        const char *first = v.data() + pos;
+        auto res = std::from_chars(first, v.data() + v.size(), value);
+        return res.ec == std::errc() && res.ptr != first;
+    }
+    // std::stof() without the exceptions, i.e. strtof() on a null terminated copy
+    static bool lex_float(std::string_view v, float &value) {
+        char local[64];
+        std::string heap;
+        const char *str;
+        if (v.size() < sizeof(local)) {
+            memcpy(local, v.data(), v.size());
+            local[v.size()] = '\0';
+            str = local;
+        } else {
+            heap.assign(v.data(), v.size());
+            str = heap.c_str();
+        }
+        char *end;
+        int saved_errno = errno;
+        errno = 0;
+        value = strtof(str, &end);
+        bool ok = end != str && errno != ERANGE;
+        errno = saved_errno;
+        return ok;
+    }
+    // calls 'func' on every element of a comma separated list, like ssplit()
+    template <typename F>
+    static void lex_elements(std::string_view v, F func) {
+        size_t pos = 0;
+        while (pos < v.size()) {
+            size_t comma = v.find(',', pos);
+            if (comma == std::string_view::npos)
+                comma = v.size();
+            func(v.substr(pos, comma - pos));
+            pos = comma + 1;
+        }
+    }
+    template <typename T>
+    static void append_scalar(std::vector<uint8_t> &buffer, T value) {
+        size_t offset = buffer.size();
+        buffer.resize(offset + sizeof(T));
+        memcpy(buffer.data() + offset, &value, sizeof(T));
+    }
+    // inside of '(..)', false if this is not a range. Elements that are not
+    // integers throw like the std::stoi() in the range encoder always did.
+    static bool lex_range(std::string_view v, std::vector<uint8_t> &buffer) {
+        int bounds[3];
+        int num_bounds = 0;
+        bool valid = true;
+        bool numeric = true;
+        lex_elements(v, [&](std::string_view e) {
+            if (svtrim(e).empty())
+                valid = false;
+            else if (num_bounds < 3)
+                numeric &= lex_int(e, bounds[num_bounds]);
+            num_bounds++;
+        });
+        if (!valid || num_bounds < 1 || num_bounds > 3)
+            return false;
+        if (!numeric)
+            throw std::invalid_argument("stoi");
+        int start = num_bounds == 1 ? 0 : bounds[0];
+        int end = num_bounds == 1 ? bounds[0] : bounds[1];
+        int step = num_bounds == 3 ? bounds[2] : 1;
+        section_meta_value_t<config_section_value_type_enum::config_section_value_type_range>::encode(
+            buffer, start, end, step);
+        return true;
+    }
+    // inside of '[..]', returns the list type, or config_section_value_type_non.
+    // The int encoding is produced during the classifying scan, float and string
+    // lists, which are rare, take a second one.
+    static config_section_value_type_enum lex_list(std::string_view v, std::vector<uint8_t> &buffer) {
+        bool all_int = true, all_float = true, all_string = true;
+        bool valid = true;
+        lex_elements(v, [&](std::string_view e) {
+            std::string_view t = svtrim(e);
+            if (t.empty()) {
+                valid = false;
+                return;
+            }
+            int ival;
+            float fval;
+            if (all_int && lex_int(t, ival))
+                append_scalar(buffer, ival);
+            else
+                all_int = false;
+            if (!all_int && all_float)
+                all_float = lex_float(t, fval);
+            if (all_string)
+                all_string = (t.front() == '\'' && t.back() == '\'') ||
+                             (t.front() == '\"' && t.back() == '\"');
+        });
+        if (!valid)
+            return config_section_value_type_enum::config_section_value_type_non;
+        if (all_int)
+            return config_section_value_type_enum::config_section_value_type_list_int;
+        buffer.clear();
+        if (all_float) {
+            // the leading int elements were not checked as floats yet
+            lex_elements(v, [&](std::string_view e) {
+                float fval;
+                all_float &= lex_float(svtrim(e), fval);
+                append_scalar(buffer, fval);
+            });
+            if (all_float)
+                return config_section_value_type_enum::config_section_value_type_list_float;
+            buffer.clear();
+        }
+        if (all_string) {
+            lex_elements(v, [&](std::string_view e) {
+                std::string_view t = svtrim(e);
+                std::string_view str = svtrim(t.substr(1, t.length() - 1 - (t.length() > 1 ? 1 : 0)));
+                buffer.insert(buffer.end(), str.begin(), str.end());
+                buffer.push_back(static_cast<uint8_t>('\0'));
+            });
+            return config_section_value_type_enum::config_section_value_type_list_string;
+        }
+        return config_section_value_type_enum::config_section_value_type_non;
+    }
+
     static bool is_value_int(std::string v) {
         try {
             int i = std::stoi(v);
@@ -517,25 +889,6 @@ class config_section_value_t {
         return false;
     }
 
-    template <config_section_value_type_enum value_type>
-    static typename section_meta_value_t<value_type>::type
-    decode(const std::vector<char> &buffer) {
-        return section_meta_value_t<value_type>::decode(buffer);
-    }
-
-    template <config_section_value_type_enum value_type>
-    typename section_meta_value_t<value_type>::type get_value() const {
-        return section_meta_value_t<value_type>::decode(value_buffer);
-    }
-
-    CDECODE(int)
-    CDECODE(float)
-    CDECODE(range)
-    CDECODE(list_int)
-    CDECODE(list_float)
-    CDECODE(list_string)
-    CDECODE(string)
-
     template <config_section_value_type_enum value_type>
     static void encode(std::vector<char> &buffer, std::string value) {
         (void)buffer;
@@ -550,15 +903,69 @@ class config_section_value_t {
     CENCODE(list_string)
     CENCODE(string)
 
-    static config_section_value_t parse_value(std::string v) {
+    /*
+    * single pass classifier, decides the type and encodes the value in one scan
+    * without exceptions. The outcome is the same as parse_value_probing():
+    *   - int, then float, accept any numeric prefix like std::stoi()/std::stof(),
+    *     so "1.5" is the int 1 and "2x" the int 2
+    *   - (a,b,c) is a range of 1 to 3 elements
+    *   - [..] is a list of int, then float, then string, by its elements
+    *   - '..' or ".." is a string
+    * list and range elements are split like ssplit(), which drops an empty
+    * trailing element.
+    */
+    static config_section_value_t parse_value(std::string_view v) {
+        // encoding scratch, the value copies what it keeps
+        static thread_local std::vector<uint8_t> buffer;
+        buffer.clear();
+        int ival;
+        float fval;
+        if (lex_int(v, ival)) {
+            append_scalar(buffer, ival);
+            return config_section_value_t(
+                config_section_value_type_enum::config_section_value_type_int, buffer);
+        }
+        if (lex_float(v, fval)) {
+            append_scalar(buffer, fval);
+            return config_section_value_t(
+                config_section_value_type_enum::config_section_value_type_float, buffer);
+        }
+        if (v.empty()) {
+            assert(false);
+            return config_section_value_t();
+        }
+        std::string_view inner = v.substr(1, v.length() - 1 - (v.length() > 1 ? 1 : 0));
+        if (v.length() >= 2 && v.front() == '(' && v.back() == ')') {
+            if (lex_range(inner, buffer))
+                return config_section_value_t(
+                    config_section_value_type_enum::config_section_value_type_range, buffer);
+        }
+        if (v.length() >= 2 && v.front() == '[' && v.back() == ']') {
+            config_section_value_type_enum type = lex_list(inner, buffer);
+            if (type != config_section_value_type_enum::config_section_value_type_non)
+                return config_section_value_t(type, buffer);
+        }
+        if ((v.front() == '\'' && v.back() == '\'') || (v.front() == '\"' && v.back() == '\"')) {
+            std::string_view str = svtrim(inner);
+            buffer.assign(str.begin(), str.end());
+            return config_section_value_t(
+                config_section_value_type_enum::config_section_value_type_string, buffer);
+        }
+        assert(false);
+        return config_section_value_t();
+    }
+
+    // the original classifier, probing every type in turn with exceptions. It is
+    // the reference parse_value() has to match, see benchmark_configs classify
+    static config_section_value_t parse_value_probing(std::string v) {
 #define PARSE_VALUE(type_enum_trait)                                           \
     if (is_value_##type_enum_trait(v)) {                                       \
-        config_section_value_t meta_value(                                     \
-            v, config_section_value_type_enum::                                \
-                   config_section_value_type_##type_enum_trait);               \
-        config_section_value_t::encode_##type_enum_trait(                      \
-            meta_value.get_buffer(), v);                                       \
-        return meta_value;                                                     \
+        std::vector<uint8_t> buffer;                                           \
+        config_section_value_t::encode_##type_enum_trait(buffer, v);           \
+        return config_section_value_t(                                         \
+            config_section_value_type_enum::                                   \
+                config_section_value_type_##type_enum_trait,                   \
+            std::move(buffer));                                                \
     }
         PARSE_VALUE(int)
         PARSE_VALUE(float)
@@ -569,104 +976,387 @@ class config_section_value_t {
         PARSE_VALUE(string)
         assert(false);
 #undef PARSE_VALUE
-        return config_section_value_t(
-            "", config_section_value_type_enum::config_section_value_type_non);
+        return config_section_value_t();
     }
 
-    std::vector<uint8_t> &get_buffer() { return value_buffer; }
-    const std::vector<uint8_t> &get_buffer() const { return value_buffer; }
-    std::string serialize() const {
-        if (value_type ==
-            config_section_value_type_enum::config_section_value_type_int)
-            return section_meta_value_t<
-                config_section_value_type_enum::config_section_value_type_int>::
-                serialize(value_buffer);
-        if (value_type ==
-            config_section_value_type_enum::config_section_value_type_float)
-            return section_meta_value_t<
-                config_section_value_type_enum::
-                    config_section_value_type_float>::serialize(value_buffer);
-        if (value_type ==
-            config_section_value_type_enum::config_section_value_type_range)
-            return section_meta_value_t<
-                config_section_value_type_enum::
-                    config_section_value_type_range>::serialize(value_buffer);
-        if (value_type ==
-            config_section_value_type_enum::config_section_value_type_list_int)
-            return section_meta_value_t<
-                config_section_value_type_enum::
-                    config_section_value_type_list_int>::
-                serialize(value_buffer);
-        if (value_type == config_section_value_type_enum::
-                              config_section_value_type_list_float)
-            return section_meta_value_t<
-                config_section_value_type_enum::
-                    config_section_value_type_list_float>::
-                serialize(value_buffer);
-        if (value_type == config_section_value_type_enum::
-                              config_section_value_type_list_string)
-            return section_meta_value_t<
-                config_section_value_type_enum::
-                    config_section_value_type_list_string>::
-                serialize(value_buffer);
-        if (value_type ==
-            config_section_value_type_enum::config_section_value_type_string)
-            return section_meta_value_t<
-                config_section_value_type_enum::
-                    config_section_value_type_string>::serialize(value_buffer);
-        assert(false);
-        return std::string("");
+    config_section_value_type_enum get_type() const { return value_type; }
+    config_value_bytes_t get_bytes() const {
+        return config_value_bytes_t(value_length <= inline_bytes ? value_inline
+                                                                 : reinterpret_cast<const uint8_t *>(value_heap.data()),
+                                    value_length);
+    }
+    void set_bytes(config_value_bytes_t bytes) {
+        value_length = static_cast<uint32_t>(bytes.size());
+        if (value_length <= inline_bytes) {
+            if (value_length != 0)
+                memcpy(value_inline, bytes.data(), value_length);
+            value_heap.clear();
+        } else {
+            value_heap.resize((value_length + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+            memmove(value_heap.data(), bytes.data(), value_length);
+        }
     }
 
   private:
-    std::string value_string;
-    std::vector<uint8_t> value_buffer;
     config_section_value_type_enum value_type;
+    uint32_t value_length;                      // length of the encoded bytes
+    alignas(8) uint8_t value_inline[inline_bytes];
+    // only used beyond inline_bytes, in words so that the list views are aligned
+    // whatever the arena hands out for bytes
+    std::pmr::vector<uint64_t> value_heap;
+
+    void copy_inline(const config_section_value_t &other) {
+        if (value_length <= inline_bytes && value_length != 0)
+            memcpy(value_inline, other.value_inline, value_length);
+    }
+};
+
+/*
+* process wide table of section keys. Every distinct key string is stored once
+* and sections refer to it by a small dense integer id.
+*
+* a key is first looked up in a cache local to the calling thread, i.e. to the
+* parse chunk it works on, so the shared table and its lock are only hit for
+* keys the thread has not seen yet. Names live in fixed size chunks that are
+* never reallocated, name() reads them without any lock.
+*/
+class config_key_table_t {
+  public:
+    static constexpr uint32_t invalid_id = 0xffffffff;
+
+    static config_key_table_t &get() {
+        static config_key_table_t table;
+        return table;
+    }
+
+    ~config_key_table_t() {
+        for (auto &chunk : chunks)
+            delete[] chunk.load(std::memory_order_relaxed);
+    }
+
+    uint32_t intern(std::string_view key) {
+        uint32_t id = find(key);
+        if (id != invalid_id)
+            return id;
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        auto it = ids.find(key);
+        if (it != ids.end())
+            return remember(it->first, it->second);
+        id = num_names.load(std::memory_order_relaxed);
+        if (id / chunk_size >= max_chunks) {
+            printf("more than %u distinct keys\n", max_chunks * chunk_size);
+            exit(-1);
+        }
+        std::string *chunk = chunks[id / chunk_size].load(std::memory_order_relaxed);
+        if (!chunk) {
+            chunk = new std::string[chunk_size];
+            chunks[id / chunk_size].store(chunk, std::memory_order_release);
+        }
+        chunk[id % chunk_size] = key;
+        num_names.store(id + 1, std::memory_order_release);
+        std::string_view name(chunk[id % chunk_size]);
+        ids.emplace(name, id);
+        return remember(name, id);
+    }
+    uint32_t find(std::string_view key) const {
+        auto &cache = local_cache();
+        auto cached = cache.find(key);
+        if (cached != cache.end())
+            return cached->second;
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto it = ids.find(key);
+        if (it == ids.end())
+            return invalid_id;  // not cached, the key may be interned later
+        return remember(it->first, it->second);
+    }
+    const std::string &name(uint32_t id) const {
+        assert(id < num_names.load(std::memory_order_acquire));
+        return chunks[id / chunk_size].load(std::memory_order_acquire)[id % chunk_size];
+    }
+
+  private:
+    static constexpr uint32_t chunk_size = 1024;
+    static constexpr uint32_t max_chunks = 4096;
+
+    typedef std::unordered_map<std::string_view, uint32_t> cache_t;
+
+    // views into the chunks, valid as long as the table
+    static cache_t &local_cache() {
+        static thread_local cache_t cache;
+        return cache;
+    }
+    static uint32_t remember(std::string_view name, uint32_t id) {
+        local_cache().emplace(name, id);
+        return id;
+    }
+
+    mutable std::shared_mutex mutex;
+    std::unordered_map<std::string_view, uint32_t> ids; // views into the chunks, guarded by 'mutex'
+    std::atomic<std::string *> chunks[max_chunks] = {};
+    std::atomic<uint32_t> num_names{0};
+};
+
+class config_key_t {
+  public:
+    config_key_t() : id(config_key_table_t::invalid_id) {}
+    explicit config_key_t(std::string_view key)
+        : id(config_key_table_t::get().intern(key)) {}
+
+    // does not intern, an unknown key gives an id matching no section entry
+    static config_key_t find(std::string_view key) {
+        config_key_t k;
+        k.id = config_key_table_t::get().find(key);
+        return k;
+    }
+
+    uint32_t get_id() const { return id; }
+    const std::string &str() const { return config_key_table_t::get().name(id); }
+    const char *c_str() const { return str().c_str(); }
+    bool operator==(const config_key_t &other) const { return id == other.id; }
+    bool operator!=(const config_key_t &other) const { return id != other.id; }
+
+  private:
+    uint32_t id;
 };
 
+/*
+* monotonic arena a parse allocates its sections from. Sections keep a reference
+* to the arena they live in, so it is released with the last of them.
+*/
+typedef std::pmr::monotonic_buffer_resource config_arena_t;
+
+/*
+* entries are kept in a flat vector in insertion order, indexed by a small open
+* addressing table of entry positions keyed by the interned key id. Ids are
+* dense, so their low bits already make a good hash.
+*
+* a section either uses the default heap, or is a compact copy in an arena (see
+* the arena constructor). Moves keep the storage of the source, copies are made
+* on the default heap. A value moved out of an arena section still points into
+* the arena, copy it if it has to outlive the section.
+*/
 class config_section_t {
   public:
-    config_section_t(std::string name_) : name(name_) {}
-    std::string get_name() const { return name; }
-    std::unordered_map<std::string, config_section_value_t>::iterator begin() {
-        return dict.begin();
+    typedef std::pair<config_key_t, config_section_value_t> entry_t;
+    typedef std::pmr::vector<entry_t>::iterator iterator;
+    typedef std::pmr::vector<entry_t>::const_iterator const_iterator;
+
+    config_section_t(std::string_view name_) : name(name_) {}
+    // exact size copy of 'other', allocated from 'arena_'
+    config_section_t(const config_section_t &other, std::shared_ptr<config_arena_t> arena_)
+        : arena(std::move(arena_)), name(other.name, arena.get()), entries(arena.get()), slots(arena.get()) {
+        entries.reserve(other.entries.size());
+        for (const auto &entry : other.entries)
+            entries.emplace_back(entry.first, entry.second);
+        rebuild_slots(slots_for(entries.size()));
+    }
+    config_section_t(const config_section_t &other)
+        : name(other.name), entries(other.entries), slots(other.slots) {}
+    config_section_t(config_section_t &&other) noexcept = default;
+    // assignments keep the storage of the destination, they only move the
+    // buffers over when both sides share it
+    config_section_t &operator=(const config_section_t &other) {
+        name = other.name;
+        entries = other.entries;
+        slots = other.slots;
+        return *this;
+    }
+    config_section_t &operator=(config_section_t &&other) {
+        bool same_storage = entries.get_allocator() == other.entries.get_allocator();
+        name = std::move(other.name);
+        entries = std::move(other.entries);
+        slots = std::move(other.slots);
+        if (same_storage)
+            arena = std::move(other.arena);
+        return *this;
+    }
+
+    std::string_view get_name() const { return name; }
+    iterator begin() { return entries.begin(); }
+    iterator end() { return entries.end(); }
+    const_iterator begin() const { return entries.cbegin(); }
+    const_iterator end() const { return entries.cend(); }
+    size_t size() const { return entries.size(); }
+    // i-th entry in insertion order, like the other section flavors
+    config_key_t key(size_t i) const { return entries[i].first; }
+    const config_section_value_t &value(size_t i) const { return entries[i].second; }
+
+    config_section_value_t &at(config_key_t key) {
+        int pos = find(key);
+        if (pos < 0)
+            pos = insert(key);
+        return entries[pos].second;
+    }
+    const config_section_value_t &at(config_key_t key) const {
+        int pos = find(key);
+        if (pos < 0)
+            throw std::out_of_range("config_section_t::at");
+        return entries[pos].second;
+    }
+    size_t count(config_key_t key) const { return find(key) < 0 ? 0 : 1; }
+
+    // heterogeneous lookup, none of these allocate for a key already interned
+    config_section_value_t &at(std::string_view key) {
+        return at(config_key_t(key));
+    }
+    const config_section_value_t &at(std::string_view key) const {
+        return at(config_key_t::find(key));
     }
-    std::unordered_map<std::string, config_section_value_t>::iterator end() {
-        return dict.end();
+    size_t count(std::string_view key) const {
+        return count(config_key_t::find(key));
     }
-    std::unordered_map<std::string, config_section_value_t>::const_iterator
-    begin() const {
-        return dict.cbegin();
+
+    // drop the spare capacity once a section is complete
+    void shrink_to_fit() { entries.shrink_to_fit(); }
+    // empty the section but keep its buffers, for a section used as scratch
+    void clear(std::string_view name_) {
+        name.assign(name_.data(), name_.size());
+        entries.clear();
+        std::fill(slots.begin(), slots.end(), 0);
     }
-    std::unordered_map<std::string, config_section_value_t>::const_iterator
-    end() const {
-        return dict.cend();
+
+  private:
+    static constexpr uint32_t min_slots = 32;
+
+    // storage of the members below unless null, declared first to go last
+    std::shared_ptr<config_arena_t> arena;
+    std::pmr::string name;
+    std::pmr::vector<entry_t> entries;
+    std::pmr::vector<uint16_t> slots; // entry index + 1, 0 for an empty slot
+
+    static size_t slots_for(size_t num_entries) {
+        size_t num_slots = min_slots;
+        while (num_entries * 2 > num_slots)
+            num_slots *= 2;
+        return num_slots;
+    }
+    void rebuild_slots(size_t num_slots) {
+        slots.assign(num_slots, 0);
+        for (size_t i = 0; i < entries.size(); i++)
+            place(entries[i].first, static_cast<uint16_t>(i + 1));
     }
 
-    config_section_value_t &at(std::string key) { return this->dict[key]; }
-    const config_section_value_t &at(std::string key) const {
-        return this->dict.at(key);
+    int find(config_key_t key) const {
+        if (slots.empty())
+            return -1;
+        uint32_t mask = static_cast<uint32_t>(slots.size()) - 1;
+        for (uint32_t i = key.get_id() & mask;; i = (i + 1) & mask) {
+            uint16_t slot = slots[i];
+            if (slot == 0)
+                return -1;
+            if (entries[slot - 1].first == key)
+                return slot - 1;
+        }
     }
-    size_t count(std::string key) const { return this->dict.count(key); }
+    int insert(config_key_t key) {
+        assert(entries.size() < 0xffff);
+        entries.emplace_back(key, config_section_value_t());
+        // keep the load factor at or below 1/2
+        if (entries.size() * 2 > slots.size()) {
+            rebuild_slots(slots.empty() ? min_slots : slots.size() * 2);
+        } else {
+            place(key, static_cast<uint16_t>(entries.size()));
+        }
+        return static_cast<int>(entries.size()) - 1;
+    }
+    void place(config_key_t key, uint16_t slot) {
+        uint32_t mask = static_cast<uint32_t>(slots.size()) - 1;
+        uint32_t i = key.get_id() & mask;
+        while (slots[i] != 0)
+            i = (i + 1) & mask;
+        slots[i] = slot;
+    }
+};
+
+class config_content_t;
+
+/*
+* sections of a config_content_t sharing one name, in file order. Only holds
+* positions, it is invalidated by adding sections to the content.
+*/
+class config_section_range_t {
+  public:
+    class iterator {
+      public:
+        iterator(const std::vector<config_section_t> *sections_, const uint32_t *position_)
+            : sections(sections_), position(position_) {}
+        const config_section_t &operator*() const { return (*sections)[*position]; }
+        const config_section_t *operator->() const { return &(*sections)[*position]; }
+        iterator &operator++() { position++; return *this; }
+        bool operator==(const iterator &other) const { return position == other.position; }
+        bool operator!=(const iterator &other) const { return position != other.position; }
+
+      private:
+        const std::vector<config_section_t> *sections;
+        const uint32_t *position;
+    };
+
+    config_section_range_t() : sections(nullptr), first(nullptr), last(nullptr) {}
+    config_section_range_t(const std::vector<config_section_t> *sections_,
+                           const std::vector<uint32_t> &positions)
+        : sections(sections_), first(positions.data()),
+          last(positions.data() + positions.size()) {}
+
+    iterator begin() const { return iterator(sections, first); }
+    iterator end() const { return iterator(sections, last); }
+    size_t size() const { return last - first; }
+    bool empty() const { return first == last; }
+    const config_section_t &operator[](size_t i) const { return (*sections)[first[i]]; }
 
   private:
-    std::string name;
-    std::unordered_map<std::string, config_section_value_t> dict;
+    const std::vector<config_section_t> *sections;
+    const uint32_t *first;
+    const uint32_t *last;
 };
 
+/*
+* sections in file order, plus an index from section name to the positions of
+* all the sections of that name, kept up to date by add_section(). The index
+* keys are views of the names stored in 'names', whose elements never move.
+*/
 class config_content_t {
   public:
-    void add_section(config_section_t section) {
-        this->sections.push_back(section);
+    config_content_t() = default;
+    config_content_t(const config_content_t &other) : sections(other.sections) {
+        rebuild_index();
     }
-    config_section_t get_section(std::string sec_name) const {
-        // return first section with name 'sec_name'
-        for(auto &sec : sections){
-            if(sec.get_name() == sec_name)
-                return sec;
+    config_content_t(config_content_t &&other) = default;
+    config_content_t &operator=(const config_content_t &other) {
+        if (this != &other) {
+            sections = other.sections;
+            rebuild_index();
         }
-        return config_section_t("sec_na");
+        return *this;
+    }
+    config_content_t &operator=(config_content_t &&other) = default;
+
+    void add_section(const config_section_t &section) {
+        this->sections.push_back(section);
+        index_section(this->sections.size() - 1);
+    }
+    void add_section(config_section_t &&section) {
+        this->sections.push_back(std::move(section));
+        index_section(this->sections.size() - 1);
     }
+    // first section with name 'sec_name', or a section named "sec_na"
+    const config_section_t &get_section(std::string_view sec_name) const {
+        static const config_section_t not_available("sec_na");
+        const name_entry_t *entry = find_name(sec_name);
+        return entry ? sections[entry->positions.front()] : not_available;
+    }
+    // all sections with name 'sec_name', in file order
+    config_section_range_t get_sections(std::string_view sec_name) const {
+        const name_entry_t *entry = find_name(sec_name);
+        return entry ? config_section_range_t(&sections, entry->positions) : config_section_range_t();
+    }
+    size_t count(std::string_view sec_name) const {
+        const name_entry_t *entry = find_name(sec_name);
+        return entry ? entry->positions.size() : 0;
+    }
+    size_t size() const { return sections.size(); }
+    const config_section_t &operator[](size_t i) const { return sections[i]; }
+
+    // renaming sections through these breaks the name index
     std::vector<config_section_t>::iterator begin() { return sections.begin(); }
     std::vector<config_section_t>::iterator end() { return sections.end(); }
     std::vector<config_section_t>::const_iterator begin() const {
@@ -680,8 +1370,8 @@ class config_content_t {
         printf("total sections:%d\n", (int)sections.size());
         for (int i = 0; i < (int)sections.size(); i++) {
             const config_section_t &section = sections[i];
-            printf("[%s]\n", section.get_name().c_str());
-            for (const auto kv : section) {
+            printf("[%.*s]\n", (int)section.get_name().size(), section.get_name().data());
+            for (const auto &kv : section) {
                 printf("  %s = %s\n", kv.first.c_str(),
                        kv.second.serialize().c_str());
             }
@@ -689,7 +1379,339 @@ class config_content_t {
     }
 
   private:
+    struct name_entry_t {
+        std::string name;
+        std::vector<uint32_t> positions;
+    };
+
+    const name_entry_t *find_name(std::string_view sec_name) const {
+        auto it = name_index.find(sec_name);
+        return it == name_index.end() ? nullptr : &names[it->second];
+    }
+
+    void index_section(size_t position) {
+        std::string_view sec_name = sections[position].get_name();
+        // sections of one name usually come in runs
+        if (last_name >= names.size() || names[last_name].name != sec_name) {
+            auto it = name_index.find(sec_name);
+            if (it == name_index.end()) {
+                names.push_back(name_entry_t{std::string(sec_name), {}});
+                it = name_index.emplace(names.back().name, names.size() - 1).first;
+            }
+            last_name = it->second;
+        }
+        names[last_name].positions.push_back(static_cast<uint32_t>(position));
+    }
+
+    void rebuild_index() {
+        names.clear();
+        name_index.clear();
+        last_name = 0;
+        for (size_t i = 0; i < sections.size(); i++)
+            index_section(i);
+    }
+
     std::vector<config_section_t> sections;
+    std::deque<name_entry_t> names;
+    std::unordered_map<std::string_view, size_t> name_index;
+    size_t last_name = 0;
+};
+
+/*
+* read-only mapping of a whole file. all the views handed out by the
+* mmap parse path point into this mapping, so it must outlive them
+*/
+class config_mapped_file_t {
+  public:
+    // with 'must_exist' unset a file that can not be mapped is not fatal, the
+    // object is simply left closed, see is_open()
+    config_mapped_file_t(std::string file_name, bool must_exist = true)
+        : addr(NULL), length(0), opened(false) {
+        int fd = open(file_name.c_str(), O_RDONLY);
+        if (fd < 0) {
+            if (!must_exist)
+                return;
+            printf("fail to open file:%s, %s\n", file_name.c_str(),
+                   strerror(errno));
+            exit(-1);
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            if (!must_exist)
+                return;
+            printf("fail to stat file:%s, %s\n", file_name.c_str(),
+                   strerror(errno));
+            exit(-1);
+        }
+        length = static_cast<size_t>(st.st_size);
+        if (length != 0) {
+            addr = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr == MAP_FAILED) {
+                addr = NULL;
+                length = 0;
+                close(fd);
+                if (!must_exist)
+                    return;
+                printf("fail to mmap file:%s, %s\n", file_name.c_str(),
+                       strerror(errno));
+                exit(-1);
+            }
+            madvise(addr, length, MADV_SEQUENTIAL);
+        }
+        close(fd);
+        opened = true;
+    }
+    ~config_mapped_file_t() {
+        if (addr)
+            munmap(addr, length);
+    }
+    config_mapped_file_t(const config_mapped_file_t &) = delete;
+    config_mapped_file_t &operator=(const config_mapped_file_t &) = delete;
+
+    bool is_open() const { return opened; }
+    const char *data() const { return static_cast<const char *>(addr); }
+    size_t size() const { return length; }
+    std::string_view view() const { return std::string_view(data(), length); }
+
+  private:
+    void *addr;
+    size_t length;
+    bool opened;
+};
+
+typedef std::function<void(config_section_t &&)> config_section_callback_t;
+
+// where a section sits in the text, see config_parser_t::split_sections()
+struct config_section_span_t {
+    size_t offset;      // of the '[name]' line
+    size_t length;      // up to the next section line, or the end of the text
+    uint64_t hash;      // of the normalized lines
+};
+
+enum class config_line_kind_enum {
+    config_line_kind_blank = 0,     // nothing left once comment and white space are gone
+    config_line_kind_section = 1,   // '[name]'
+    config_line_kind_key_value = 2, // 'key = value'
+    config_line_kind_bad = 3,       // no '=', or more than one
+};
+
+// one line as the lexer sees it
+struct config_line_t {
+    config_line_kind_enum kind;
+    size_t offset;              // of the raw line in the buffer
+    std::string_view text;      // the line without comment and surrounding white space
+    std::string_view key;       // trimmed key, or the trimmed section name
+    std::string_view value;     // trimmed value
+};
+
+/*
+* reference lexer of a single line (no '\n' in 'raw'), with the grammar of
+* config_parser_t: the comment starts at the first ';' or '#', a trailing '='
+* is dropped the way the std::getline() based ssplit() drops an empty trailing
+* token, and a key/value line needs exactly one '=' after that.
+*/
+static inline config_line_t config_lex_line(std::string_view raw, size_t offset)
+{
+    config_line_t line;
+    line.offset = offset;
+    line.text = svtrim(sv_remove_trailing_comment(raw));
+    if (line.text.empty()) {
+        line.kind = config_line_kind_enum::config_line_kind_blank;
+        return line;
+    }
+    if (line.text.front() == '[' && line.text.back() == ']') {
+        line.kind = config_line_kind_enum::config_line_kind_section;
+        line.key = svtrim(line.text.substr(1, line.text.length() - 2));
+        return line;
+    }
+    std::string_view kv = line.text;
+    if (kv.back() == '=')
+        kv.remove_suffix(1);
+    size_t eq = kv.find('=');
+    if (eq == std::string_view::npos || kv.find('=', eq + 1) != std::string_view::npos) {
+        line.kind = config_line_kind_enum::config_line_kind_bad;
+        return line;
+    }
+    line.kind = config_line_kind_enum::config_line_kind_key_value;
+    line.key = svtrim(kv.substr(0, eq));
+    line.value = svtrim(kv.substr(eq + 1));
+    return line;
+}
+
+/*
+* block scanner producing the same lines as config_lex_line(). The input is
+* classified 64 bytes at a time into a bit mask of the bytes that matter, '\n',
+* '=', ';' and '#', with AVX2 or SSE2 compares when the build targets them.
+* Lines are then cut by walking the set bits, so only the few bytes around a
+* key, a value or a section name are ever looked at one by one.
+*/
+class config_line_scanner_t {
+  public:
+    config_line_scanner_t(std::string_view buffer_, bool vectorized_ = true)
+        : buffer(buffer_), vectorized(vectorized_), pos(0), block(0), mask(0) {
+        if (!buffer.empty())
+            mask = classify(0);
+    }
+
+    // the next line, false once the buffer is consumed
+    bool next(config_line_t &line) {
+        if (pos >= buffer.size())
+            return false;
+        size_t begin = pos;
+        size_t content_end = std::string_view::npos;
+        size_t first_eq = std::string_view::npos;
+        size_t num_eq = 0;
+        size_t eol;
+        for (;;) {
+            size_t q = next_special();
+            if (q >= buffer.size()) {
+                eol = buffer.size();
+                break;
+            }
+            char c = buffer[q];
+            if (c == '\n') {
+                eol = q;
+                break;
+            }
+            if (content_end != std::string_view::npos)
+                continue;
+            if (c == '=') {
+                if (num_eq++ == 0)
+                    first_eq = q;
+            } else {
+                content_end = q;    // ';' or '#'
+            }
+        }
+        pos = eol + 1;
+        if (content_end == std::string_view::npos)
+            content_end = eol;
+
+        line.offset = begin;
+        size_t first = begin, last = content_end;
+        while (first < last && is_blank(buffer[first]))
+            first++;
+        while (last > first && is_blank(buffer[last - 1]))
+            last--;
+        line.text = buffer.substr(first, last - first);
+        line.key = std::string_view();
+        line.value = std::string_view();
+        if (first == last) {
+            line.kind = config_line_kind_enum::config_line_kind_blank;
+            return true;
+        }
+        if (buffer[first] == '[' && buffer[last - 1] == ']') {
+            line.kind = config_line_kind_enum::config_line_kind_section;
+            line.key = trim(first + 1, last - 1);
+            return true;
+        }
+        if (buffer[last - 1] == '=') {
+            // dropped trailing '=', the only one if it is also the first
+            last--;
+            num_eq--;
+            if (num_eq == 0)
+                first_eq = std::string_view::npos;
+        }
+        if (num_eq != 1) {
+            line.kind = config_line_kind_enum::config_line_kind_bad;
+            return true;
+        }
+        line.kind = config_line_kind_enum::config_line_kind_key_value;
+        line.key = trim(first, first_eq);
+        line.value = trim(first_eq + 1, last);
+        return true;
+    }
+
+    // where the next line starts
+    size_t get_position() const { return pos; }
+
+  private:
+    std::string_view buffer;
+    bool vectorized;
+    size_t pos;         // start of the next line
+    size_t block;       // offset of the 64 byte block 'mask' belongs to
+    uint64_t mask;      // special bytes of the block not consumed yet
+
+    static bool is_blank(char c) { return c == ' ' || (c >= '\t' && c <= '\r'); }
+
+    std::string_view trim(size_t first, size_t last) const {
+        while (first < last && is_blank(buffer[first]))
+            first++;
+        while (last > first && is_blank(buffer[last - 1]))
+            last--;
+        return buffer.substr(first, last - first);
+    }
+
+    // offset of the next special byte, they are consumed strictly in order,
+    // or the buffer size once there is none left
+    size_t next_special() {
+        for (;;) {
+            if (mask != 0) {
+                size_t q = block + __builtin_ctzll(mask);
+                mask &= mask - 1;
+                return q;
+            }
+            block += 64;
+            if (block >= buffer.size())
+                return buffer.size();
+            mask = classify(block);
+        }
+    }
+
+    uint64_t classify(size_t offset) const {
+        const char *p = buffer.data() + offset;
+        alignas(32) char tail[64];
+        if (buffer.size() - offset < 64) {
+            memset(tail, 0, sizeof(tail));
+            memcpy(tail, p, buffer.size() - offset);
+            p = tail;
+        }
+        return vectorized ? classify_vector(p) : classify_scalar(p);
+    }
+
+    static uint64_t classify_scalar(const char *p) {
+        uint64_t m = 0;
+        for (int i = 0; i < 64; i++) {
+            char c = p[i];
+            if (c == '\n' || c == '=' || c == ';' || c == '#')
+                m |= uint64_t(1) << i;
+        }
+        return m;
+    }
+
+    static uint64_t classify_vector(const char *p) {
+#if defined(__AVX2__)
+        const __m256i nl = _mm256_set1_epi8('\n'), eq = _mm256_set1_epi8('=');
+        const __m256i sc = _mm256_set1_epi8(';'), hs = _mm256_set1_epi8('#');
+        uint64_t m = 0;
+        for (int i = 0; i < 2; i++) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 32 * i));
+            __m256i hit = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, nl), _mm256_cmpeq_epi8(v, eq)),
+                                          _mm256_or_si256(_mm256_cmpeq_epi8(v, sc), _mm256_cmpeq_epi8(v, hs)));
+            m |= uint64_t(static_cast<uint32_t>(_mm256_movemask_epi8(hit))) << (32 * i);
+        }
+        return m;
+#elif defined(__SSE2__)
+        const __m128i nl = _mm_set1_epi8('\n'), eq = _mm_set1_epi8('=');
+        const __m128i sc = _mm_set1_epi8(';'), hs = _mm_set1_epi8('#');
+        uint64_t m = 0;
+        for (int i = 0; i < 4; i++) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16 * i));
+            __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, nl), _mm_cmpeq_epi8(v, eq)),
+                                       _mm_or_si128(_mm_cmpeq_epi8(v, sc), _mm_cmpeq_epi8(v, hs)));
+            m |= uint64_t(static_cast<uint32_t>(_mm_movemask_epi8(hit))) << (16 * i);
+        }
+        return m;
+#else
+        return classify_scalar(p);
+#endif
+    }
+};
+
+enum class config_parse_mode_enum {
+    config_parse_mode_stream = 0,   // std::ifstream + std::getline, one std::string per token
+    config_parse_mode_mmap = 1,     // mmap the file and tokenize with string_view slices
+    config_parse_mode_parallel = 2, // mmap path, chunks split at section starts parsed on all cores
 };
 
 /*
@@ -698,12 +1720,293 @@ class config_content_t {
 */
 class config_parser_t {
   public:
-    config_parser_t(std::string config_file_) : config_file(config_file_) {}
+    config_parser_t(std::string config_file_,
+                    config_parse_mode_enum mode_ =
+                        config_parse_mode_enum::config_parse_mode_mmap,
+                    int num_threads_ = 0)
+        : config_file(config_file_), mode(mode_), num_threads(num_threads_) {
+        if (num_threads <= 0)
+            num_threads = std::max(1, (int)std::thread::hardware_concurrency());
+    }
 
+    // gzip files are recognized whatever the mode, and parsed by parse_gzip()
     config_content_t parse() {
-        std::ifstream fs;
+        if (config_gzip_is_compressed(config_file))
+            return parse_gzip();
+        if (mode == config_parse_mode_enum::config_parse_mode_stream)
+            return parse_stream();
+        if (mode == config_parse_mode_enum::config_parse_mode_parallel)
+            return parse_parallel();
+        return parse_mmap();
+    }
+
+    config_content_t parse_parallel() {
+        config_content_t config_content;
+        config_mapped_file_t mapped_file(config_file);
+        parse_buffer_parallel(mapped_file.view(), [&](config_section_t &&section) {
+            config_content.add_section(std::move(section));
+        });
+        return config_content;
+    }
+
+    config_content_t parse_mmap() {
+        config_mapped_file_t mapped_file(config_file);
+        return parse_buffer(mapped_file.view());
+    }
+
+    config_content_t parse_buffer(std::string_view buffer) {
+        config_content_t config_content;
+        parse_buffer(buffer, [&](config_section_t &&section) {
+            config_content.add_section(std::move(section));
+        });
+        return config_content;
+    }
+
+    // SAX style interface, 'on_section' gets every section as soon as its
+    // last key is read, and the parser drops it once the callback returns.
+    // Unless the callback keeps sections, only the arena of the text being
+    // parsed (the section being read, in stream mode) is kept in memory.
+    void parse_sections(const config_section_callback_t &on_section) {
+        if (config_gzip_is_compressed(config_file)) {
+            parse_gzip(on_section);
+            return;
+        }
+        if (mode == config_parse_mode_enum::config_parse_mode_stream) {
+            parse_stream(on_section);
+            return;
+        }
+        config_mapped_file_t mapped_file(config_file);
+        if (mode == config_parse_mode_enum::config_parse_mode_parallel)
+            parse_buffer_parallel(mapped_file.view(), on_section);
+        else
+            parse_buffer(mapped_file.view(), on_section);
+    }
+
+    config_content_t parse_gzip() {
         config_content_t config_content;
-        config_section_t *section = NULL;
+        parse_gzip([&](config_section_t &&section) {
+            config_content.add_section(std::move(section));
+        });
+        return config_content;
+    }
+
+    // the file is inflated 'gzip_block_bytes' at a time, and the text up to the
+    // last section start inflated so far goes through parse_buffer(). Only the
+    // unfinished section is carried over to the next block, so the whole text
+    // is never held in memory nor written to disk.
+    void parse_gzip(const config_section_callback_t &on_section) {
+        config_gzip_reader_t reader(config_file);
+        std::string text;
+        for (;;) {
+            size_t carried = text.size();
+            text.resize(carried + gzip_block_bytes);
+            size_t length = reader.read(&text[carried], gzip_block_bytes);
+            text.resize(carried + length);
+            if (length == 0)
+                break;
+            size_t cut = last_section_start(text);
+            if (cut == 0)
+                continue;
+            parse_buffer(std::string_view(text.data(), cut), on_section);
+            text.erase(0, cut);
+        }
+        parse_buffer(text, on_section);
+    }
+
+    // 'buffer' is cut into chunks that each start at a section line, the chunks
+    // are parsed by a pool of 'num_threads' workers and the sections are handed
+    // to 'on_section' in file order, from the calling thread. Workers stay at
+    // most a few chunks ahead of the delivery, so memory remains bounded.
+    void parse_buffer_parallel(std::string_view buffer,
+                               const config_section_callback_t &on_section) {
+        std::vector<std::string_view> chunks = split_chunks(buffer);
+        if (num_threads <= 1 || chunks.size() <= 1) {
+            parse_buffer(buffer, on_section);
+            return;
+        }
+        parse_chunks_parallel(chunks, on_section);
+    }
+
+    // same as above on chunks cut by the caller, each has to start at a section
+    // line (or hold no key at all). The sections of all chunks are delivered
+    // in the order of 'chunks'.
+    void parse_chunks_parallel(const std::vector<std::string_view> &chunks,
+                               const config_section_callback_t &on_section) {
+        if (num_threads <= 1 || chunks.size() <= 1) {
+            for (const auto &chunk : chunks)
+                parse_buffer(chunk, on_section);
+            return;
+        }
+
+        std::vector<std::vector<config_section_t>> results(chunks.size());
+        std::vector<bool> done(chunks.size(), false);
+        size_t next_chunk = 0;
+        size_t next_delivery = 0;
+        size_t window = 2 * num_threads;
+        std::mutex mutex;
+        std::condition_variable cv;
+
+        auto worker = [&]() {
+            for (;;) {
+                size_t i;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    cv.wait(lock, [&]() {
+                        return next_chunk >= chunks.size() ||
+                               next_chunk < next_delivery + window;
+                    });
+                    if (next_chunk >= chunks.size())
+                        return;
+                    i = next_chunk++;
+                }
+                std::vector<config_section_t> sections;
+                parse_buffer(chunks[i], [&](config_section_t &&section) {
+                    sections.push_back(std::move(section));
+                });
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    results[i] = std::move(sections);
+                    done[i] = true;
+                }
+                cv.notify_all();
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (int t = 0; t < std::min(num_threads, (int)chunks.size()); t++)
+            workers.emplace_back(worker);
+
+        for (size_t i = 0; i < chunks.size(); i++) {
+            std::vector<config_section_t> sections;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&]() { return done[i]; });
+                sections = std::move(results[i]);
+                next_delivery = i + 1;
+            }
+            cv.notify_all();
+            for (auto &section : sections)
+                on_section(std::move(section));
+        }
+        for (auto &w : workers)
+            w.join();
+    }
+
+    // same grammar as parse_stream(), but lines come from config_line_scanner_t
+    // as views into 'buffer'. Keys are interned and values decoded straight
+    // from the views.
+    //
+    // a section is filled in a scratch section reused all along, then handed out
+    // as an exact size copy in an arena. A new arena is started every
+    // 'arena_text_bytes' of text, which keeps the heap traffic to a few
+    // allocations per MB and still lets a streaming caller release memory.
+    void parse_buffer(std::string_view buffer,
+                      const config_section_callback_t &on_section) {
+        config_section_t section("");
+        bool has_section = false;
+        std::shared_ptr<config_arena_t> arena;
+        const char *arena_begin = NULL;
+        const char *p = buffer.data();
+        const char *end = p + buffer.size();
+        auto deliver = [&]() {
+            if (!arena || static_cast<size_t>(p - arena_begin) >= arena_text_bytes) {
+                size_t text_bytes = std::min(arena_text_bytes, static_cast<size_t>(end - p));
+                arena = std::make_shared<config_arena_t>(arena_bytes_per_text_byte * text_bytes + 4096);
+                arena_begin = p;
+            }
+            on_section(config_section_t(section, arena));
+        };
+        config_line_scanner_t scanner(buffer);
+        config_line_t line;
+        while (scanner.next(line)) {
+            p = buffer.data() + std::min(scanner.get_position(), buffer.size());
+            if (line.kind == config_line_kind_enum::config_line_kind_blank)
+                continue;
+            if (line.kind == config_line_kind_enum::config_line_kind_section) {
+                if (has_section)
+                    deliver();
+                section.clear(line.key);
+                has_section = true;
+                continue;
+            }
+            if (!has_section) {
+                printf("no current section, should not happen\n");
+                exit(-1);
+            }
+            if (line.kind == config_line_kind_enum::config_line_kind_bad) {
+                printf("fail to parse current line:%.*s, not enough tokens\n",
+                       (int)line.text.length(), line.text.data());
+                exit(-1);
+            }
+            std::string_view toks[2] = {line.key, line.value};
+            for (int i = 0; i < 2; i++) {
+                if (toks[i].empty()) {
+                    printf("fail to parse current line:%.*s, token empty\n",
+                           (int)line.text.length(), line.text.data());
+                }
+            }
+            config_key_t key(toks[0]);
+            if (section.count(key)) {
+                printf("duplicate key %s in current section\n", key.c_str());
+                exit(-1);
+            }
+            section.at(key) =
+                config_section_value_t::parse_value(toks[1]);
+        }
+        if (has_section)
+            deliver();
+    }
+
+    /*
+    * cut 'buffer' into its sections, each running from its '[name]' line up to
+    * the next one. Lines before the first section are not part of any. The hash
+    * covers the normalized lines of a section: comments, blank lines and the
+    * padding around names, keys and values do not change it.
+    */
+    static std::vector<config_section_span_t> split_sections(std::string_view buffer) {
+        std::vector<config_section_span_t> spans;
+        uint64_t hash = 0;
+        config_line_scanner_t scanner(buffer);
+        config_line_t line;
+        while (scanner.next(line)) {
+            switch (line.kind) {
+            case config_line_kind_enum::config_line_kind_blank:
+                break;
+            case config_line_kind_enum::config_line_kind_section:
+                if (!spans.empty())
+                    spans.back().hash = hash;
+                spans.push_back({line.offset, 0, 0});
+                hash = utility_hash64(line.key.data(), line.key.size(), '[');
+                break;
+            case config_line_kind_enum::config_line_kind_key_value:
+                hash = utility_hash64(line.key.data(), line.key.size(), hash);
+                hash = utility_hash64(line.value.data(), line.value.size(), hash ^ '=');
+                break;
+            default:
+                hash = utility_hash64(line.text.data(), line.text.size(), hash);
+                break;
+            }
+            if (!spans.empty())
+                spans.back().length = std::min(scanner.get_position(), buffer.size()) - spans.back().offset;
+        }
+        if (!spans.empty())
+            spans.back().hash = hash;
+        return spans;
+    }
+
+    config_content_t parse_stream() {
+        config_content_t config_content;
+        parse_stream([&](config_section_t &&section) {
+            config_content.add_section(std::move(section));
+        });
+        return config_content;
+    }
+
+    // each section is handed to 'on_section' when the next one starts, so
+    // only the section being read is held
+    void parse_stream(const config_section_callback_t &on_section) {
+        std::ifstream fs;
+        std::unique_ptr<config_section_t> section;
         fs.open(config_file);
         if (!fs) {
             printf("fail to open file:%s, %s\n", config_file.c_str(),
@@ -717,11 +2020,9 @@ class config_parser_t {
             if (is_empty(line) || is_comment(line))
                 continue;
             if (is_section(line)) {
-                if (section) {
-                    config_content.add_section(*section);
-                    delete section;
-                }
-                section = new config_section_t(get_section_name(line));
+                if (section)
+                    on_section(std::move(*section));
+                section.reset(new config_section_t(get_section_name(line)));
             } else {
                 if (!section) {
                     printf("no current section, should not happen\n");
@@ -752,15 +2053,65 @@ class config_parser_t {
                 section->at(key) = config_section_value_t::parse_value(value);
             }
         }
-        if (section) {
-            config_content.add_section(*section);
-            delete section;
-        }
-        return config_content;
+        if (section)
+            on_section(std::move(*section));
     }
 
   private:
+    static constexpr size_t min_chunk_bytes = 256 * 1024;
+    static constexpr size_t max_chunk_bytes = 8 * 1024 * 1024;
+    // text parsed into one arena, and the arena size guessed per byte of text
+    static constexpr size_t arena_text_bytes = 1024 * 1024;
+    static constexpr size_t arena_bytes_per_text_byte = 3;
+    static constexpr size_t gzip_block_bytes = 1024 * 1024;
+
     std::string config_file;
+    config_parse_mode_enum mode;
+    int num_threads;
+
+    // start of the last complete line of 'buffer' that is a section header, 0 if none
+    static size_t last_section_start(std::string_view buffer) {
+        size_t eol = buffer.rfind('\n');
+        while (eol != std::string_view::npos && eol != 0) {
+            size_t pos = buffer.rfind('\n', eol - 1);
+            pos = pos == std::string_view::npos ? 0 : pos + 1;
+            std::string_view line = svtrim(sv_remove_trailing_comment(buffer.substr(pos, eol - pos)));
+            if (!line.empty() && line.front() == '[' && line.back() == ']')
+                return pos;
+            eol = pos == 0 ? std::string_view::npos : pos - 1;
+        }
+        return 0;
+    }
+
+    // a chunk boundary is the start of a line that parse_buffer() would take as
+    // a section header, so every chunk but the first starts a new section
+    std::vector<std::string_view> split_chunks(std::string_view buffer) const {
+        std::vector<std::string_view> chunks;
+        size_t chunk_bytes = buffer.size() / (4 * num_threads);
+        chunk_bytes = std::max(min_chunk_bytes, std::min(max_chunk_bytes, chunk_bytes));
+        size_t begin = 0;
+        while (begin < buffer.size()) {
+            size_t pos = std::min(begin + chunk_bytes, buffer.size());
+            while (pos < buffer.size()) {
+                size_t eol = buffer.find('\n', pos);
+                if (eol == std::string_view::npos) {
+                    pos = buffer.size();
+                    break;
+                }
+                pos = eol + 1;
+                size_t next_eol = buffer.find('\n', pos);
+                if (next_eol == std::string_view::npos)
+                    next_eol = buffer.size();
+                std::string_view line = svtrim(sv_remove_trailing_comment(
+                    buffer.substr(pos, next_eol - pos)));
+                if (!line.empty() && line.front() == '[' && line.back() == ']')
+                    break;
+            }
+            chunks.push_back(buffer.substr(begin, pos - begin));
+            begin = pos;
+        }
+        return chunks;
+    }
 
     bool is_empty(std::string line) { return line.empty(); }
     bool is_comment(std::string line) {
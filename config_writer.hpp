@@ -0,0 +1,255 @@
+/*******************************************************************************
+ *
+ * MIT License
+ *
+ * Copyright (c) 2020 Advanced Micro Devices, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef __CONFIG_WRITER_HPP__
+#define __CONFIG_WRITER_HPP__
+
+#include <algorithm>
+#include <assert.h>
+#include <charconv>
+#include <ostream>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "config_parser.hpp"
+
+/*
+* writes sections back in one canonical ini form, which config_parser_t reads
+* back to the same values, and which writes back byte for byte the same:
+*
+*   [name]
+*   key = value
+*   <blank line>
+*
+* keys come in the order given by set_key_order() for the section name, the
+* ones it does not list (and all keys of other sections) in section order.
+* Numbers go through std::to_chars(), ranges stay (start, end, step). A float
+* is written as ".ddde<exp>", which the value classifier can not take for an
+* int. Strings are not escaped: config_parser_t cuts a line at '#' or ';' and
+* splits it at '=', and a list of strings at ','. A section holding a string
+* with '#', ';', '=' or a line break, or a list element with ',', is not
+* written, write_section() returns false and get_error() tells which.
+*
+* the text is gathered in one large buffer, handed to the stream whenever it
+* fills up and by flush(), the destructor flushing whatever is left.
+*/
+class config_text_writer_t {
+  public:
+    config_text_writer_t(std::ostream &os_, size_t buffer_bytes_ = 1024 * 1024)
+        : os(&os_), buffer_bytes(buffer_bytes_) {
+        buffer.reserve(buffer_bytes + 4096);
+    }
+    ~config_text_writer_t() { flush(); }
+    config_text_writer_t(const config_text_writer_t &) = delete;
+    config_text_writer_t &operator=(const config_text_writer_t &) = delete;
+
+    void set_key_order(std::string_view section_name, const std::vector<config_key_t> &keys) {
+        std::vector<uint32_t> &ranks = key_ranks[std::string(section_name)];
+        ranks.clear();
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (keys[i].get_id() >= ranks.size())
+                ranks.resize(keys[i].get_id() + 1, unranked);
+            ranks[keys[i].get_id()] = static_cast<uint32_t>(i);
+        }
+    }
+
+    // 'content_t' is config_content_t, config_binary_reader_t or config_lazy_content_t.
+    // False if a section could not be written, the others are.
+    template <typename content_t>
+    bool write(const content_t &content) {
+        bool ok = true;
+        for (const auto &section : content)
+            ok &= write_section(section);
+        return ok;
+    }
+
+    template <typename section_t>
+    bool write_section(const section_t &section) {
+        for (size_t i = 0; i < section.size(); i++) {
+            const auto &value = section.value(i);
+            if (!writable(value.get_type(), value.get_bytes())) {
+                error = "section [" + std::string(section.get_name()) + "] key " + section.key(i).str() +
+                        ": a string holding what config_parser_t would not read back";
+                return false;
+            }
+        }
+        buffer += '[';
+        buffer += section.get_name();
+        buffer += "]\n";
+        order.resize(section.size());
+        for (size_t i = 0; i < order.size(); i++)
+            order[i] = static_cast<uint32_t>(i);
+        auto ranks = key_ranks.find(std::string(section.get_name()));
+        if (ranks != key_ranks.end()) {
+            auto rank = [&](uint32_t i) {
+                uint32_t id = section.key(i).get_id();
+                return id < ranks->second.size() ? ranks->second[id] : unranked;
+            };
+            // stable, without the scratch buffer of std::stable_sort()
+            std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+                uint32_t rank_a = rank(a), rank_b = rank(b);
+                return rank_a < rank_b || (rank_a == rank_b && a < b);
+            });
+        }
+        for (uint32_t i : order) {
+            buffer += section.key(i).str();
+            buffer += " = ";
+            const auto &value = section.value(i);
+            append_value(value.get_type(), value.get_bytes());
+            buffer += '\n';
+        }
+        buffer += '\n';
+        if (buffer.size() >= buffer_bytes)
+            flush();
+        return true;
+    }
+
+    // why the last section refused was
+    const std::string &get_error() const { return error; }
+
+    void flush() {
+        if (!buffer.empty())
+            os->write(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+
+  private:
+    static constexpr uint32_t unranked = 0xffffffff;
+
+    std::ostream *os;
+    size_t buffer_bytes;
+    std::string buffer;
+    std::unordered_map<std::string, std::vector<uint32_t>> key_ranks;  // by key id, for each section name
+    std::vector<uint32_t> order;
+    std::string error;
+
+    static bool writable(config_section_value_type_enum type, config_value_bytes_t bytes) {
+        std::string_view text(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+        if (type == config_section_value_type_enum::config_section_value_type_string)
+            return text.find_first_of("#;=\r\n") == std::string_view::npos;
+        if (type == config_section_value_type_enum::config_section_value_type_list_string)
+            return text.find_first_of(",#;=\r\n") == std::string_view::npos;
+        return true;
+    }
+
+    void append_int(int value) {
+        char str[16];
+        char *last = std::to_chars(str, str + sizeof(str), value).ptr;
+        buffer.append(str, last - str);
+    }
+    void append_float(float value) {
+        char str[32];
+        char *last = std::to_chars(str, str + sizeof(str), value, std::chars_format::scientific).ptr;
+        std::string_view text(str, last - str);
+        size_t e = text.find('e');
+        if (e == std::string_view::npos) {
+            buffer += text;     // inf or nan
+            return;
+        }
+        // [-]d[.ddd]e<exp> as [-].dddde<exp + 1>
+        std::string_view mantissa = text.substr(0, e);
+        if (mantissa.front() == '-') {
+            buffer += '-';
+            mantissa.remove_prefix(1);
+        }
+        buffer += '.';
+        for (char c : mantissa) {
+            if (c != '.')
+                buffer += c;
+        }
+        int exponent = 0;
+        std::from_chars(text.data() + e + (text[e + 1] == '+' ? 2 : 1), text.data() + text.size(), exponent);
+        buffer += 'e';
+        append_int(exponent + 1);
+    }
+    template <typename element_t, typename append_t>
+    void append_list(config_value_bytes_t bytes, append_t append) {
+        buffer += '[';
+        for (size_t i = 0; i < bytes.size() / sizeof(element_t); i++) {
+            element_t element;
+            memcpy(&element, bytes.data() + i * sizeof(element_t), sizeof(element_t));
+            if (i != 0)
+                buffer += ", ";
+            append(element);
+        }
+        buffer += ']';
+    }
+    void append_value(config_section_value_type_enum type, config_value_bytes_t bytes) {
+        switch (type) {
+        case config_section_value_type_enum::config_section_value_type_int:
+            append_int(config_section_value_t::decode_int(bytes));
+            break;
+        case config_section_value_type_enum::config_section_value_type_float:
+            append_float(config_section_value_t::decode_float(bytes));
+            break;
+        case config_section_value_type_enum::config_section_value_type_range: {
+            config_value_range_t range = config_section_value_t::decode_range(bytes);
+            buffer += '(';
+            append_int(range.get_start());
+            buffer += ", ";
+            append_int(range.get_end());
+            buffer += ", ";
+            append_int(range.get_step());
+            buffer += ')';
+            break;
+        }
+        case config_section_value_type_enum::config_section_value_type_list_int:
+            append_list<int>(bytes, [&](int v) { append_int(v); });
+            break;
+        case config_section_value_type_enum::config_section_value_type_list_float:
+            append_list<float>(bytes, [&](float v) { append_float(v); });
+            break;
+        case config_section_value_type_enum::config_section_value_type_list_string: {
+            // '\0' terminated elements
+            buffer += '[';
+            for (size_t begin = 0, end; begin < bytes.size(); begin = end + 1) {
+                end = begin;
+                while (end < bytes.size() && bytes[end] != 0)
+                    end++;
+                if (begin != 0)
+                    buffer += ", ";
+                buffer += '\'';
+                buffer.append(reinterpret_cast<const char *>(bytes.data()) + begin, end - begin);
+                buffer += '\'';
+            }
+            buffer += ']';
+            break;
+        }
+        case config_section_value_type_enum::config_section_value_type_string:
+            buffer += '\'';
+            buffer.append(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+            buffer += '\'';
+            break;
+        default:
+            assert(false);
+        }
+    }
+};
+
+#endif
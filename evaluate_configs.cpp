@@ -0,0 +1,150 @@
+/*******************************************************************************
+ *
+ * MIT License
+ *
+ * Copyright (c) 2020 Advanced Micro Devices, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "config_gzip.hpp"
+#include "config_parser.hpp"
+#include "igemm_gtc_base.hpp"
+#include "igemm_gtc_select.hpp"
+#include "igemm_gtc_set.hpp"
+
+// named as the kernels are, igemm_bwd_gtcx_nchw_fp16_bx4_ex1_bt256x128x16_wt32x32x8_ws1x1_wr2x2_ta..._tb...
+static int kernel_name(const igemm_gtc_packed_tunable_t &t, char *name, size_t size)
+{
+    const auto &ta = t.tensor_a_thread_lengths, &ca = t.tensor_a_cluster_lengths;
+    const auto &tb = t.tensor_b_thread_lengths, &cb = t.tensor_b_cluster_lengths;
+    return snprintf(name, size,
+                    "igemm_%s_gtcx_%s_%s_bx%d_ex%d_bt%dx%dx%d_wt%dx%dx%d_ws%dx%d_wr%dx%d"
+                    "_ta%dx%dx%dx%d_%dx%dx%dx%d_tb%dx%dx%dx%d_%dx%dx%dx%d",
+                    t.get_direction(), t.get_tensor_layout(), t.get_precision(), t.nxb, t.nxe, t.gemm_m_per_block,
+                    t.gemm_n_per_block, t.gemm_k_per_block, t.wave_tile_m, t.wave_tile_n, t.wave_tile_k, t.wave_step_m,
+                    t.wave_step_n, t.wave_repeat_m, t.wave_repeat_n, ta[0], ta[1], ta[2], ta[3], ca[0], ca[1], ca[2], ca[3],
+                    tb[0], tb[1], tb[2], tb[3], cb[0], cb[1], cb[2], cb[3]);
+}
+
+int main(int argc, char **argv)
+{
+    if ( argc < 4 ) {
+         fprintf(stdout, "Usage: %s, <MIOpenDriver commands file> <configuration file> <output csv file> [threads]\n", argv[0]);
+         return(-1);
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    int num_threads = argc > 4 ? atoi(argv[4]) : (int)std::thread::hardware_concurrency();
+    num_threads = std::max(1, num_threads);
+
+    std::vector<igemm_gtc_packed_tunable_t> tunables = igemm_gtc_tunable_load_packed(argv[2]);
+    igemm_gtc_selector_t selector(tunables);
+
+    std::string text;
+    {
+         config_gzip_reader_t reader(argv[1]);
+         char block[64 * 1024];
+         for (size_t n = reader.read(block, sizeof(block)); n > 0; n = reader.read(block, sizeof(block)))
+              text.append(block, n);
+    }
+    std::vector<std::string_view> lines;
+    for (size_t pos = 0; pos < text.size();) {
+         size_t end = std::min(text.find('\n', pos), text.size());
+         lines.push_back(std::string_view(text).substr(pos, end - pos));
+         pos = end + 1;
+    };
+
+    // a row per direction a command runs, written by chunks of lines into their own buffers, in the order of the lines
+    const size_t chunk_lines = 1024;
+    const size_t max_row_bytes = 512;
+    size_t num_chunks = (lines.size() + chunk_lines - 1) / chunk_lines;
+    std::vector<std::string> rows(num_chunks), errors(num_chunks);
+    std::vector<size_t> num_problems(num_chunks, 0), num_selected(num_chunks, 0);
+    igemm_gtc_parallel_for(num_chunks, num_threads, [&](size_t c) {
+         std::string &out = rows[c];
+         out.reserve(std::min(lines.size() - c * chunk_lines, chunk_lines) * max_row_bytes);
+         char row[max_row_bytes], name[256];
+         for (size_t l = c * chunk_lines; l < std::min(lines.size(), (c + 1) * chunk_lines); l++) {
+              std::string_view line = lines[l];
+              size_t first = line.find_first_not_of(" \t\r");
+              if ( first == std::string_view::npos || line[first] == '#' )
+                   continue;
+              igemm_gtc_conv_problem_t problem;
+              unsigned directions;
+              const char *error;
+              if ( !igemm_gtc_problem_from_driver(line, problem, directions, error) ) {
+                   int n = snprintf(row, sizeof(row), "line %zu: %s\n", l + 1, error);
+                   errors[c].append(row, n);
+                   continue;
+              };
+              for (auto direction : {igemm_gtc_direction_enum::fwd, igemm_gtc_direction_enum::bwd, igemm_gtc_direction_enum::wrw}) {
+                   if ( (directions & (1u << static_cast<int>(direction))) == 0 )
+                        continue;
+                   problem.direction = direction;
+                   long index = selector.select(problem);
+                   size_t num_applicable = selector.count(problem);
+                   if ( index >= 0 )
+                        kernel_name(tunables[index], name, sizeof(name));
+                   else
+                        name[0] = 0;
+                   const igemm_gtc_conv_problem_t &p = problem;
+                   int n = snprintf(row, sizeof(row), "%zu,%s,%s,%s,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%zu,%ld,%s\n", l + 1,
+                                    igemm_gtc_direction_names[static_cast<int>(p.direction)],
+                                    igemm_gtc_tensor_layout_names[static_cast<int>(p.tensor_layout)],
+                                    igemm_gtc_precision_names[static_cast<int>(p.precision)], p.n, p.c, p.hi, p.wi, p.k, p.y,
+                                    p.x, p.pad_h, p.pad_w, p.stride_h, p.stride_w, p.dilation_h, p.dilation_w, p.group,
+                                    num_applicable, index, name);
+                   out.append(row, std::min<size_t>(n, sizeof(row) - 1));
+                   num_problems[c]++;
+                   num_selected[c] += index >= 0;
+              };
+         };
+    });
+
+    config_ofstream_t ofs(argv[3]);
+    ofs << "line,direction,layout,precision,n,c,hi,wi,k,y,x,pad_h,pad_w,stride_h,stride_w,dilation_h,dilation_w,group,"
+           "applicable,selected_index,selected\n";
+    size_t total_problems = 0, total_selected = 0;
+    for (size_t c = 0; c < num_chunks; c++) {
+         ofs << rows[c];
+         std::cout << errors[c];
+         total_problems += num_problems[c];
+         total_selected += num_selected[c];
+    };
+    if ( !ofs.close() ) {
+         fprintf(stdout, "fail to write %s\n", argv[3]);
+         return(-1);
+    };
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << total_problems << " problems of " << lines.size() << " lines against " << tunables.size() << " tunables, "
+              << total_selected << " with an applicable tunable, " << seconds << " s" << std::endl;
+};
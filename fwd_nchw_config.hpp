@@ -52,14 +52,16 @@ public:
     fwd_nchw_config& operator=(fwd_nchw_config&) = delete;
 
     void generate_configs(const char *precision, const char *config_file);
+protected:
+    const std::vector<int> &get_nxb_values() const;
+    void add_search_axes(config_search_space_t &space_) const;
+    bool make_candidate(const config_search_digits_t &digits, igemm_gtc_packed_tunable_t &cfg) const;
 private:
-    std::vector<igemm_gtc_tunable_t> configs;
-
-    int getMaximumSlice_a_c1e(int gemm_k_per_block, int blockSize, int macro_tile_m);
-    int getMaximumCluster_b_n1b(int gemm_k_per_block, int blockSize, int macro_tile_n);
+    int getMaximumSlice_a_c1e(int gemm_k_per_block, int blockSize, int macro_tile_m) const;
+    int getMaximumCluster_b_n1b(int gemm_k_per_block, int blockSize, int macro_tile_n) const;
 };
 
-int fwd_nchw_config::getMaximumSlice_a_c1e(int gemm_k_per_block, int blockSize, int macro_tile_m)
+int fwd_nchw_config::getMaximumSlice_a_c1e(int gemm_k_per_block, int blockSize, int macro_tile_m) const
 {
     int a_slice_size=8; 
 
@@ -70,7 +72,7 @@ int fwd_nchw_config::getMaximumSlice_a_c1e(int gemm_k_per_block, int blockSize,
     return(a_slice_size); 
 }; 
 
-int fwd_nchw_config::getMaximumCluster_b_n1b(int gemm_k_per_block, int blockSize, int macro_tile_n)
+int fwd_nchw_config::getMaximumCluster_b_n1b(int gemm_k_per_block, int blockSize, int macro_tile_n) const
 {
     int b_cluster_size = std::min(blockSize, macro_tile_n);
 
@@ -81,119 +83,107 @@ int fwd_nchw_config::getMaximumCluster_b_n1b(int gemm_k_per_block, int blockSize
     return(b_cluster_size); 
 }; 
 
+const std::vector<int> &fwd_nchw_config::get_nxb_values() const
+{
+    static const std::vector<int> nxb_values = { 1, 4, 16 }; 
+
+    return(nxb_values);
+}; 
+
+// b_scheme 0 is the maximum n1b cluster for tensor_b, b_scheme 1 the config with tensor_b_thread_lengths[1] = 1
+void fwd_nchw_config::add_search_axes(config_search_space_t &space_) const
+{
+    space_.add_axis("b_scheme", 2);
+}; 
+
+bool fwd_nchw_config::make_candidate(const config_search_digits_t &digits, igemm_gtc_packed_tunable_t &cfg) const
+{
+    int blockSize; 
+
+    make_common(digits, cfg, blockSize); 
+
+    cfg.tensor_layout = igemm_gtc_tensor_layout_enum::nchw; 
+    cfg.direction = igemm_gtc_direction_enum::fwd;
+    cfg.source_access_order = 1;     // not written out, the default fwd tunables are read back with
+
+    if ( cfg.gemm_n_per_block % cfg.nxb != 0 ) 
+         return(false);  
+
+    // consider the gemm_k_per_block sizes to be 2x, 4x, 8x that of the k_per_inst of the specific xlops instruction
+
+    if ( cfg.gemm_k_per_block / 8 > blockSize )  // this should not occurr easily
+         return(false);  
+
+    if ( blockSize / (cfg.gemm_k_per_block/1) > cfg.gemm_m_per_block ) // this could occurr easily for small value of gemm_m_per_block 
+         return(false); 	
+
+    if ( blockSize / std::min<int>(blockSize, cfg.gemm_n_per_block) > cfg.gemm_k_per_block )
+         return(false); 
+
+    int slice_a_c1e = getMaximumSlice_a_c1e(cfg.gemm_k_per_block, blockSize, cfg.gemm_m_per_block); 
+
+    // We have the following assumption to generate fwd configs:
+    // 1) cluster dimension is always the lower dimension of gemm_k/gemm_m/gemm_n (c1e/k1/n1b)
+    // 2) c0 is not used for both cluster and slice allocation 
+    // 3) gemm_m/gemm_n uses lower higher dimensions for slice (k0, n0)
+
+    cfg.tensor_a_thread_lengths[0] = 1; 
+    cfg.tensor_b_thread_lengths[0] = 1; 
+    cfg.tensor_a_cluster_lengths[0] = 1; 
+    cfg.tensor_b_cluster_lengths[0] = 1; 
+    cfg.tensor_a_cluster_lengths[2] = 1; 
+    cfg.tensor_b_cluster_lengths[2] = 1;
+    cfg.tensor_a_thread_lengths[3] = 1; 
+    cfg.tensor_b_thread_lengths[3] = 1; 
+
+    cfg.tensor_a_thread_lengths[1] = slice_a_c1e; 
+    cfg.tensor_a_cluster_lengths[1] = cfg.gemm_k_per_block / slice_a_c1e; 
+    cfg.tensor_a_cluster_lengths[3] = blockSize / cfg.tensor_a_cluster_lengths[1]; 
+    cfg.tensor_a_thread_lengths[2] = cfg.gemm_m_per_block / cfg.tensor_a_cluster_lengths[3]; 
+
+    int cluster_b_n1b = getMaximumCluster_b_n1b(cfg.gemm_k_per_block, blockSize, cfg.gemm_n_per_block); 
+
+    cfg.tensor_b_cluster_lengths[3] = cluster_b_n1b; 
+    cfg.tensor_b_cluster_lengths[1] = blockSize / cluster_b_n1b; 
+    cfg.tensor_b_thread_lengths[1] = cfg.gemm_k_per_block / cfg.tensor_b_cluster_lengths[1];
+    cfg.tensor_b_thread_lengths[2] = cfg.gemm_n_per_block / cfg.tensor_b_cluster_lengths[3];  
+
+    if ( digits[config_search_num_common_axes] == 0 ) 
+         return(true); 
+
+    // we need a config which has tensor_b_thread_lengths[1] = 1 to support the cases where either x != 1 or y != 1
+    if ( cfg.tensor_b_cluster_lengths[1] != cfg.gemm_k_per_block && blockSize / cfg.gemm_k_per_block <= cfg.gemm_n_per_block ) {
+         cfg.tensor_b_thread_lengths[0] = 1; 
+         cfg.tensor_b_thread_lengths[1] = 1; 
+         cfg.tensor_b_cluster_lengths[0] = 1; 
+         cfg.tensor_b_cluster_lengths[1] = cfg.gemm_k_per_block; 
+         cfg.tensor_b_cluster_lengths[2] = 1; 
+         cfg.tensor_b_cluster_lengths[3] = blockSize / cfg.tensor_b_cluster_lengths[1]; 
+         cfg.tensor_b_thread_lengths[2] = cfg.gemm_n_per_block / cfg.tensor_b_cluster_lengths[3]; 
+         cfg.tensor_b_thread_lengths[3] = 1; 
+
+         // to satisfy unmerge_sub_n % nb_n0 == 0 
+         if ( (cfg.gemm_n_per_block / cfg.nxb ) % cfg.tensor_b_thread_lengths[2] == 0 ) 
+              return(true); 
+    }; 
+
+    return(false); 
+}; 
+
 void fwd_nchw_config::generate_configs(const char *precision, const char *config_file)
 {
-    std::ofstream ofs(config_file, std::ofstream::out);
-
-    int num_mappings = (std::string(precision) == "fp32")? NUM_XDLOPS_MAPPING_FP32 : NUM_XDLOPS_MAPPING_FP16; 
-
-    for (int i=0; i < num_mappings; i++) {
-         auto xm = (std::string(precision) == "fp32")? xdlops_mappings_fp32[i] : xdlops_mappings_fp16[i];
-
-         igemm_gtc_tunable_t cfg; 
-
-         cfg.gemm_m_per_block = xm.macro_tile_m; 
-         cfg.gemm_n_per_block = xm.macro_tile_n; 
-         cfg.wave_tile_m = xm.wave_tile_m; 
-	 cfg.wave_tile_n = xm.wave_tile_n; 
-         cfg.wave_tile_k = xm.wave_tile_k; 
-         cfg.wave_repeat_m = xm.wave_repeat_m; 
-	 cfg.wave_repeat_n = xm.wave_repeat_n; 
-	 cfg.wave_step_m = xm.wave_step_m; 
-	 cfg.wave_step_n = xm.wave_step_n; 
-
-         cfg.tensor_a_thread_lengths.resize(4); 
-         cfg.tensor_a_cluster_lengths.resize(4); 
-         cfg.tensor_b_thread_lengths.resize(4); 
-         cfg.tensor_b_cluster_lengths.resize(4); 
-
-         cfg.tensor_layout = "nchw"; 
-         cfg.direction = "fwd";
-	 cfg.precision = precision; 
-
-         int blockSize = waveSize * xm.waves; 
-
-         for (int nxe=0; nxe < 2; nxe += 1)  {
-              cfg.nxe = nxe; 	
-	      for (int nxb=1; nxb < 17; nxb *= 4) {
-                   if ( cfg.gemm_n_per_block % nxb != 0 ) 
-			continue;  
-
-                   cfg.nxb = nxb;
-
-                   // consider the gemm_k_per_block sizes to be 2x, 4x, 8x that of the k_per_inst of the specific xlops instruction
-                   // for fp32, gemm_k_per_block must be at lest 4-times multiplier of k_per_inst
-                   int lower_k_shifts = std::string(precision) == "fp16"? 1 : 2;
-                   int upper_k_shifts = std::string(precision) == "fp16"? 3 : 4;
-
-                   for (int k=lower_k_shifts; k < upper_k_shifts; k++) {
-                        cfg.gemm_k_per_block = xm.wave_tile_k << k;             
-
-                        if ( cfg.gemm_k_per_block / 8 > blockSize )  // this should not occurr easily
-		             continue;  
-
-                        if ( blockSize / (cfg.gemm_k_per_block/1) > cfg.gemm_m_per_block ) // this could occurr easily for small value of gemm_m_per_block 
-			     continue; 	
-
-                        if ( blockSize / std::min(blockSize, cfg.gemm_n_per_block) > cfg.gemm_k_per_block )
-			     continue; 
-
-                        int slice_a_c1e = getMaximumSlice_a_c1e(cfg.gemm_k_per_block, blockSize, cfg.gemm_m_per_block); 
-
-                        // We have the following assumption to generate fwd configs:
-                        // 1) cluster dimension is always the lower dimension of gemm_k/gemm_m/gemm_n (c1e/k1/n1b)
-                        // 2) c0 is not used for both cluster and slice allocation 
-			// 3) gemm_m/gemm_n uses lower higher dimensions for slice (k0, n0)
-
-	                cfg.tensor_a_thread_lengths[0] = 1; 
-			cfg.tensor_b_thread_lengths[0] = 1; 
-                        cfg.tensor_a_cluster_lengths[0] = 1; 
-		        cfg.tensor_b_cluster_lengths[0] = 1; 
-                        cfg.tensor_a_cluster_lengths[2] = 1; 
-		        cfg.tensor_b_cluster_lengths[2] = 1;
-                        cfg.tensor_a_thread_lengths[3] = 1; 
-			cfg.tensor_b_thread_lengths[3] = 1; 
-
-	                cfg.tensor_a_thread_lengths[1] = slice_a_c1e; 
-	                cfg.tensor_a_cluster_lengths[1] = cfg.gemm_k_per_block / slice_a_c1e; 
-	                cfg.tensor_a_cluster_lengths[3] = blockSize / cfg.tensor_a_cluster_lengths[1]; 
-	                cfg.tensor_a_thread_lengths[2] = cfg.gemm_m_per_block / cfg.tensor_a_cluster_lengths[3]; 
-
-                        int cluster_b_n1b = getMaximumCluster_b_n1b(cfg.gemm_k_per_block, blockSize, cfg.gemm_n_per_block); 
-
-		        cfg.tensor_b_cluster_lengths[3] = cluster_b_n1b; 
-		        cfg.tensor_b_cluster_lengths[1] = blockSize / cluster_b_n1b; 
-			cfg.tensor_b_thread_lengths[1] = cfg.gemm_k_per_block / cfg.tensor_b_cluster_lengths[1];
-			cfg.tensor_b_thread_lengths[2] = cfg.gemm_n_per_block / cfg.tensor_b_cluster_lengths[3];  
-
-                        configs.push_back(cfg); 
-
-                        // we need a config which has tensor_b_thread_lengths[1] = 1 to support the cases where either x != 1 or y != 1
-                        if ( cfg.tensor_b_cluster_lengths[1] != cfg.gemm_k_per_block && blockSize / cfg.gemm_k_per_block <= cfg.gemm_n_per_block ) {
-                             cfg.tensor_b_thread_lengths[0] = 1; 
-			     cfg.tensor_b_thread_lengths[1] = 1; 
-			     cfg.tensor_b_cluster_lengths[0] = 1; 
-                             cfg.tensor_b_cluster_lengths[1] = cfg.gemm_k_per_block; 
-                             cfg.tensor_b_cluster_lengths[2] = 1; 
-                             cfg.tensor_b_cluster_lengths[3] = blockSize / cfg.tensor_b_cluster_lengths[1]; 
-			     cfg.tensor_b_thread_lengths[2] = cfg.gemm_n_per_block / cfg.tensor_b_cluster_lengths[3]; 
-			     cfg.tensor_b_thread_lengths[3] = 1; 
-
-                             // to satisfy unmerge_sub_n % nb_n0 == 0 
-                             if ( (cfg.gemm_n_per_block / cfg.nxb ) % cfg.tensor_b_thread_lengths[2] == 0 ) 
-			           configs.push_back(cfg); 
-			}; 
-                   }; 
-	     }; 
-         };	
-    };  
+    make_configs(precision);
+
+    config_ofstream_t ofs(config_file);
 
     output_configurations(this->configs, "C0xC1ExK0xK1", "C0xC1ExN0xN1B", ofs);
 
     std::cout << std::endl << this->configs.size() << " configs produced !" << std::endl;
 };
 
-bool FwdNchwSorter(igemm_gtc_tunable_t &cfg1, igemm_gtc_tunable_t &cfg2)
+// igemm_gtc_packed_tunable_t, or igemm_gtc_tunable_t
+template <typename tunable_t>
+bool FwdNchwSorter(tunable_t &cfg1, tunable_t &cfg2)
 {
      // it seems larger size of gemm_k_per_block is not very helpful ?
      if ( cfg1.gemm_k_per_block > cfg2.gemm_k_per_block )
@@ -242,5 +232,25 @@ bool FwdNchwSorter(igemm_gtc_tunable_t &cfg1, igemm_gtc_tunable_t &cfg2)
      return(false);
 }; 
 
+// FwdNchwSorter() as a key, larger first, read from the tunable and its derived attributes
+static inline igemm_gtc_sort_key_t FwdNchwSortKey(const igemm_gtc_packed_tunable_t &cfg, const igemm_gtc_tunable_attributes_t &attributes)
+{
+     igemm_gtc_sort_key_t key;
+
+     (void)attributes;
+
+     // the sorter counts the threads on the c1e and n1b clusters of B only, which is not the block size of
+     // every tunable
+     key.push(cfg.gemm_k_per_block, 12, true);
+     key.push(cfg.tensor_b_cluster_lengths[1] * cfg.tensor_b_cluster_lengths[3], 12, true);
+     key.push(cfg.tensor_a_cluster_lengths[1], 12, true);
+     key.push(cfg.tensor_b_cluster_lengths[3], 12, true);
+     key.push(cfg.nxe, 1, false);
+     key.push(cfg.nxb, 8, true);
+     key.push(cfg.wave_tile_k, 8, true);
+
+     return(key);
+};
+
 #endif
 
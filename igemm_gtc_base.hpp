@@ -30,12 +30,24 @@
 
 using float16 = half_float::half;
 
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <limits>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <string.h>
 #include <unistd.h>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <assert.h>
 
+#include "config_binary.hpp"
 #include "config_parser.hpp"
+#include "config_writer.hpp"
 #include "utility.hpp"
 
 #define IGEMM_GTC_TUNABLE_FMA_TYPE_MAC              "mac"
@@ -93,84 +105,1153 @@ typedef struct {
     int gemm_k_global_split;
 } igemm_gtc_tunable_t;
 
-static inline std::string get_igemm_gtc_fma_type(std::string arch_string, const config_section_t &sec){
-    if(sec.count("gemm_m_per_thread") > 0 && sec.count("gemm_n_per_thread") > 0){
-        if(arch_string == "gfx900")
-            return IGEMM_GTC_TUNABLE_FMA_TYPE_MAC;
-        if(arch_string == "gfx906")
-            return IGEMM_GTC_TUNABLE_FMA_TYPE_DLOPS;
-        if(arch_string == "gfx908")
-            return IGEMM_GTC_TUNABLE_FMA_TYPE_DLOPS;
-    }else if(sec.count("wave_tile_m") > 0 && sec.count("wave_tile_n") > 0){
-        assert(arch_string == "gfx908");
-        return IGEMM_GTC_TUNABLE_FMA_TYPE_XDLOPS;
+/*
+* trivially copyable, 64 bytes flavor of igemm_gtc_tunable_t for the tools
+* generating, sorting and grouping lots of tunables: the string members are
+* enums, the lengths are fixed arrays, the small ints are narrowed. The
+* get_*() accessors give back the strings. igemm_gtc_tunable_pack() and
+* igemm_gtc_tunable_unpack() convert both ways without losing anything, a
+* tunable holding what does not fit (an unknown string, a length list not of
+* 4, a value out of range) is refused by igemm_gtc_tunable_pack().
+*/
+enum class igemm_gtc_tensor_layout_enum : uint8_t { none = 0, nchw, nhwc };
+enum class igemm_gtc_direction_enum : uint8_t { none = 0, fwd, bwd, wrw };
+enum class igemm_gtc_precision_enum : uint8_t { none = 0, fp32, fp16, bf16 };
+enum class igemm_gtc_fma_type_enum : uint8_t { none = 0, mac, dlops, xdlops, na };
+
+// by enum value, 'none' is the empty string of a tunable never given one
+static const char *const igemm_gtc_tensor_layout_names[] = {"", "nchw", "nhwc"};
+static const char *const igemm_gtc_direction_names[] = {"", "fwd", "bwd", "wrw"};
+static const char *const igemm_gtc_precision_names[] = {"", "fp32", "fp16", "bf16"};
+static const char *const igemm_gtc_fma_type_names[] = {"", IGEMM_GTC_TUNABLE_FMA_TYPE_MAC, IGEMM_GTC_TUNABLE_FMA_TYPE_DLOPS,
+                                                       IGEMM_GTC_TUNABLE_FMA_TYPE_XDLOPS, IGEMM_GTC_TUNABLE_FMA_TYPE_NA};
+
+template <typename enum_t, size_t n>
+static inline bool igemm_gtc_enum_from_name(const char *const (&names)[n], std::string_view name, enum_t &value)
+{
+    for (size_t i = 0; i < n; i++) {
+        if (name == names[i]) {
+            value = static_cast<enum_t>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+struct alignas(64) igemm_gtc_packed_tunable_t {
+    std::array<uint16_t, 4> tensor_a_thread_lengths;
+    std::array<uint16_t, 4> tensor_a_cluster_lengths;
+    std::array<uint16_t, 4> tensor_b_thread_lengths;
+    std::array<uint16_t, 4> tensor_b_cluster_lengths;
+    uint16_t gemm_m_per_block;
+    uint16_t gemm_n_per_block;
+    uint16_t gemm_k_per_block;
+    union{
+        struct{
+            uint16_t gemm_m_per_thread;
+            uint16_t gemm_m_level0_cluster;
+            uint16_t gemm_m_level1_cluster;
+            uint16_t gemm_n_per_thread;
+            uint16_t gemm_n_level0_cluster;
+            uint16_t gemm_n_level1_cluster;
+            uint16_t dummy;
+        };
+        struct{
+            uint16_t wave_tile_m;
+            uint16_t wave_step_m;
+            uint16_t wave_repeat_m;
+            uint16_t wave_tile_n;
+            uint16_t wave_step_n;
+            uint16_t wave_repeat_n;
+            uint16_t wave_tile_k;
+        };
+    };
+    uint8_t nxb;
+    uint8_t nxe;
+    uint8_t gemm_m_unmerge_cluster;
+    uint8_t gemm_n_unmerge_cluster;
+    uint8_t gemm_k_unmerge_cluster;
+    uint8_t multihead;
+    uint8_t source_access_order;
+    uint8_t gemm_k_global_split;
+    igemm_gtc_tensor_layout_enum tensor_layout;
+    igemm_gtc_direction_enum direction;
+    igemm_gtc_precision_enum precision;
+    igemm_gtc_fma_type_enum fma_type;
+
+    const char *get_tensor_layout() const { return igemm_gtc_tensor_layout_names[static_cast<int>(tensor_layout)]; }
+    const char *get_direction() const { return igemm_gtc_direction_names[static_cast<int>(direction)]; }
+    const char *get_precision() const { return igemm_gtc_precision_names[static_cast<int>(precision)]; }
+    const char *get_fma_type() const { return igemm_gtc_fma_type_names[static_cast<int>(fma_type)]; }
+};
+
+static_assert(sizeof(igemm_gtc_packed_tunable_t) == 64, "igemm_gtc_packed_tunable_t is one cache line");
+static_assert(std::is_trivially_copyable<igemm_gtc_packed_tunable_t>::value,
+              "igemm_gtc_packed_tunable_t is copied as bytes");
+
+template <typename packed_t>
+static inline bool igemm_gtc_tunable_pack_int(int value, packed_t &packed)
+{
+    if (value < 0 || value > std::numeric_limits<packed_t>::max())
+        return false;
+    packed = static_cast<packed_t>(value);
+    return true;
+}
+
+static inline bool igemm_gtc_tunable_pack_lengths(const std::vector<int> &lengths, std::array<uint16_t, 4> &packed)
+{
+    if (lengths.size() != packed.size())
+        return false;
+    for (size_t i = 0; i < packed.size(); i++) {
+        if (!igemm_gtc_tunable_pack_int(lengths[i], packed[i]))
+            return false;
+    }
+    return true;
+}
+
+// false if 'tunable' holds anything igemm_gtc_packed_tunable_t can not
+static inline bool igemm_gtc_tunable_pack(const igemm_gtc_tunable_t &tunable, igemm_gtc_packed_tunable_t &packed)
+{
+    packed = igemm_gtc_packed_tunable_t();
+    // the last int of the mac view is never set, it is packed as 0
+    bool is_mac = tunable.fma_type == IGEMM_GTC_TUNABLE_FMA_TYPE_MAC || tunable.fma_type == IGEMM_GTC_TUNABLE_FMA_TYPE_DLOPS;
+    return igemm_gtc_tunable_pack_lengths(tunable.tensor_a_thread_lengths, packed.tensor_a_thread_lengths) &&
+           igemm_gtc_tunable_pack_lengths(tunable.tensor_a_cluster_lengths, packed.tensor_a_cluster_lengths) &&
+           igemm_gtc_tunable_pack_lengths(tunable.tensor_b_thread_lengths, packed.tensor_b_thread_lengths) &&
+           igemm_gtc_tunable_pack_lengths(tunable.tensor_b_cluster_lengths, packed.tensor_b_cluster_lengths) &&
+           igemm_gtc_tunable_pack_int(tunable.gemm_m_per_block, packed.gemm_m_per_block) &&
+           igemm_gtc_tunable_pack_int(tunable.gemm_n_per_block, packed.gemm_n_per_block) &&
+           igemm_gtc_tunable_pack_int(tunable.gemm_k_per_block, packed.gemm_k_per_block) &&
+           // the union members go through the xdlops view, the mac one aliases it
+           igemm_gtc_tunable_pack_int(tunable.wave_tile_m, packed.wave_tile_m) &&
+           igemm_gtc_tunable_pack_int(tunable.wave_step_m, packed.wave_step_m) &&
+           igemm_gtc_tunable_pack_int(tunable.wave_repeat_m, packed.wave_repeat_m) &&
+           igemm_gtc_tunable_pack_int(tunable.wave_tile_n, packed.wave_tile_n) &&
+           igemm_gtc_tunable_pack_int(tunable.wave_step_n, packed.wave_step_n) &&
+           igemm_gtc_tunable_pack_int(tunable.wave_repeat_n, packed.wave_repeat_n) &&
+           (is_mac || igemm_gtc_tunable_pack_int(tunable.wave_tile_k, packed.wave_tile_k)) &&
+           igemm_gtc_tunable_pack_int(tunable.nxb, packed.nxb) &&
+           igemm_gtc_tunable_pack_int(tunable.nxe, packed.nxe) &&
+           igemm_gtc_tunable_pack_int(tunable.gemm_m_unmerge_cluster, packed.gemm_m_unmerge_cluster) &&
+           igemm_gtc_tunable_pack_int(tunable.gemm_n_unmerge_cluster, packed.gemm_n_unmerge_cluster) &&
+           igemm_gtc_tunable_pack_int(tunable.gemm_k_unmerge_cluster, packed.gemm_k_unmerge_cluster) &&
+           igemm_gtc_tunable_pack_int(tunable.multihead, packed.multihead) &&
+           igemm_gtc_tunable_pack_int(tunable.source_access_order, packed.source_access_order) &&
+           igemm_gtc_tunable_pack_int(tunable.gemm_k_global_split, packed.gemm_k_global_split) &&
+           igemm_gtc_enum_from_name(igemm_gtc_tensor_layout_names, tunable.tensor_layout, packed.tensor_layout) &&
+           igemm_gtc_enum_from_name(igemm_gtc_direction_names, tunable.direction, packed.direction) &&
+           igemm_gtc_enum_from_name(igemm_gtc_precision_names, tunable.precision, packed.precision) &&
+           igemm_gtc_enum_from_name(igemm_gtc_fma_type_names, tunable.fma_type, packed.fma_type);
+}
+
+// the tools refuse a config whose tunables do not pack
+static inline std::vector<igemm_gtc_packed_tunable_t>
+igemm_gtc_tunable_pack(const std::vector<igemm_gtc_tunable_t> &tunables)
+{
+    std::vector<igemm_gtc_packed_tunable_t> packed(tunables.size());
+    for (size_t i = 0; i < tunables.size(); i++) {
+        if (!igemm_gtc_tunable_pack(tunables[i], packed[i])) {
+            printf("tunable %zu has a value igemm_gtc_packed_tunable_t can not hold\n", i);
+            exit(-1);
+        }
+    }
+    return packed;
+}
+
+static inline igemm_gtc_tunable_t igemm_gtc_tunable_unpack(const igemm_gtc_packed_tunable_t &packed)
+{
+    igemm_gtc_tunable_t tunable;
+    tunable.tensor_layout = packed.get_tensor_layout();
+    tunable.gemm_m_per_block = packed.gemm_m_per_block;
+    tunable.gemm_n_per_block = packed.gemm_n_per_block;
+    tunable.gemm_k_per_block = packed.gemm_k_per_block;
+    tunable.fma_type = packed.get_fma_type();
+    tunable.wave_tile_m = packed.wave_tile_m;
+    tunable.wave_step_m = packed.wave_step_m;
+    tunable.wave_repeat_m = packed.wave_repeat_m;
+    tunable.wave_tile_n = packed.wave_tile_n;
+    tunable.wave_step_n = packed.wave_step_n;
+    tunable.wave_repeat_n = packed.wave_repeat_n;
+    tunable.wave_tile_k = packed.wave_tile_k;
+    tunable.tensor_a_thread_lengths.assign(packed.tensor_a_thread_lengths.begin(), packed.tensor_a_thread_lengths.end());
+    tunable.tensor_a_cluster_lengths.assign(packed.tensor_a_cluster_lengths.begin(), packed.tensor_a_cluster_lengths.end());
+    tunable.tensor_b_thread_lengths.assign(packed.tensor_b_thread_lengths.begin(), packed.tensor_b_thread_lengths.end());
+    tunable.tensor_b_cluster_lengths.assign(packed.tensor_b_cluster_lengths.begin(), packed.tensor_b_cluster_lengths.end());
+    tunable.direction = packed.get_direction();
+    tunable.precision = packed.get_precision();
+    tunable.nxb = packed.nxb;
+    tunable.nxe = packed.nxe;
+    tunable.gemm_m_unmerge_cluster = packed.gemm_m_unmerge_cluster;
+    tunable.gemm_n_unmerge_cluster = packed.gemm_n_unmerge_cluster;
+    tunable.gemm_k_unmerge_cluster = packed.gemm_k_unmerge_cluster;
+    tunable.multihead = packed.multihead;
+    tunable.source_access_order = packed.source_access_order;
+    tunable.gemm_k_global_split = packed.gemm_k_global_split;
+    return tunable;
+}
+
+/*
+* a packed tunable is its own canonical key: every field a kernel is generated
+* from, no padding, and the never set last int of the mac view left 0 (value
+* initialize the packed tunables built by hand, as the generators do). So two
+* tunables are the same kernel exactly when their 64 bytes are, and the hash is
+* a 64 bits fingerprint of those bytes.
+*/
+static inline bool operator==(const igemm_gtc_packed_tunable_t &a, const igemm_gtc_packed_tunable_t &b)
+{
+    return memcmp(&a, &b, sizeof(igemm_gtc_packed_tunable_t)) == 0;
+}
+static inline bool operator!=(const igemm_gtc_packed_tunable_t &a, const igemm_gtc_packed_tunable_t &b)
+{
+    return !(a == b);
+}
+
+static inline uint64_t igemm_gtc_tunable_hash(const igemm_gtc_packed_tunable_t &packed)
+{
+    return utility_hash64(&packed, sizeof(igemm_gtc_packed_tunable_t));
+}
+
+namespace std {
+template <>
+struct hash<igemm_gtc_packed_tunable_t> {
+    size_t operator()(const igemm_gtc_packed_tunable_t &packed) const {
+        return static_cast<size_t>(igemm_gtc_tunable_hash(packed));
+    }
+};
+}
+
+// drops the tunables seen before in 'tunables', the first ones stay in place
+// and keep their order. Returns how many were dropped.
+static inline size_t igemm_gtc_tunable_drop_duplicates(std::vector<igemm_gtc_packed_tunable_t> &tunables)
+{
+    std::unordered_set<igemm_gtc_packed_tunable_t> seen;
+    seen.reserve(tunables.size());
+    size_t kept = 0;
+    for (size_t i = 0; i < tunables.size(); i++) {
+        if (seen.insert(tunables[i]).second)
+            tunables[kept++] = tunables[i];
+    }
+    size_t dropped = tunables.size() - kept;
+    tunables.resize(kept);
+    return dropped;
+}
+
+/*
+* values derived from the fields of a packed tunable, computed once by
+* igemm_gtc_tunable_derive() and kept next to it for the sorters, filters and
+* reports reading them again and again. The vector widths are the thread
+* lengths of the dimensions contiguous in memory for the direction and layout
+* (c1e for fwd nchw A, k1 for bwd nhwc A, the last dimension otherwise), a
+* global load moves one vector, so a thread issues its thread elements divided
+* by the width per gemm_k_per_block step. Counts too large for their field
+* saturate.
+*/
+struct igemm_gtc_tunable_attributes_t {
+    uint32_t macro_tile;          // gemm_m_per_block * gemm_n_per_block
+    uint32_t lds_bytes;           // one buffer of the A and B tiles of a gemm_k_per_block step
+    uint16_t block_size;          // threads of a work-group, the product of the cluster lengths of A
+    uint16_t waves;
+    uint16_t global_loads_a;      // per thread and gemm_k_per_block step
+    uint16_t global_loads_b;
+    uint16_t mfma_per_k_step;     // xdlops instructions of a wave per gemm_k_per_block step, 0 for mac and dlops
+    uint16_t unmerge_sub_n;       // gemm_n_per_block / nxb, as the generators use gemm_n_unmerge_cluster == 0
+    uint8_t vector_a;
+    uint8_t vector_b;
+    uint8_t data_bytes;           // of one element of the precision
+};
+
+// by igemm_gtc_precision_enum
+static const uint8_t igemm_gtc_precision_bytes[] = {0, 4, 2, 2};
+
+template <typename value_t>
+static inline value_t igemm_gtc_saturate(uint64_t value)
+{
+    return static_cast<value_t>(std::min<uint64_t>(value, std::numeric_limits<value_t>::max()));
+}
+
+static inline igemm_gtc_tunable_attributes_t igemm_gtc_tunable_derive(const igemm_gtc_packed_tunable_t &tunable)
+{
+    igemm_gtc_tunable_attributes_t attributes = igemm_gtc_tunable_attributes_t();
+    uint64_t block_size = 1, thread_elements_a = 1, thread_elements_b = 1;
+    for (int i = 0; i < 4; i++) {
+        block_size *= tunable.tensor_a_cluster_lengths[i];
+        thread_elements_a *= tunable.tensor_a_thread_lengths[i];
+        thread_elements_b *= tunable.tensor_b_thread_lengths[i];
+    }
+    bool vector_on_k = (tunable.direction == igemm_gtc_direction_enum::fwd && tunable.tensor_layout == igemm_gtc_tensor_layout_enum::nchw) ||
+                       (tunable.direction == igemm_gtc_direction_enum::bwd && tunable.tensor_layout == igemm_gtc_tensor_layout_enum::nhwc);
+    uint16_t vector_a = vector_on_k ? tunable.tensor_a_thread_lengths[1] : tunable.tensor_a_thread_lengths[3];
+    uint16_t vector_b = tunable.tensor_b_thread_lengths[3];
+
+    attributes.macro_tile = static_cast<uint32_t>(tunable.gemm_m_per_block) * tunable.gemm_n_per_block;
+    attributes.data_bytes = igemm_gtc_precision_bytes[static_cast<int>(tunable.precision)];
+    attributes.lds_bytes = (static_cast<uint32_t>(tunable.gemm_m_per_block) + tunable.gemm_n_per_block) *
+                           tunable.gemm_k_per_block * attributes.data_bytes;
+    attributes.block_size = igemm_gtc_saturate<uint16_t>(block_size);
+    attributes.waves = attributes.block_size / AMDGPU_WAVE_SIZE;
+    attributes.vector_a = igemm_gtc_saturate<uint8_t>(vector_a);
+    attributes.vector_b = igemm_gtc_saturate<uint8_t>(vector_b);
+    attributes.global_loads_a = vector_a == 0 ? 0 : igemm_gtc_saturate<uint16_t>(thread_elements_a / vector_a);
+    attributes.global_loads_b = vector_b == 0 ? 0 : igemm_gtc_saturate<uint16_t>(thread_elements_b / vector_b);
+    if (tunable.fma_type == igemm_gtc_fma_type_enum::xdlops && tunable.wave_tile_k != 0)
+        attributes.mfma_per_k_step = igemm_gtc_saturate<uint16_t>(
+            uint64_t(tunable.wave_repeat_m) * tunable.wave_step_m * tunable.wave_repeat_n * tunable.wave_step_n *
+            (tunable.gemm_k_per_block / tunable.wave_tile_k));
+    attributes.unmerge_sub_n = tunable.nxb == 0 ? 0 : tunable.gemm_n_per_block / tunable.nxb;
+    return attributes;
+}
+
+static inline std::vector<igemm_gtc_tunable_attributes_t>
+igemm_gtc_tunable_derive(const std::vector<igemm_gtc_packed_tunable_t> &tunables)
+{
+    std::vector<igemm_gtc_tunable_attributes_t> attributes(tunables.size());
+    for (size_t i = 0; i < tunables.size(); i++)
+        attributes[i] = igemm_gtc_tunable_derive(tunables[i]);
+    return attributes;
+}
+
+/*
+* the comparisons of a sorter folded into one key of up to 95 bits, the tunable
+* with the larger key going first: each comparison pushes its value in 'width'
+* bits, complemented when the smaller value goes first. A value not fitting its
+* width makes the key inexact, and inexact keys are never compared.
+*/
+struct igemm_gtc_sort_key_t {
+    static constexpr int max_bits = 95;
+
+    unsigned __int128 value = 0;
+    int bits = 0;
+    bool exact = true;
+
+    void push(uint64_t v, int width, bool larger_first) {
+        assert(bits + width <= max_bits);
+        uint64_t max = (uint64_t(1) << width) - 1;
+        if (v > max) {
+            exact = false;
+            v = max;
+        }
+        value = (value << width) | (larger_first ? v : max - v);
+        bits += width;
+    }
+};
+
+/*
+* sorts 'tunables' and their 'attributes' along as std::sort() with 'sorter'
+* would, the comparisons made on 16 bytes records of the complemented keys of
+* 'key_fn', an inexact bit and the index of the tunable, rather than on the
+* tunables. The keys giving the same answer as 'sorter' to every comparison,
+* the order comes out the same, ties included. A pair holding an inexact key is
+* compared by 'sorter', and only when there is one is the check paid for.
+*/
+template <typename key_fn_t, typename sorter_t>
+static inline void igemm_gtc_tunable_sort(std::vector<igemm_gtc_packed_tunable_t> &tunables,
+                                          std::vector<igemm_gtc_tunable_attributes_t> &attributes,
+                                          key_fn_t key_fn, sorter_t sorter)
+{
+    assert(tunables.size() == attributes.size() && tunables.size() <= std::numeric_limits<uint32_t>::max());
+    constexpr unsigned __int128 inexact_bit = static_cast<unsigned __int128>(1) << 32;
+    std::vector<unsigned __int128> records(tunables.size());
+    bool any_inexact = false;
+    for (size_t i = 0; i < tunables.size(); i++) {
+        igemm_gtc_sort_key_t key = key_fn(tunables[i], attributes[i]);
+        unsigned __int128 value = ~(key.value << (igemm_gtc_sort_key_t::max_bits - key.bits));
+        records[i] = (value << 33) | (key.exact ? 0 : inexact_bit) | i;
+        any_inexact = any_inexact || !key.exact;
+    }
+    if (any_inexact)
+        std::sort(records.begin(), records.end(), [&](unsigned __int128 a, unsigned __int128 b) {
+            if (((a | b) & inexact_bit) != 0)
+                return sorter(tunables[static_cast<uint32_t>(a)], tunables[static_cast<uint32_t>(b)]);
+            return (a >> 33) < (b >> 33);
+        });
+    else
+        std::sort(records.begin(), records.end(), [](unsigned __int128 a, unsigned __int128 b) { return (a >> 33) < (b >> 33); });
+
+    // gathered into vectors reserved rather than sized, saving the pass clearing them
+    std::vector<igemm_gtc_packed_tunable_t> sorted_tunables;
+    std::vector<igemm_gtc_tunable_attributes_t> sorted_attributes;
+    sorted_tunables.reserve(tunables.size());
+    sorted_attributes.reserve(tunables.size());
+    for (unsigned __int128 record : records) {
+        sorted_tunables.push_back(tunables[static_cast<uint32_t>(record)]);
+        sorted_attributes.push_back(attributes[static_cast<uint32_t>(record)]);
+    }
+    tunables.swap(sorted_tunables);
+    attributes.swap(sorted_attributes);
+}
+
+// keys of the tunable sections, interned once so that the lookups below are a probe
+// into the section dictionary rather than a string hash
+struct igemm_gtc_tunable_keys_t {
+    config_key_t tensor_layout            {"tensor_layout"};
+    config_key_t gemm_m_per_block         {"gemm_m_per_block"};
+    config_key_t gemm_n_per_block         {"gemm_n_per_block"};
+    config_key_t gemm_k_per_block         {"gemm_k_per_block"};
+    config_key_t gemm_m_per_thread        {"gemm_m_per_thread"};
+    config_key_t gemm_m_level0_cluster    {"gemm_m_level0_cluster"};
+    config_key_t gemm_m_level1_cluster    {"gemm_m_level1_cluster"};
+    config_key_t gemm_n_per_thread        {"gemm_n_per_thread"};
+    config_key_t gemm_n_level0_cluster    {"gemm_n_level0_cluster"};
+    config_key_t gemm_n_level1_cluster    {"gemm_n_level1_cluster"};
+    config_key_t wave_tile_m              {"wave_tile_m"};
+    config_key_t wave_step_m              {"wave_step_m"};
+    config_key_t wave_repeat_m            {"wave_repeat_m"};
+    config_key_t wave_tile_n              {"wave_tile_n"};
+    config_key_t wave_step_n              {"wave_step_n"};
+    config_key_t wave_repeat_n            {"wave_repeat_n"};
+    config_key_t wave_tile_k              {"wave_tile_k"};
+    config_key_t tensor_a_thread_lengths  {"tensor_a_thread_lengths"};
+    config_key_t tensor_a_cluster_lengths {"tensor_a_cluster_lengths"};
+    config_key_t tensor_b_thread_lengths  {"tensor_b_thread_lengths"};
+    config_key_t tensor_b_cluster_lengths {"tensor_b_cluster_lengths"};
+    config_key_t direction                {"direction"};
+    config_key_t precision                {"precision"};
+    config_key_t nxb                      {"nxb"};
+    config_key_t nxe                      {"nxe"};
+    config_key_t gemm_m_unmerge_cluster   {"gemm_m_unmerge_cluster"};
+    config_key_t gemm_n_unmerge_cluster   {"gemm_n_unmerge_cluster"};
+    config_key_t gemm_k_unmerge_cluster   {"gemm_k_unmerge_cluster"};
+    config_key_t multihead                {"multihead"};
+    config_key_t source_access_order      {"source_access_order"};
+    config_key_t gemm_k_global_split      {"gemm_k_global_split"};
+
+    static const igemm_gtc_tunable_keys_t &get() {
+        static igemm_gtc_tunable_keys_t keys;
+        return keys;
+    }
+};
+
+static inline bool igemm_gtc_is_tunable_section_name(std::string_view name)
+{
+    return name == "igemm_fwd_gtc" ||
+           name == "igemm_bwd_gtc" ||
+           name == "igemm_wrw_gtc";
+}
+
+template <typename section_t>
+static inline bool igemm_gtc_is_tunable_section(const section_t &sec)
+{
+    return igemm_gtc_is_tunable_section_name(sec.get_name());
+}
+
+/*
+* the schema of a tunable section, igemm_gtc_tunable_from_section() goes by: every key of a tunable
+* section, the member it lands in, its type, whether it is required and its
+* default otherwise. Fields of one fma group are only required, and only
+* copied into the union, when the section is of that group.
+*/
+enum class igemm_gtc_tunable_field_type_enum {
+    igemm_gtc_tunable_field_type_int,
+    igemm_gtc_tunable_field_type_string,
+    igemm_gtc_tunable_field_type_list_int,
+};
+
+enum class igemm_gtc_tunable_field_group_enum {
+    igemm_gtc_tunable_field_group_all,
+    igemm_gtc_tunable_field_group_mac,    // mac and dlops
+    igemm_gtc_tunable_field_group_xdlops,
+};
+
+struct igemm_gtc_tunable_field_t {
+    const char *name;
+    igemm_gtc_tunable_field_type_enum type;
+    igemm_gtc_tunable_field_group_enum group;
+    bool required;
+    int igemm_gtc_tunable_t::*int_member;
+    std::string igemm_gtc_tunable_t::*string_member;
+    std::vector<int> igemm_gtc_tunable_t::*list_member;
+    // defaults of optional fields, computed once every string field is bound
+    int (*int_default)(const igemm_gtc_tunable_t &);
+    const char *string_default;
+};
+
+static inline int igemm_gtc_tunable_default_zero(const igemm_gtc_tunable_t &) { return 0; }
+
+static inline int igemm_gtc_tunable_default_wave_tile_k(const igemm_gtc_tunable_t &tunable)
+{
+    if(tunable.precision == "fp16")
+        return 4;
+    if(tunable.precision == "bf16")
+        return 2;
+    return 1;
+}
+
+static inline int igemm_gtc_tunable_default_source_access_order(const igemm_gtc_tunable_t &tunable)
+{
+    return tunable.direction == "fwd" ? 1 : 0;
+}
+
+#define IGEMM_GTC_FIELD_INT(name, group, required, int_default) \
+    {#name, igemm_gtc_tunable_field_type_enum::igemm_gtc_tunable_field_type_int, \
+     igemm_gtc_tunable_field_group_enum::igemm_gtc_tunable_field_group_##group, required, \
+     &igemm_gtc_tunable_t::name, nullptr, nullptr, int_default, nullptr}
+#define IGEMM_GTC_FIELD_STRING(name, required, string_default) \
+    {#name, igemm_gtc_tunable_field_type_enum::igemm_gtc_tunable_field_type_string, \
+     igemm_gtc_tunable_field_group_enum::igemm_gtc_tunable_field_group_all, required, \
+     nullptr, &igemm_gtc_tunable_t::name, nullptr, nullptr, string_default}
+#define IGEMM_GTC_FIELD_LIST_INT(name) \
+    {#name, igemm_gtc_tunable_field_type_enum::igemm_gtc_tunable_field_type_list_int, \
+     igemm_gtc_tunable_field_group_enum::igemm_gtc_tunable_field_group_all, true, \
+     nullptr, nullptr, &igemm_gtc_tunable_t::name, nullptr, nullptr}
+
+static const igemm_gtc_tunable_field_t igemm_gtc_tunable_schema[] = {
+    IGEMM_GTC_FIELD_STRING(tensor_layout, false, "nchw"),
+    IGEMM_GTC_FIELD_INT(gemm_m_per_block, all, true, nullptr),
+    IGEMM_GTC_FIELD_INT(gemm_n_per_block, all, true, nullptr),
+    IGEMM_GTC_FIELD_INT(gemm_k_per_block, all, true, nullptr),
+    IGEMM_GTC_FIELD_STRING(precision, true, nullptr),
+    IGEMM_GTC_FIELD_INT(gemm_m_per_thread, mac, true, nullptr),
+    IGEMM_GTC_FIELD_INT(gemm_m_level0_cluster, mac, true, nullptr),
+    IGEMM_GTC_FIELD_INT(gemm_m_level1_cluster, mac, true, nullptr),
+    IGEMM_GTC_FIELD_INT(gemm_n_per_thread, mac, true, nullptr),
+    IGEMM_GTC_FIELD_INT(gemm_n_level0_cluster, mac, true, nullptr),
+    IGEMM_GTC_FIELD_INT(gemm_n_level1_cluster, mac, true, nullptr),
+    IGEMM_GTC_FIELD_INT(wave_tile_m, xdlops, true, nullptr),
+    IGEMM_GTC_FIELD_INT(wave_step_m, xdlops, true, nullptr),
+    IGEMM_GTC_FIELD_INT(wave_repeat_m, xdlops, true, nullptr),
+    IGEMM_GTC_FIELD_INT(wave_tile_n, xdlops, true, nullptr),
+    IGEMM_GTC_FIELD_INT(wave_step_n, xdlops, true, nullptr),
+    IGEMM_GTC_FIELD_INT(wave_repeat_n, xdlops, true, nullptr),
+    IGEMM_GTC_FIELD_INT(wave_tile_k, xdlops, false, igemm_gtc_tunable_default_wave_tile_k),
+    IGEMM_GTC_FIELD_LIST_INT(tensor_a_thread_lengths),
+    IGEMM_GTC_FIELD_LIST_INT(tensor_a_cluster_lengths),
+    IGEMM_GTC_FIELD_LIST_INT(tensor_b_thread_lengths),
+    IGEMM_GTC_FIELD_LIST_INT(tensor_b_cluster_lengths),
+    IGEMM_GTC_FIELD_STRING(direction, true, nullptr),
+    IGEMM_GTC_FIELD_INT(nxb, all, true, nullptr),
+    IGEMM_GTC_FIELD_INT(nxe, all, true, nullptr),
+    IGEMM_GTC_FIELD_INT(gemm_m_unmerge_cluster, all, false, igemm_gtc_tunable_default_zero),
+    IGEMM_GTC_FIELD_INT(gemm_n_unmerge_cluster, all, false, igemm_gtc_tunable_default_zero),
+    IGEMM_GTC_FIELD_INT(gemm_k_unmerge_cluster, all, false, igemm_gtc_tunable_default_zero),
+    IGEMM_GTC_FIELD_INT(multihead, all, false, igemm_gtc_tunable_default_zero),
+    IGEMM_GTC_FIELD_INT(source_access_order, all, false, igemm_gtc_tunable_default_source_access_order),
+    IGEMM_GTC_FIELD_INT(gemm_k_global_split, all, false, igemm_gtc_tunable_default_zero),
+};
+
+#undef IGEMM_GTC_FIELD_INT
+#undef IGEMM_GTC_FIELD_STRING
+#undef IGEMM_GTC_FIELD_LIST_INT
+
+static constexpr size_t igemm_gtc_tunable_num_fields =
+    sizeof(igemm_gtc_tunable_schema) / sizeof(igemm_gtc_tunable_schema[0]);
+
+// schema index of the field named 'name', -1 if there is none
+static inline int igemm_gtc_tunable_find_field(std::string_view name)
+{
+    for (size_t i = 0; i < igemm_gtc_tunable_num_fields; i++) {
+        if (name == igemm_gtc_tunable_schema[i].name)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+static inline size_t igemm_gtc_tunable_field_index(const char *name)
+{
+    int field = igemm_gtc_tunable_find_field(name);
+    assert(field >= 0);
+    return static_cast<size_t>(field);
+}
+
+// tunable and space sections written by 'writer' list their keys in schema order
+static inline void igemm_gtc_tunable_set_key_order(config_text_writer_t &writer)
+{
+    std::vector<config_key_t> keys;
+    for (size_t i = 0; i < igemm_gtc_tunable_num_fields; i++)
+        keys.emplace_back(igemm_gtc_tunable_schema[i].name);
+    for (const char *name : {"igemm_fwd_gtc", "igemm_bwd_gtc", "igemm_wrw_gtc"}) {
+        writer.set_key_order(name, keys);
+        writer.set_key_order(std::string(name) + "_space", keys);
+    }
+}
+
+/*
+* binds the key/value pairs of one tunable section into an igemm_gtc_tunable_t
+* as they are read, through the schema above. A key finds its field by its
+* interned id. String and list fields go straight into the tunable, int fields
+* wait in a flat array until finish() knows the fma group of the section.
+*/
+class igemm_gtc_tunable_binder_t {
+  public:
+    igemm_gtc_tunable_binder_t()
+        : field_gemm_m_per_thread(igemm_gtc_tunable_field_index("gemm_m_per_thread")),
+          field_gemm_n_per_thread(igemm_gtc_tunable_field_index("gemm_n_per_thread")),
+          field_wave_tile_m(igemm_gtc_tunable_field_index("wave_tile_m")),
+          field_wave_tile_n(igemm_gtc_tunable_field_index("wave_tile_n")),
+          seen(0), mistyped(0) {
+        static_assert(igemm_gtc_tunable_num_fields <= 64, "one bit per field in 'seen'");
+        for (size_t i = 0; i < igemm_gtc_tunable_num_fields; i++) {
+            uint32_t id = config_key_t(igemm_gtc_tunable_schema[i].name).get_id();
+            if (id >= field_of_key.size())
+                field_of_key.resize(id + 1, -1);
+            field_of_key[id] = static_cast<int>(i);
+            field_of_name.emplace(igemm_gtc_tunable_schema[i].name, static_cast<int>(i));
+        }
+    }
+
+    void begin() {
+        tunable = igemm_gtc_tunable_t();
+        seen = 0;
+        mistyped = 0;
+        errors.clear();
+    }
+
+    // keys out of the schema are ignored
+    void bind(config_key_t key, std::string_view raw_value) {
+        bind_raw(field_index(key), raw_value);
     }
-    return IGEMM_GTC_TUNABLE_FMA_TYPE_NA;
+    // straight from the text, without going through the key table
+    void bind(std::string_view key, std::string_view raw_value) {
+        auto it = field_of_name.find(key);
+        bind_raw(it == field_of_name.end() ? -1 : it->second, raw_value);
+    }
+    // already decoded value, from a parsed section or a compiled config
+    template <typename value_t>
+    void bind(config_key_t key, const value_t &value) {
+        int field = field_index(key);
+        if (field >= 0)
+            bind(field, value);
+    }
+
+    // by schema index, for a value already of the type of the field
+    void bind_int(size_t field, int value) {
+        if (claim(field))
+            int_values[field] = value;
+    }
+    void bind_string(size_t field, std::string_view value) {
+        if (claim(field))
+            tunable.*igemm_gtc_tunable_schema[field].string_member = value;
+    }
+    void bind_list_int(size_t field, config_value_span_t<int> value) {
+        if (claim(field))
+            (tunable.*igemm_gtc_tunable_schema[field].list_member).assign(value.begin(), value.end());
+    }
+
+    // complete the tunable: fma type, defaults, and the int fields of its group.
+    // False, with every missing or mistyped key listed in 'error', if it is incomplete.
+    bool finish(const std::string &arch_string, igemm_gtc_tunable_t &result, std::string &error) {
+        bool is_mac = has(field_gemm_m_per_thread) && has(field_gemm_n_per_thread);
+        if (is_mac)
+            tunable.fma_type = arch_string == "gfx900" ? IGEMM_GTC_TUNABLE_FMA_TYPE_MAC :
+                               arch_string == "gfx906" || arch_string == "gfx908" ? IGEMM_GTC_TUNABLE_FMA_TYPE_DLOPS :
+                               IGEMM_GTC_TUNABLE_FMA_TYPE_NA;
+        else if (has(field_wave_tile_m) && has(field_wave_tile_n))
+            tunable.fma_type = arch_string == "gfx908" ? IGEMM_GTC_TUNABLE_FMA_TYPE_XDLOPS : IGEMM_GTC_TUNABLE_FMA_TYPE_NA;
+        else
+            tunable.fma_type = IGEMM_GTC_TUNABLE_FMA_TYPE_NA;
+        if (tunable.fma_type == IGEMM_GTC_TUNABLE_FMA_TYPE_NA)
+            add_error("fma_type", ("no mac nor xdlops fields for arch " + arch_string).c_str());
+        igemm_gtc_tunable_field_group_enum group = is_mac ?
+            igemm_gtc_tunable_field_group_enum::igemm_gtc_tunable_field_group_mac :
+            igemm_gtc_tunable_field_group_enum::igemm_gtc_tunable_field_group_xdlops;
+
+        for (size_t i = 0; i < igemm_gtc_tunable_num_fields; i++) {
+            const igemm_gtc_tunable_field_t &f = igemm_gtc_tunable_schema[i];
+            if (f.group != igemm_gtc_tunable_field_group_enum::igemm_gtc_tunable_field_group_all && f.group != group)
+                continue;
+            if (has(i)) {
+                if (f.int_member)
+                    tunable.*f.int_member = int_values[i];
+            } else if (f.required) {
+                // a mistyped one is already reported, and there is no default to fall back to
+                if (!((mistyped >> i) & 1))
+                    add_error(f.name, "is missing");
+            } else if (f.string_member && f.string_default != nullptr) {
+                tunable.*f.string_member = f.string_default;
+            }
+        }
+        // int defaults may depend on the strings set above
+        for (size_t i = 0; i < igemm_gtc_tunable_num_fields; i++) {
+            const igemm_gtc_tunable_field_t &f = igemm_gtc_tunable_schema[i];
+            if ((f.group == igemm_gtc_tunable_field_group_enum::igemm_gtc_tunable_field_group_all || f.group == group) &&
+                !has(i) && f.int_default)
+                tunable.*f.int_member = f.int_default(tunable);
+        }
+        error = errors;
+        if (!errors.empty())
+            return false;
+        result = std::move(tunable);
+        return true;
+    }
+
+  private:
+    // fields deciding the fma group
+    size_t field_gemm_m_per_thread;
+    size_t field_gemm_n_per_thread;
+    size_t field_wave_tile_m;
+    size_t field_wave_tile_n;
+
+    std::vector<int> field_of_key;  // schema index by interned key id, -1 if none
+    std::unordered_map<std::string_view, int> field_of_name;
+    igemm_gtc_tunable_t tunable;
+    int int_values[igemm_gtc_tunable_num_fields];
+    uint64_t seen;                  // one bit per field bound
+    uint64_t mistyped;              // one bit per field with a value of the wrong type
+    std::string errors;
+
+    void bind_raw(int field, std::string_view raw_value) {
+        if (field < 0)
+            return;
+        try {
+            bind(field, config_section_value_t::parse_value(raw_value));
+        } catch (const std::invalid_argument &) {
+            add_error(igemm_gtc_tunable_schema[field].name, "can not be parsed");
+            mistyped |= uint64_t(1) << field;
+        }
+    }
+    bool has(size_t field) const { return (seen >> field) & 1; }
+    int field_index(config_key_t key) const {
+        return key.get_id() < field_of_key.size() ? field_of_key[key.get_id()] : -1;
+    }
+    void add_error(const char *name, const char *what) {
+        if (!errors.empty())
+            errors += ", ";
+        errors += name;
+        errors += " ";
+        errors += what;
+    }
+
+    template <typename value_t>
+    void bind(int field, const value_t &value) {
+        const igemm_gtc_tunable_field_t &f = igemm_gtc_tunable_schema[field];
+        config_section_value_type_enum type = value.get_type();
+        const char *mismatch = NULL;
+        if (f.type == igemm_gtc_tunable_field_type_enum::igemm_gtc_tunable_field_type_int &&
+                 type != config_section_value_type_enum::config_section_value_type_int)
+            mismatch = "expects an int";
+        else if (f.type == igemm_gtc_tunable_field_type_enum::igemm_gtc_tunable_field_type_string &&
+                 type != config_section_value_type_enum::config_section_value_type_string)
+            mismatch = "expects a string";
+        else if (f.type == igemm_gtc_tunable_field_type_enum::igemm_gtc_tunable_field_type_list_int &&
+                 type != config_section_value_type_enum::config_section_value_type_list_int)
+            mismatch = "expects a list of int";
+        if (mismatch) {
+            add_error(f.name, mismatch);
+            mistyped |= uint64_t(1) << field;
+            return;
+        }
+        if (f.int_member)
+            bind_int(field, value.get_int());
+        else if (f.string_member)
+            bind_string(field, value.get_string_view());
+        else
+            bind_list_int(field, value.get_list_int_view());
+    }
+    bool claim(size_t field) {
+        if (has(field)) {
+            add_error(igemm_gtc_tunable_schema[field].name, "is duplicated");
+            mistyped |= uint64_t(1) << field;
+            return false;
+        }
+        seen |= uint64_t(1) << field;
+        return true;
+    }
+};
+
+// a tunable section, config_section_t or a config_binary_section_view_t of a
+// compiled config, through igemm_gtc_tunable_binder_t. An incomplete section is
+// fatal, reported with every key it misses or holds mistyped.
+template <typename section_t>
+static inline igemm_gtc_tunable_t
+igemm_gtc_tunable_from_section(const std::string &arch_string, const section_t &sec)
+{
+    static thread_local igemm_gtc_tunable_binder_t binder;
+    binder.begin();
+    for (size_t i = 0; i < sec.size(); i++)
+        binder.bind(sec.key(i), sec.value(i));
+    igemm_gtc_tunable_t tunable;
+    std::string error;
+    if (!binder.finish(arch_string, tunable, error)) {
+        printf("section [%.*s]: %s\n", (int)sec.get_name().size(), sec.get_name().data(), error.c_str());
+        exit(-1);
+    }
+    return tunable;
 }
 
+typedef std::function<void(igemm_gtc_tunable_t &&)> igemm_gtc_tunable_callback_t;
+typedef std::function<bool(const igemm_gtc_tunable_t &)> igemm_gtc_tunable_filter_t;
+
+// [igemm_fwd_gtc_space] and the like, see igemm_gtc_tunable_space_t
+static inline bool igemm_gtc_is_tunable_space_name(std::string_view name)
+{
+    const std::string_view suffix("_space");
+    return name.size() > suffix.size() && name.substr(name.size() - suffix.size()) == suffix &&
+           igemm_gtc_is_tunable_section_name(name.substr(0, name.size() - suffix.size()));
+}
+
+/*
+* search space section, e.g. [igemm_bwd_gtc_space]. It has the keys of a tunable
+* section, but an int key may be a list or a range of candidates, and a string
+* key a list of strings. A list key holds one list, whose single elements can
+* take candidates through '<key>.<index>':
+*
+*   gemm_k_per_block           = [8, 16, 32]
+*   wave_repeat_m              = (1, 3)
+*   tensor_b_cluster_lengths   = [1, 4, 1, 64]
+*   tensor_b_cluster_lengths.3 = [32, 64, 128]
+*
+* the space is the cartesian product of the candidates of every key, in key
+* order with the last key varying fastest. It is expanded one tunable at a time
+* through igemm_gtc_tunable_binder_t, nothing is materialized.
+*/
+class igemm_gtc_tunable_space_t {
+  public:
+    // false, with the reason in 'error', if 'sec' is not a valid space
+    template <typename section_t>
+    bool build(const section_t &sec, std::string &error) {
+        axes.clear();
+        num_candidates = 1;
+        for (size_t i = 0; i < sec.size(); i++) {
+            const std::string &name = sec.key(i).str();
+            auto value = sec.value(i);
+            axis_t axis;
+            size_t dot = name.rfind('.');
+            int field = igemm_gtc_tunable_find_field(dot == std::string::npos ? name : name.substr(0, dot));
+            if (field < 0) {
+                error = name + " is not a tunable key";
+                return false;
+            }
+            axis.field = static_cast<size_t>(field);
+            const igemm_gtc_tunable_field_t &f = igemm_gtc_tunable_schema[field];
+            if (dot != std::string::npos) {
+                axis.element = atoi(name.c_str() + dot + 1);
+                if (f.type != igemm_gtc_tunable_field_type_enum::igemm_gtc_tunable_field_type_list_int ||
+                    !find_list(axis.field) || axis.element < 0 ||
+                    axis.element >= (int)find_list(axis.field)->list.size()) {
+                    error = name + " is not an element of a list given before";
+                    return false;
+                }
+            }
+            bool ok;
+            if (f.type == igemm_gtc_tunable_field_type_enum::igemm_gtc_tunable_field_type_string)
+                ok = add_strings(axis, value);
+            else if (f.type == igemm_gtc_tunable_field_type_enum::igemm_gtc_tunable_field_type_list_int && axis.element < 0)
+                ok = add_list(axis, value);
+            else
+                ok = add_ints(axis, value);
+            if (!ok) {
+                error = name + " has a value of the wrong type";
+                return false;
+            }
+            if (axis.size() != 0 && num_candidates > max_candidates / axis.size()) {
+                error = "too many candidates";
+                return false;
+            }
+            num_candidates *= axis.size();
+            axes.push_back(std::move(axis));
+        }
+        return true;
+    }
+
+    // candidates, before filtering
+    uint64_t size() const { return num_candidates; }
+    void add_filter(const igemm_gtc_tunable_filter_t &filter) { filters.push_back(filter); }
+
+    // every candidate passing the filters, in space order. False, with what the
+    // tunables miss in 'error', if the candidates are not complete tunables.
+    bool expand(const std::string &arch_string, const igemm_gtc_tunable_callback_t &on_tunable, std::string &error) const {
+        if (num_candidates == 0)
+            return true;
+        igemm_gtc_tunable_binder_t binder;
+        igemm_gtc_tunable_t tunable;
+        std::vector<size_t> index(axes.size(), 0);
+        std::vector<std::vector<int>> lists(igemm_gtc_tunable_num_fields);
+        for (;;) {
+            binder.begin();
+            for (size_t a = 0; a < axes.size(); a++) {
+                const axis_t &axis = axes[a];
+                if (!axis.strings.empty())
+                    binder.bind_string(axis.field, axis.strings[index[a]]);
+                else if (!axis.list.empty())
+                    lists[axis.field] = axis.list;
+                else if (axis.element >= 0)
+                    lists[axis.field][axis.element] = axis.int_at(index[a]);
+                else
+                    binder.bind_int(axis.field, axis.int_at(index[a]));
+            }
+            for (const axis_t &axis : axes) {
+                if (!axis.list.empty())
+                    binder.bind_list_int(axis.field, lists[axis.field]);
+            }
+            if (!binder.finish(arch_string, tunable, error))
+                return false;
+            bool pass = true;
+            for (const auto &filter : filters)
+                pass = pass && filter(tunable);
+            if (pass)
+                on_tunable(std::move(tunable));
+
+            size_t a = axes.size();
+            while (a > 0 && ++index[a - 1] == axes[a - 1].size())
+                index[--a] = 0;
+            if (a == 0)
+                return true;
+        }
+    }
+
+  private:
+    static constexpr uint64_t max_candidates = uint64_t(1) << 48;
+
+    // candidates of one key: strings, ints (as a list or a lazy range), or one fixed list
+    struct axis_t {
+        size_t field = 0;
+        int element = -1;       // index in a list field, -1 for the whole field
+        std::vector<std::string> strings;
+        std::vector<int> ints;
+        config_value_range_t range;
+        std::vector<int> list;
+
+        size_t size() const {
+            return !strings.empty() ? strings.size() : !ints.empty() ? ints.size() : !list.empty() ? 1 : range.size();
+        }
+        int int_at(size_t i) const { return !ints.empty() ? ints[i] : range[i]; }
+    };
+
+    std::vector<axis_t> axes;
+    std::vector<igemm_gtc_tunable_filter_t> filters;
+    uint64_t num_candidates = 0;
+
+    const axis_t *find_list(size_t field) const {
+        for (const auto &axis : axes) {
+            if (axis.field == field && !axis.list.empty())
+                return &axis;
+        }
+        return NULL;
+    }
+    template <typename value_t>
+    static bool add_strings(axis_t &axis, const value_t &value) {
+        if (value.get_type() == config_section_value_type_enum::config_section_value_type_string)
+            axis.strings.emplace_back(value.get_string_view());
+        else if (value.get_type() == config_section_value_type_enum::config_section_value_type_list_string)
+            axis.strings = value.get_list_string();
+        else
+            return false;
+        return true;
+    }
+    template <typename value_t>
+    static bool add_list(axis_t &axis, const value_t &value) {
+        if (value.get_type() != config_section_value_type_enum::config_section_value_type_list_int ||
+            value.get_list_int_view().empty())
+            return false;
+        axis.list = value.get_list_int_view().to_vector();
+        return true;
+    }
+    template <typename value_t>
+    static bool add_ints(axis_t &axis, const value_t &value) {
+        if (value.get_type() == config_section_value_type_enum::config_section_value_type_int)
+            axis.ints.push_back(value.get_int());
+        else if (value.get_type() == config_section_value_type_enum::config_section_value_type_list_int)
+            axis.ints = value.get_list_int_view().to_vector();
+        else if (value.get_type() == config_section_value_type_enum::config_section_value_type_range)
+            axis.range = value.get_range();
+        else
+            return false;
+        return true;
+    }
+};
+
+// expands the space section 'sec' into 'on_tunable', a broken space is fatal
+template <typename section_t>
+static inline void
+igemm_gtc_tunable_expand_space(const std::string &arch_string, const section_t &sec,
+                               const igemm_gtc_tunable_callback_t &on_tunable,
+                               const igemm_gtc_tunable_filter_t &filter = nullptr)
+{
+    igemm_gtc_tunable_space_t space;
+    std::string error;
+    if (filter)
+        space.add_filter(filter);
+    if (!space.build(sec, error) || !space.expand(arch_string, on_tunable, error)) {
+        printf("space section [%.*s]: %s\n", (int)sec.get_name().size(), sec.get_name().data(), error.c_str());
+        exit(-1);
+    }
+}
+
+// binds the tunable sections of 'buffer' while config_line_scanner_t reads it,
+// no section dictionary is ever built. Tunable sections showing up before
+// [codegen] are held back until the arch is known. Every incomplete section is
+// reported with what it misses, and then false is returned. Space sections are
+// small, they are gathered into a config_section_t and expanded at their end.
+static inline bool
+igemm_gtc_tunable_bind_buffer(std::string_view buffer, const igemm_gtc_tunable_callback_t &on_tunable)
+{
+    static const config_key_t arch_key("arch");
+    igemm_gtc_tunable_binder_t binder;
+    std::string arch_string;
+    bool has_codegen = false;
+    bool ok = true;
+    struct pending_section_t {
+        size_t offset;
+        std::string_view name;
+        igemm_gtc_tunable_binder_t binder;
+    };
+    std::vector<pending_section_t> pending;
+    std::vector<config_section_t> pending_spaces;
+    config_section_t space("");
+    enum { no_section, codegen_section, tunable_section, space_section, other_section } current = no_section;
+    size_t section_offset = 0;
+    std::string_view section_name;
+
+    auto finish = [&](igemm_gtc_tunable_binder_t &b, size_t offset, std::string_view name) {
+        igemm_gtc_tunable_t tunable;
+        std::string error;
+        if (b.finish(arch_string, tunable, error)) {
+            on_tunable(std::move(tunable));
+        } else {
+            printf("section [%.*s] at byte %zu: %s\n", (int)name.size(), name.data(), offset, error.c_str());
+            ok = false;
+        }
+    };
+    auto end_section = [&]() {
+        if (current == space_section) {
+            if (has_codegen)
+                igemm_gtc_tunable_expand_space(arch_string, space, on_tunable);
+            else
+                pending_spaces.push_back(std::move(space));
+        }
+        if (current != tunable_section)
+            return;
+        if (has_codegen)
+            finish(binder, section_offset, section_name);
+        else
+            pending.push_back({section_offset, section_name, binder});
+    };
+
+    config_line_scanner_t scanner(buffer);
+    config_line_t line;
+    while (scanner.next(line)) {
+        switch (line.kind) {
+        case config_line_kind_enum::config_line_kind_blank:
+            break;
+        case config_line_kind_enum::config_line_kind_section:
+            end_section();
+            section_offset = line.offset;
+            section_name = line.key;
+            if (!has_codegen && line.key == "codegen") {
+                current = codegen_section;
+            } else if (igemm_gtc_is_tunable_section_name(line.key)) {
+                current = tunable_section;
+                binder.begin();
+            } else if (igemm_gtc_is_tunable_space_name(line.key)) {
+                current = space_section;
+                space = config_section_t(line.key);
+            } else {
+                current = other_section;
+            }
+            break;
+        case config_line_kind_enum::config_line_kind_key_value:
+            if (current == no_section) {
+                printf("no current section, should not happen\n");
+                exit(-1);
+            }
+            if (current == tunable_section) {
+                binder.bind(line.key, line.value);
+            } else if (current == space_section) {
+                space.at(config_key_t(line.key)) = config_section_value_t::parse_value(line.value);
+            } else if (current == codegen_section && config_key_t::find(line.key) == arch_key) {
+                arch_string = config_section_value_t::parse_value(line.value).get_string();
+                has_codegen = true;
+                for (auto &p : pending)
+                    finish(p.binder, p.offset, p.name);
+                pending.clear();
+                for (const auto &s : pending_spaces)
+                    igemm_gtc_tunable_expand_space(arch_string, s, on_tunable);
+                pending_spaces.clear();
+            }
+            break;
+        default:
+            printf("fail to parse current line:%.*s, not enough tokens\n",
+                   (int)line.text.length(), line.text.data());
+            exit(-1);
+        }
+    }
+    end_section();
+    if (!pending.empty() || !pending_spaces.empty()) {
+        printf("%zu tunable sections but no arch in [codegen]\n", pending.size() + pending_spaces.size());
+        ok = false;
+    }
+    return ok;
+}
+
+// 'content_t' is config_content_t or config_binary_reader_t. Space sections are
+// expanded in place, and only the tunables passing 'filter' (if any) are kept.
+template <typename content_t>
 static inline std::vector<igemm_gtc_tunable_t>
-igemm_gtc_tunable_from_config(const config_content_t &content)
+igemm_gtc_tunable_from_config(const content_t &content, const igemm_gtc_tunable_filter_t &filter = nullptr)
 {
     std::vector<igemm_gtc_tunable_t> tunables;
-    config_section_t codegen_sec = content.get_section("codegen");
+    const auto &codegen_sec = content.get_section("codegen");
     assert(codegen_sec.get_name() == "codegen");
+    std::string arch_string = codegen_sec.at("arch").get_string();
+    auto on_tunable = [&](igemm_gtc_tunable_t &&tunable) { tunables.push_back(std::move(tunable)); };
     for (const auto &sec : content) {
-        if (sec.get_name() == "igemm_fwd_gtc" ||
-            sec.get_name() == "igemm_bwd_gtc" || 
-            sec.get_name() == "igemm_wrw_gtc")
-        {
-            igemm_gtc_tunable_t tunable;
-            tunable.tensor_layout            = sec.count("tensor_layout") > 0 ? sec.at("tensor_layout").get_string() : "nchw";
-            tunable.gemm_m_per_block         = sec.at("gemm_m_per_block").get_int();
-            tunable.gemm_n_per_block         = sec.at("gemm_n_per_block").get_int();
-            tunable.gemm_k_per_block         = sec.at("gemm_k_per_block").get_int();
-            tunable.fma_type                 = get_igemm_gtc_fma_type(codegen_sec.at("arch").get_string(), sec);
-            tunable.precision                = sec.at("precision").get_string();
-            assert(tunable.fma_type != IGEMM_GTC_TUNABLE_FMA_TYPE_NA);
-            if(tunable.fma_type == IGEMM_GTC_TUNABLE_FMA_TYPE_MAC || tunable.fma_type == IGEMM_GTC_TUNABLE_FMA_TYPE_DLOPS){
-                tunable.gemm_m_per_thread        = sec.at("gemm_m_per_thread").get_int();
-                tunable.gemm_m_level0_cluster    = sec.at("gemm_m_level0_cluster").get_int();
-                tunable.gemm_m_level1_cluster    = sec.at("gemm_m_level1_cluster").get_int();
-                tunable.gemm_n_per_thread        = sec.at("gemm_n_per_thread").get_int();
-                tunable.gemm_n_level0_cluster    = sec.at("gemm_n_level0_cluster").get_int();
-                tunable.gemm_n_level1_cluster    = sec.at("gemm_n_level1_cluster").get_int();
-            }else{
-                tunable.wave_tile_m              = sec.at("wave_tile_m").get_int();
-                tunable.wave_step_m              = sec.at("wave_step_m").get_int();
-                tunable.wave_repeat_m            = sec.at("wave_repeat_m").get_int();
-                tunable.wave_tile_n              = sec.at("wave_tile_n").get_int();
-                tunable.wave_step_n              = sec.at("wave_step_n").get_int();
-                tunable.wave_repeat_n            = sec.at("wave_repeat_n").get_int();
-                if(tunable.precision == "fp32")
-                    tunable.wave_tile_k          = sec.count("wave_tile_k") > 0 ? sec.at("wave_tile_k").get_int() : 1;
-                else if(tunable.precision == "fp16")
-                    tunable.wave_tile_k          = sec.count("wave_tile_k") > 0 ? sec.at("wave_tile_k").get_int() : 4;
-                else if(tunable.precision == "bf16")
-                    tunable.wave_tile_k          = sec.count("wave_tile_k") > 0 ? sec.at("wave_tile_k").get_int() : 2;
-                else
-                    tunable.wave_tile_k          = sec.count("wave_tile_k") > 0 ? sec.at("wave_tile_k").get_int() : 1;
-                
-            }
-            tunable.tensor_a_thread_lengths  = sec.at("tensor_a_thread_lengths").get_list_int();
-            tunable.tensor_a_cluster_lengths = sec.at("tensor_a_cluster_lengths").get_list_int();
-            tunable.tensor_b_thread_lengths  = sec.at("tensor_b_thread_lengths").get_list_int();
-            tunable.tensor_b_cluster_lengths = sec.at("tensor_b_cluster_lengths").get_list_int();
-            tunable.direction                = sec.at("direction").get_string();
-            //tunable.precision                = sec.at("precision").get_string();
-            tunable.nxb                      = sec.at("nxb").get_int();
-            tunable.nxe                      = sec.at("nxe").get_int();
-            tunable.gemm_m_unmerge_cluster   = sec.count("gemm_m_unmerge_cluster") > 0 ? sec.at("gemm_m_unmerge_cluster").get_int() : 0;
-            tunable.gemm_n_unmerge_cluster   = sec.count("gemm_n_unmerge_cluster") > 0 ? sec.at("gemm_n_unmerge_cluster").get_int() : 0;
-            tunable.gemm_k_unmerge_cluster   = sec.count("gemm_k_unmerge_cluster") > 0 ? sec.at("gemm_k_unmerge_cluster").get_int() : 0;
-            tunable.multihead                = sec.count("multihead") > 0 ? sec.at("multihead").get_int() : 0;
-            int default_source_access_order  = tunable.direction == "fwd" ? 1 : 0;
-            tunable.source_access_order      = sec.count("source_access_order") > 0 ? sec.at("source_access_order").get_int() : default_source_access_order;
-            tunable.gemm_k_global_split      = sec.count("gemm_k_global_split") > 0 ? sec.at("gemm_k_global_split").get_int() : 0;
-
-            tunables.push_back(tunable);
+        if (igemm_gtc_is_tunable_section(sec)) {
+            igemm_gtc_tunable_t tunable = igemm_gtc_tunable_from_section(arch_string, sec);
+            if (!filter || filter(tunable))
+                tunables.push_back(std::move(tunable));
+        } else if (igemm_gtc_is_tunable_space_name(sec.get_name())) {
+            igemm_gtc_tunable_expand_space(arch_string, sec, on_tunable, filter);
         }
     }
     return tunables;
 }
 
+// streaming flavor of the above, every tunable section is converted as soon as
+// the parser completes it, so no config_content_t is ever built. Tunable and
+// space sections showing up before [codegen] are held back until the arch is known.
+static inline void
+igemm_gtc_tunable_from_config(config_parser_t &parser, const igemm_gtc_tunable_callback_t &on_tunable,
+                              const igemm_gtc_tunable_filter_t &filter = nullptr)
+{
+    std::string arch_string;
+    bool has_codegen = false;
+    std::vector<config_section_t> pending_sections;
+
+    auto convert = [&](const config_section_t &sec) {
+        if (igemm_gtc_is_tunable_space_name(sec.get_name())) {
+            igemm_gtc_tunable_expand_space(arch_string, sec, on_tunable, filter);
+            return;
+        }
+        igemm_gtc_tunable_t tunable = igemm_gtc_tunable_from_section(arch_string, sec);
+        if (!filter || filter(tunable))
+            on_tunable(std::move(tunable));
+    };
+    parser.parse_sections([&](config_section_t &&sec) {
+        if (!has_codegen && sec.get_name() == "codegen") {
+            arch_string = sec.at("arch").get_string();
+            has_codegen = true;
+            for (const auto &pending : pending_sections)
+                convert(pending);
+            pending_sections.clear();
+        }
+        else if (igemm_gtc_is_tunable_section(sec) || igemm_gtc_is_tunable_space_name(sec.get_name())) {
+            if (has_codegen)
+                convert(sec);
+            else
+                pending_sections.push_back(std::move(sec));
+        }
+    });
+    assert(has_codegen);
+}
+
+static inline std::vector<igemm_gtc_tunable_t>
+igemm_gtc_tunable_from_config(config_parser_t &parser, const igemm_gtc_tunable_filter_t &filter = nullptr)
+{
+    std::vector<igemm_gtc_tunable_t> tunables;
+    igemm_gtc_tunable_from_config(parser, [&](igemm_gtc_tunable_t &&tunable) {
+        tunables.push_back(std::move(tunable));
+    }, filter);
+    return tunables;
+}
+
+// tunables of a text config, read through its compiled '<config_file>.bin' cache
+// (see config_binary_cache_t). The text is only parsed when the cache is missing
+// or stale, in which case the cache is refreshed for the next run.
+static inline std::vector<igemm_gtc_tunable_t>
+igemm_gtc_tunable_load(const std::string &config_file, const igemm_gtc_tunable_filter_t &filter = nullptr)
+{
+    config_binary_reader_t reader;
+    config_binary_cache_t(config_file).open(reader);
+    return igemm_gtc_tunable_from_config(reader, filter);
+}
+
 #endif
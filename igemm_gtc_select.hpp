@@ -0,0 +1,638 @@
+/*******************************************************************************
+ *
+ * MIT License
+ *
+ * Copyright (c) 2020 Advanced Micro Devices, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef __IGEMM_GTC_SELECT_HPP__
+#define __IGEMM_GTC_SELECT_HPP__
+
+#include <algorithm>
+#include <charconv>
+#include <limits>
+#include <stdexcept>
+#include <stdint.h>
+#include <string.h>
+#include <string_view>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "igemm_gtc_base.hpp"
+#include "utility.hpp"
+
+/*
+* a convolution problem, as the runtime picking a tunable out of an ordered list
+* (see reorder_configs_*) describes it. hi/wi are the sizes of the input, the
+* output sizes follow from the filter, strides, pads and dilations.
+*/
+struct igemm_gtc_conv_problem_t {
+    int n = 1;
+    int c = 1;
+    int hi = 1;
+    int wi = 1;
+    int k = 1;
+    int y = 1;
+    int x = 1;
+    int stride_h = 1;
+    int stride_w = 1;
+    int pad_h = 0;
+    int pad_w = 0;
+    int dilation_h = 1;
+    int dilation_w = 1;
+    int group = 1;
+    igemm_gtc_direction_enum direction = igemm_gtc_direction_enum::fwd;
+    igemm_gtc_tensor_layout_enum tensor_layout = igemm_gtc_tensor_layout_enum::nchw;
+    igemm_gtc_precision_enum precision = igemm_gtc_precision_enum::fp32;
+
+    // 0 when the filter does not fit in the padded input
+    int get_ho() const { return output_size(hi, y, stride_h, pad_h, dilation_h); }
+    int get_wo() const { return output_size(wi, x, stride_w, pad_w, dilation_w); }
+    bool is_unit_conv() const {
+        return y == 1 && x == 1 && stride_h == 1 && stride_w == 1 && dilation_h == 1 && dilation_w == 1 &&
+               pad_h == 0 && pad_w == 0;
+    }
+
+    // what makes the problem impossible, nullptr if nothing does
+    const char *check() const {
+        if (n <= 0 || c <= 0 || hi <= 0 || wi <= 0 || k <= 0 || y <= 0 || x <= 0)
+            return "a size not positive";
+        if (stride_h <= 0 || stride_w <= 0 || dilation_h <= 0 || dilation_w <= 0 || group <= 0)
+            return "a stride, dilation or group count not positive";
+        if (pad_h < 0 || pad_w < 0)
+            return "a negative pad";
+        if (c % group != 0 || k % group != 0)
+            return "channels not divisible by the group count";
+        if (get_ho() <= 0 || get_wo() <= 0)
+            return "a filter larger than the padded input";
+        return nullptr;
+    }
+
+  private:
+    static int output_size(int i, int f, int stride, int pad, int dilation) {
+        int span = i + 2 * pad - dilation * (f - 1) - 1;
+        return span < 0 ? 0 : span / stride + 1;
+    }
+};
+
+/*
+* the values of a problem the tunables put divisibility conditions on, and its
+* flags. gemm_m/n/k depend on the direction and layout:
+*   fwd nchw    gemm_m = k / group, gemm_n = n * b, gemm_k = c / group * y * x,
+*               b = ho * wo
+*   bwd nchw    gemm_m = c / group, gemm_n = n * b, gemm_k = k / group * y_dot * x_dot,
+*               b = h_tilda_slice * w_tilda_slice
+*   bwd nhwc    gemm_m = n * b, gemm_n = c / group, gemm_k = k / group * y_dot * x_dot
+* where b is padded to a multiple of nxb when nxe != 0. Backward data with
+* strides is cut into y_tilda * x_tilda gemms of their own y/x dot slices, their
+* gemm_k differ and the gcd of them is kept, a tunable has to divide them all.
+* spatial is ho * wo, unpadded.
+*/
+enum igemm_gtc_problem_value_enum {
+    igemm_gtc_problem_value_gemm_m = 0,
+    igemm_gtc_problem_value_gemm_n,
+    igemm_gtc_problem_value_gemm_k,
+    igemm_gtc_problem_value_n,
+    igemm_gtc_problem_value_spatial,
+    igemm_gtc_problem_value_c_per_group,
+    igemm_gtc_problem_value_k_per_group,
+    igemm_gtc_problem_num_values,
+};
+
+static const char *const igemm_gtc_problem_value_names[] = {
+    "gemm_m", "gemm_n", "gemm_k", "n", "spatial", "c_per_group", "k_per_group",
+};
+
+enum igemm_gtc_problem_flag_enum {
+    igemm_gtc_problem_flag_unit_conv = 1,      // 1x1 filter, strides and dilations of 1, no pad
+    igemm_gtc_problem_flag_unit_filter = 2,    // 1x1 filter
+};
+
+struct igemm_gtc_problem_gemm_t {
+    uint32_t values[igemm_gtc_problem_num_values];
+    uint32_t flags;
+};
+
+// the y (or x) dot slices of the y_tilda gemms of backward data, their gcd in 'dot_gcd'
+static inline bool igemm_gtc_bwd_tilda(int i, int o, int f, int stride, int pad, int dilation, int &tilda_slice,
+                                       int &dot_gcd)
+{
+    int f_tilda = stride / utility_gcd(stride, dilation);
+    int o_tilda = o + utility_integer_divide_ceil(dilation * (f - 1), stride);
+    int f_dot = utility_integer_divide_ceil(f, f_tilda);
+    int o_tilda_left = std::max(0, pad - dilation * (f_tilda - 1)) / stride;
+    int o_tilda_right = std::min(o_tilda, utility_integer_divide_ceil(pad + i - 1, stride) + 1);
+    tilda_slice = o_tilda_right - o_tilda_left;
+    dot_gcd = 0;
+    for (int i_tilda = 0; i_tilda < f_tilda; i_tilda++) {
+        int f_dot_slice = (i_tilda + 1) * f_dot <= f ? f_dot : f % f_dot;
+        if (f_dot_slice > 0)
+            dot_gcd = utility_gcd(dot_gcd, f_dot_slice);
+    }
+    return tilda_slice > 0 && dot_gcd > 0;
+}
+
+// false when no tunable of nxe, nxb can take 'problem', or the direction and layout are not handled
+static inline bool igemm_gtc_problem_gemm(const igemm_gtc_conv_problem_t &problem, int nxe, int nxb,
+                                          igemm_gtc_problem_gemm_t &gemm)
+{
+    const igemm_gtc_conv_problem_t &p = problem;
+    if (nxb <= 0 || p.check() != nullptr)
+        return false;
+    int ho = p.get_ho();
+    int wo = p.get_wo();
+
+    uint64_t c_per_group = p.c / p.group;
+    uint64_t k_per_group = p.k / p.group;
+    uint64_t b, gemm_m, gemm_n, gemm_k;
+    if (p.direction == igemm_gtc_direction_enum::fwd && p.tensor_layout == igemm_gtc_tensor_layout_enum::nchw) {
+        b = uint64_t(ho) * wo;
+        if (nxe != 0)
+            b = utility_integer_divide_ceil<uint64_t>(b, nxb) * nxb;
+        gemm_m = k_per_group;
+        gemm_n = p.n * b;
+        gemm_k = c_per_group * p.y * p.x;
+    } else if (p.direction == igemm_gtc_direction_enum::bwd) {
+        int h_tilda_slice, w_tilda_slice, y_dot_gcd, x_dot_gcd;
+        if (!igemm_gtc_bwd_tilda(p.hi, ho, p.y, p.stride_h, p.pad_h, p.dilation_h, h_tilda_slice, y_dot_gcd) ||
+            !igemm_gtc_bwd_tilda(p.wi, wo, p.x, p.stride_w, p.pad_w, p.dilation_w, w_tilda_slice, x_dot_gcd))
+            return false;
+        b = uint64_t(h_tilda_slice) * w_tilda_slice;
+        gemm_k = k_per_group * y_dot_gcd * x_dot_gcd;
+        if (p.tensor_layout == igemm_gtc_tensor_layout_enum::nchw) {
+            if (nxe != 0)
+                b = utility_integer_divide_ceil<uint64_t>(b, nxb) * nxb;
+            gemm_m = c_per_group;
+            gemm_n = p.n * b;
+        } else {
+            gemm_m = p.n * b;
+            gemm_n = c_per_group;
+        }
+    } else {
+        return false;
+    }
+
+    uint64_t values[igemm_gtc_problem_num_values] = {gemm_m, gemm_n, gemm_k, uint64_t(p.n), uint64_t(ho) * wo,
+                                                     c_per_group, k_per_group};
+    for (int v = 0; v < igemm_gtc_problem_num_values; v++) {
+        if (values[v] > std::numeric_limits<uint32_t>::max())
+            return false;
+        gemm.values[v] = static_cast<uint32_t>(values[v]);
+    }
+    gemm.flags = (p.is_unit_conv() ? igemm_gtc_problem_flag_unit_conv : 0) |
+                 (p.y == 1 && p.x == 1 ? igemm_gtc_problem_flag_unit_filter : 0);
+    return true;
+}
+
+/*
+* what a tunable asks of a problem: every value divisible by its divisor (the
+* lcm of the conditions on it, 1 for none) and the flags set. From the thread
+* and cluster lengths as the generators lay them out:
+*   all         gemm_m, gemm_n and gemm_k divisible by the per block sizes (not
+*               for bwd nhwc, whose kernel masks the m and n edges), nxe == 0
+*               only for unit convolutions, with ho * wo divisible by nxb, and
+*               for nchw, n divisible by unmerge_sub_n = gemm_n_per_block / nxb
+*   fwd nchw    tb_n1b > 1 is a vector load along ho * wo of the input, for unit
+*               convolutions only and not across images; tb_c1e > 1 walks c
+*               within e, for 1x1 filters only; ta_c1e divides gemm_k
+*   bwd nchw    ta_c1 > 1 is a vector load along c of the weight, for 1x1
+*               filters only; tb_n1b > 1 as for fwd
+*   bwd nhwc    k / group divisible by gemm_k_per_block, so a gemm_k step does
+*               not cross a filter position, and by the k1 vector of the output
+*               gradient; c / group divisible by the c1 vector of the weight
+* False for a tunable no problem can take, and for directions and layouts not
+* handled (wrw, fwd nhwc).
+*/
+struct igemm_gtc_tunable_constraints_t {
+    uint32_t divisors[igemm_gtc_problem_num_values];
+    uint32_t flags;
+};
+
+static inline bool igemm_gtc_tunable_constraints(const igemm_gtc_packed_tunable_t &tunable,
+                                                 igemm_gtc_tunable_constraints_t &constraints)
+{
+    for (int v = 0; v < igemm_gtc_problem_num_values; v++)
+        constraints.divisors[v] = 1;
+    constraints.flags = 0;
+    bool ok = true;
+    auto divisible = [&](int value, uint32_t divisor) {
+        if (divisor == 0) {
+            ok = false;
+            return;
+        }
+        uint64_t lcm = uint64_t(constraints.divisors[value]) / utility_gcd(constraints.divisors[value], divisor) * divisor;
+        if (lcm > std::numeric_limits<uint32_t>::max())
+            ok = false;
+        else
+            constraints.divisors[value] = static_cast<uint32_t>(lcm);
+    };
+    const auto &ta = tunable.tensor_a_thread_lengths;
+    const auto &tb = tunable.tensor_b_thread_lengths;
+    bool nchw = tunable.tensor_layout == igemm_gtc_tensor_layout_enum::nchw;
+
+    if (tunable.nxb == 0 || (nchw && tunable.gemm_n_per_block % tunable.nxb != 0))
+        return false;
+    if (tunable.nxe == 0) {
+        constraints.flags |= igemm_gtc_problem_flag_unit_conv;
+        divisible(igemm_gtc_problem_value_spatial, tunable.nxb);
+    }
+
+    if (tunable.direction == igemm_gtc_direction_enum::bwd && !nchw) {
+        divisible(igemm_gtc_problem_value_k_per_group, tunable.gemm_k_per_block);
+        divisible(igemm_gtc_problem_value_k_per_group, ta[1]);
+        divisible(igemm_gtc_problem_value_c_per_group, tb[3]);
+        return ok;
+    }
+    if (!nchw || (tunable.direction != igemm_gtc_direction_enum::fwd && tunable.direction != igemm_gtc_direction_enum::bwd))
+        return false;
+
+    divisible(igemm_gtc_problem_value_gemm_m, tunable.gemm_m_per_block);
+    divisible(igemm_gtc_problem_value_gemm_n, tunable.gemm_n_per_block);
+    divisible(igemm_gtc_problem_value_gemm_k, tunable.gemm_k_per_block);
+    divisible(igemm_gtc_problem_value_n, tunable.gemm_n_per_block / tunable.nxb);
+    if (tb[3] > 1) {
+        constraints.flags |= igemm_gtc_problem_flag_unit_conv;
+        divisible(igemm_gtc_problem_value_spatial, tb[3]);
+    }
+    if (tunable.direction == igemm_gtc_direction_enum::fwd) {
+        if (tb[1] > 1)
+            constraints.flags |= igemm_gtc_problem_flag_unit_filter;
+        divisible(igemm_gtc_problem_value_gemm_k, ta[1]);
+    } else if (ta[3] > 1) {
+        constraints.flags |= igemm_gtc_problem_flag_unit_filter;
+        divisible(igemm_gtc_problem_value_c_per_group, ta[3]);
+    }
+    return ok;
+}
+
+static inline bool igemm_gtc_problem_meets(const igemm_gtc_problem_gemm_t &gemm, const igemm_gtc_tunable_constraints_t &constraints)
+{
+    for (int v = 0; v < igemm_gtc_problem_num_values; v++)
+        if (gemm.values[v] % constraints.divisors[v] != 0)
+            return false;
+    return (constraints.flags & ~gemm.flags) == 0;
+}
+
+// the check a runtime walking the list makes, everything worked out again for every tunable
+static inline bool igemm_gtc_tunable_is_applicable(const igemm_gtc_conv_problem_t &problem,
+                                                   const igemm_gtc_packed_tunable_t &tunable)
+{
+    igemm_gtc_tunable_constraints_t constraints;
+    igemm_gtc_problem_gemm_t gemm;
+    return tunable.direction == problem.direction && tunable.tensor_layout == problem.tensor_layout &&
+           tunable.precision == problem.precision && igemm_gtc_tunable_constraints(tunable, constraints) &&
+           igemm_gtc_problem_gemm(problem, tunable.nxe, tunable.nxb, gemm) && igemm_gtc_problem_meets(gemm, constraints);
+}
+
+/*
+* picks the first tunable of an ordered list applicable to a problem. The
+* constraints of the tunables are worked out once: a divisor that is a power of
+* two is kept as its log2, so that 'value % divisor == 0' becomes 'log2 <=
+* trailing zeros of value', and the tunable as 16 bytes of such exponents (the
+* flags and "the problem is valid" taking a byte each). A problem turns into the
+* same 16 bytes of trailing zeros per (nxe, nxb) of the list, and a tunable is
+* tested by one signed byte compare of the two. Tunables with a divisor that is
+* not a power of two are tested by igemm_gtc_problem_meets() next. The tunables
+* no problem can take are left out, and select() skips the ones asking for the
+* same or more than a tunable before them of the same (nxe, nxb): where they
+* apply, that one was picked first. Neither select() nor count() allocates.
+*/
+class igemm_gtc_selector_t {
+  public:
+    explicit igemm_gtc_selector_t(const std::vector<igemm_gtc_packed_tunable_t> &tunables) : num_tunables(tunables.size()) {
+        for (size_t i = 0; i < tunables.size(); i++) {
+            const igemm_gtc_packed_tunable_t &tunable = tunables[i];
+            igemm_gtc_tunable_constraints_t constraints;
+            if (!igemm_gtc_tunable_constraints(tunable, constraints))
+                continue;
+            kind_t &kind = get_kind(tunable);
+            size_t v = 0;
+            while (v < kind.variants.size() && (kind.variants[v].nxe != tunable.nxe || kind.variants[v].nxb != tunable.nxb))
+                v++;
+            if (v == kind.variants.size()) {
+                if (v == max_variants)
+                    throw std::runtime_error("more than 64 different (nxe, nxb) in one direction, layout and precision");
+                kind.variants.push_back({tunable.nxe, tunable.nxb});
+            }
+            record_t record;
+            memset(record.required, 0, sizeof(record.required));
+            record.required[valid_slot] = 1;
+            record.required[unit_conv_slot] = (constraints.flags & igemm_gtc_problem_flag_unit_conv) != 0;
+            record.required[unit_filter_slot] = (constraints.flags & igemm_gtc_problem_flag_unit_filter) != 0;
+            bool exact = true;
+            for (int value = 0; value < igemm_gtc_problem_num_values; value++) {
+                uint32_t divisor = constraints.divisors[value];
+                if ((divisor & (divisor - 1)) != 0)
+                    exact = false;
+                record.required[value] = static_cast<uint8_t>(__builtin_ctz(divisor));
+            }
+            entry_t entry = {static_cast<uint32_t>(i), static_cast<uint8_t>(v), exact ? -1 : int(kind.inexact.size())};
+            if (!exact)
+                kind.inexact.push_back(constraints);
+            kind.records.push_back(record);
+            kind.entries.push_back(entry);
+            if (!covered(kind, v, constraints)) {
+                kind.first_records.push_back(record);
+                kind.first_entries.push_back(entry);
+                kind.first_constraints.push_back(constraints);
+            }
+        }
+    }
+
+    size_t size() const { return num_tunables; }
+
+    // index in the list of the first tunable applicable to 'problem', -1 when none
+    long select(const igemm_gtc_conv_problem_t &problem) const {
+        const kind_t *kind = find_kind(problem);
+        if (kind == nullptr)
+            return -1;
+        problem_t p;
+        prepare(*kind, problem, p);
+        for (size_t r = 0; r < kind->first_records.size(); r++)
+            if (meets(*kind, p, kind->first_records[r], kind->first_entries[r]))
+                return kind->first_entries[r].index;
+        return -1;
+    }
+
+    // number of tunables of the list applicable to 'problem'
+    size_t count(const igemm_gtc_conv_problem_t &problem) const {
+        const kind_t *kind = find_kind(problem);
+        if (kind == nullptr)
+            return 0;
+        problem_t p;
+        prepare(*kind, problem, p);
+        size_t num_applicable = 0;
+        for (size_t r = 0; r < kind->records.size(); r++)
+            num_applicable += meets(*kind, p, kind->records[r], kind->entries[r]);
+        return num_applicable;
+    }
+
+  private:
+    static constexpr size_t max_variants = 64;
+    static constexpr int unit_conv_slot = igemm_gtc_problem_num_values;
+    static constexpr int unit_filter_slot = igemm_gtc_problem_num_values + 1;
+    static constexpr int valid_slot = 15;
+
+    struct alignas(16) record_t {
+        uint8_t required[16];
+    };
+    struct variant_t {
+        uint8_t nxe;
+        uint8_t nxb;
+    };
+    struct entry_t {
+        uint32_t index;       // in the list
+        uint8_t variant;
+        int inexact;          // in kind_t::inexact, -1 for a tunable its record decides
+    };
+    struct kind_t {
+        igemm_gtc_direction_enum direction;
+        igemm_gtc_tensor_layout_enum tensor_layout;
+        igemm_gtc_precision_enum precision;
+        std::vector<variant_t> variants;
+        std::vector<record_t> records;
+        std::vector<entry_t> entries;
+        std::vector<igemm_gtc_tunable_constraints_t> inexact;
+        std::vector<record_t> first_records;       // the ones select() walks
+        std::vector<entry_t> first_entries;
+        std::vector<igemm_gtc_tunable_constraints_t> first_constraints;
+    };
+    // a problem per (nxe, nxb) of a kind, as records to compare against and as values
+    struct problem_t {
+        record_t capabilities[max_variants];
+        igemm_gtc_problem_gemm_t gemms[max_variants];
+    };
+
+    static void prepare(const kind_t &kind, const igemm_gtc_conv_problem_t &problem, problem_t &p) {
+        for (size_t v = 0; v < kind.variants.size(); v++) {
+            record_t &capability = p.capabilities[v];
+            memset(capability.required, 0, sizeof(capability.required));
+            if (!igemm_gtc_problem_gemm(problem, kind.variants[v].nxe, kind.variants[v].nxb, p.gemms[v]))
+                continue;
+            for (int value = 0; value < igemm_gtc_problem_num_values; value++) {
+                uint32_t x = p.gemms[v].values[value];
+                capability.required[value] = static_cast<uint8_t>(x == 0 ? 32 : __builtin_ctz(x));
+            }
+            capability.required[valid_slot] = 1;
+            capability.required[unit_conv_slot] = (p.gemms[v].flags & igemm_gtc_problem_flag_unit_conv) != 0;
+            capability.required[unit_filter_slot] = (p.gemms[v].flags & igemm_gtc_problem_flag_unit_filter) != 0;
+        }
+    }
+
+    static bool meets(const kind_t &kind, const problem_t &p, const record_t &required, const entry_t &entry) {
+        const record_t &capability = p.capabilities[entry.variant];
+#if defined(__SSE2__)
+        __m128i c = _mm_load_si128(reinterpret_cast<const __m128i *>(capability.required));
+        __m128i r = _mm_load_si128(reinterpret_cast<const __m128i *>(required.required));
+        if (_mm_movemask_epi8(_mm_cmpgt_epi8(r, c)) != 0)
+            return false;
+#else
+        for (int i = 0; i < 16; i++)
+            if (required.required[i] > capability.required[i])
+                return false;
+#endif
+        // the power of two part of the divisors passing, the rest is checked exactly
+        return entry.inexact < 0 || igemm_gtc_problem_meets(p.gemms[entry.variant], kind.inexact[entry.inexact]);
+    }
+
+    // a problem meeting 'constraints' meets those of a tunable before of the same (nxe, nxb), that one is picked
+    static bool covered(const kind_t &kind, size_t variant, const igemm_gtc_tunable_constraints_t &constraints) {
+        for (size_t r = 0; r < kind.first_constraints.size(); r++) {
+            const igemm_gtc_tunable_constraints_t &before = kind.first_constraints[r];
+            if (kind.first_entries[r].variant != variant || (before.flags & ~constraints.flags) != 0)
+                continue;
+            int value = 0;
+            while (value < igemm_gtc_problem_num_values && constraints.divisors[value] % before.divisors[value] == 0)
+                value++;
+            if (value == igemm_gtc_problem_num_values)
+                return true;
+        }
+        return false;
+    }
+
+    kind_t &get_kind(const igemm_gtc_packed_tunable_t &tunable) {
+        for (auto &kind : kinds)
+            if (kind.direction == tunable.direction && kind.tensor_layout == tunable.tensor_layout &&
+                kind.precision == tunable.precision)
+                return kind;
+        kinds.push_back(kind_t());
+        kinds.back().direction = tunable.direction;
+        kinds.back().tensor_layout = tunable.tensor_layout;
+        kinds.back().precision = tunable.precision;
+        return kinds.back();
+    }
+
+    const kind_t *find_kind(const igemm_gtc_conv_problem_t &problem) const {
+        for (const auto &kind : kinds)
+            if (kind.direction == problem.direction && kind.tensor_layout == problem.tensor_layout &&
+                kind.precision == problem.precision)
+                return &kind;
+        return nullptr;
+    }
+
+    size_t num_tunables;
+    std::vector<kind_t> kinds;
+};
+
+
+/*
+* a MIOpenDriver convolution command, "[MIOpenDriver] conv|convfp16|convbfp16
+* -n 64 -c 256 -H 56 -W 56 -k 64 -y 1 -x 1 ...", short or long flags, into
+* 'problem' (sizes not given take the defaults of the driver) and the directions
+* it runs (-F, 0 for all) as a mask of 1 << igemm_gtc_direction_enum. Flags not
+* describing the problem (-t, -V, -i, ...) are skipped. False with 'error' set
+* for what is not such a command, a convolution not handled (transposed, 3d,
+* pad modes), or an impossible problem (see check()). Nothing is allocated.
+*/
+static inline bool igemm_gtc_problem_from_driver(std::string_view command, igemm_gtc_conv_problem_t &problem,
+                                                 unsigned &directions, const char *&error)
+{
+    static const struct {
+        char flag;
+        const char *name;
+    } driver_flags[] = {
+        {'n', "batchsize"}, {'c', "in_channels"}, {'H', "in_h"}, {'W', "in_w"}, {'k', "out_channels"},
+        {'y', "fil_h"}, {'x', "fil_w"}, {'p', "pad_h"}, {'q', "pad_w"}, {'u', "conv_stride_h"},
+        {'v', "conv_stride_w"}, {'l', "dilation_h"}, {'j', "dilation_w"}, {'g', "group_count"}, {'F', "forw"},
+        {'I', "in_layout"}, {'m', "mode"}, {'z', "pad_mode"}, {'_', "spatial_dim"},
+    };
+    size_t pos = 0;
+    auto next_token = [&]() {
+        size_t first = command.find_first_not_of(" \t\r\n", pos);
+        if (first == std::string_view::npos) {
+            pos = command.size();
+            return std::string_view();
+        }
+        pos = std::min(command.find_first_of(" \t\r\n", first), command.size());
+        return command.substr(first, pos - first);
+    };
+
+    std::string_view token = next_token();
+    if (!token.empty() && token.substr(0, 4) != "conv")
+        token = next_token();     // the driver itself
+    problem = igemm_gtc_conv_problem_t();
+    problem.n = 100;
+    problem.c = 3;
+    problem.hi = problem.wi = 32;
+    problem.k = 32;
+    problem.y = problem.x = 3;
+    if (token == "conv")
+        problem.precision = igemm_gtc_precision_enum::fp32;
+    else if (token == "convfp16")
+        problem.precision = igemm_gtc_precision_enum::fp16;
+    else if (token == "convbfp16")
+        problem.precision = igemm_gtc_precision_enum::bf16;
+    else {
+        error = "not a conv, convfp16 or convbfp16 command";
+        return false;
+    }
+
+    int forw = 0;
+    for (token = next_token(); !token.empty(); token = next_token()) {
+        char flag = 0;
+        if (token.size() == 2 && token[0] == '-')
+            flag = token[1];
+        else if (token.size() > 2 && token.substr(0, 2) == "--") {
+            for (const auto &driver_flag : driver_flags)
+                if (token.substr(2) == driver_flag.name)
+                    flag = driver_flag.flag;
+        } else {
+            error = "a value without a flag";
+            return false;
+        }
+        std::string_view value = next_token();
+        if (value.empty()) {
+            error = "a flag without a value";
+            return false;
+        }
+        if (flag == 'I') {
+            if (value == "NCHW")
+                problem.tensor_layout = igemm_gtc_tensor_layout_enum::nchw;
+            else if (value == "NHWC")
+                problem.tensor_layout = igemm_gtc_tensor_layout_enum::nhwc;
+            else {
+                error = "a layout other than NCHW and NHWC";
+                return false;
+            }
+            continue;
+        }
+        if (flag == 'm' || flag == 'z') {
+            if (value != (flag == 'm' ? "conv" : "default")) {
+                error = "a transposed convolution or a pad mode, not handled";
+                return false;
+            }
+            continue;
+        }
+
+        int *field = nullptr;
+        int spatial_dim = 2;
+        switch (flag) {
+        case 'n': field = &problem.n; break;
+        case 'c': field = &problem.c; break;
+        case 'H': field = &problem.hi; break;
+        case 'W': field = &problem.wi; break;
+        case 'k': field = &problem.k; break;
+        case 'y': field = &problem.y; break;
+        case 'x': field = &problem.x; break;
+        case 'p': field = &problem.pad_h; break;
+        case 'q': field = &problem.pad_w; break;
+        case 'u': field = &problem.stride_h; break;
+        case 'v': field = &problem.stride_w; break;
+        case 'l': field = &problem.dilation_h; break;
+        case 'j': field = &problem.dilation_w; break;
+        case 'g': field = &problem.group; break;
+        case 'F': field = &forw; break;
+        case '_': field = &spatial_dim; break;
+        default: continue;
+        }
+        auto result = std::from_chars(value.data(), value.data() + value.size(), *field);
+        if (result.ec != std::errc() || result.ptr != value.data() + value.size()) {
+            error = "a value not an integer";
+            return false;
+        }
+        if (spatial_dim != 2) {
+            error = "a 3d convolution, not handled";
+            return false;
+        }
+    }
+    if (forw < 0 || forw > 7) {
+        error = "a -F other than 0 to 7";
+        return false;
+    }
+    error = problem.check();
+    if (error != nullptr)
+        return false;
+    if (forw == 0)
+        forw = 7;
+    directions = 0;
+    if (forw & 1)
+        directions |= 1u << static_cast<int>(igemm_gtc_direction_enum::fwd);
+    if (forw & 2)
+        directions |= 1u << static_cast<int>(igemm_gtc_direction_enum::bwd);
+    if (forw & 4)
+        directions |= 1u << static_cast<int>(igemm_gtc_direction_enum::wrw);
+    return true;
+}
+
+#endif
@@ -0,0 +1,238 @@
+/*******************************************************************************
+ *
+ * MIT License
+ *
+ * Copyright (c) 2020 Advanced Micro Devices, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef __IGEMM_GTC_SET_HPP__
+#define __IGEMM_GTC_SET_HPP__
+
+#include <algorithm>
+#include <assert.h>
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "config_gzip.hpp"
+#include "config_parser.hpp"
+#include "igemm_gtc_base.hpp"
+
+/*
+* set operations on lists of tunables, a tunable being identified by its packed
+* bytes (see igemm_gtc_packed_tunable_t). A tunable is kept by
+*   union                 when in any list
+*   intersection          when in every list
+*   difference            when in the first list and in none of the others
+*   symmetric_difference  when in an odd number of lists
+* once, at its first place: the kept tunables of the first list come in its
+* order, followed by those first seen in the second list, and so on.
+*/
+enum igemm_gtc_set_op_enum {
+    igemm_gtc_set_op_union = 0,
+    igemm_gtc_set_op_intersection,
+    igemm_gtc_set_op_difference,
+    igemm_gtc_set_op_symmetric_difference,
+    igemm_gtc_set_num_ops,
+};
+
+static const char *const igemm_gtc_set_op_names[] = {"union", "intersection", "difference", "symmetric_difference"};
+
+// operation named 'name', -1 when there is none
+static inline int igemm_gtc_set_find_op(std::string_view name)
+{
+    for (int op = 0; op < igemm_gtc_set_num_ops; op++)
+        if (name == igemm_gtc_set_op_names[op])
+            return op;
+    return -1;
+}
+
+// calls 'func(i)' for i in [0, n), from 'num_threads' threads taking the next i as they go
+template <typename func_t>
+static inline void igemm_gtc_parallel_for(size_t n, int num_threads, func_t func)
+{
+    if (num_threads <= 1 || n <= 1) {
+        for (size_t i = 0; i < n; i++)
+            func(i);
+        return;
+    }
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next++; i < n; i = next++)
+            func(i);
+    };
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < std::min<size_t>(num_threads, n); t++)
+        workers.emplace_back(worker);
+    for (auto &w : workers)
+        w.join();
+}
+
+/*
+* the lists are cut into chunks hashed in parallel, every tunable going to the
+* shard given by the top bits of its hash as its place, the list in the upper
+* 32 bits and the index in the lower ones. The shards are then worked in
+* parallel, each through its own open addressing table counting the lists a
+* tunable is found in, and the places of the tunables kept are merged and sorted
+* back into list order.
+*/
+static inline std::vector<igemm_gtc_packed_tunable_t>
+igemm_gtc_tunable_set_op(const std::vector<std::vector<igemm_gtc_packed_tunable_t>> &lists, igemm_gtc_set_op_enum op,
+                         int num_threads = 0)
+{
+    if (num_threads <= 0)
+        num_threads = std::max(1, (int)std::thread::hardware_concurrency());
+    assert(lists.size() < (uint64_t(1) << 31));
+
+    const int shard_bits = 6;
+    const size_t num_shards = size_t(1) << shard_bits;
+    const size_t chunk_size = 1 << 16;
+    struct chunk_t {
+        uint32_t list;
+        uint32_t first;
+        uint32_t last;
+    };
+    std::vector<chunk_t> chunks;
+    for (size_t l = 0; l < lists.size(); l++) {
+        assert(lists[l].size() <= std::numeric_limits<uint32_t>::max());
+        for (size_t first = 0; first < lists[l].size(); first += chunk_size)
+            chunks.push_back({static_cast<uint32_t>(l), static_cast<uint32_t>(first),
+                              static_cast<uint32_t>(std::min(first + chunk_size, lists[l].size()))});
+    }
+
+    // places per chunk and shard, so that a shard reads its places in list order
+    std::vector<std::vector<uint64_t>> chunk_places(chunks.size() * num_shards);
+    std::vector<std::vector<uint64_t>> chunk_hashes(chunks.size() * num_shards);
+    igemm_gtc_parallel_for(chunks.size(), num_threads, [&](size_t c) {
+        const chunk_t &chunk = chunks[c];
+        for (uint32_t i = chunk.first; i < chunk.last; i++) {
+            uint64_t hash = igemm_gtc_tunable_hash(lists[chunk.list][i]);
+            size_t shard = hash >> (64 - shard_bits);
+            chunk_places[c * num_shards + shard].push_back((uint64_t(chunk.list) << 32) | i);
+            chunk_hashes[c * num_shards + shard].push_back(hash);
+        }
+    });
+
+    auto tunable_at = [&](uint64_t place) -> const igemm_gtc_packed_tunable_t & {
+        return lists[place >> 32][static_cast<uint32_t>(place)];
+    };
+    auto keep = [&](uint32_t num_lists_in, bool in_first) {
+        switch (op) {
+        case igemm_gtc_set_op_union:                return true;
+        case igemm_gtc_set_op_intersection:         return num_lists_in == lists.size();
+        case igemm_gtc_set_op_difference:           return in_first && num_lists_in == 1;
+        case igemm_gtc_set_op_symmetric_difference: return (num_lists_in & 1) != 0;
+        default:                                    return false;
+        }
+    };
+
+    std::vector<std::vector<uint64_t>> kept(num_shards);
+    igemm_gtc_parallel_for(num_shards, num_threads, [&](size_t shard) {
+        struct entry_t {
+            uint64_t hash;
+            uint64_t place;           // first place, ~0 for an empty entry
+            uint32_t num_lists_in;
+            uint32_t last_list;
+        };
+        size_t num_places = 0;
+        for (size_t c = 0; c < chunks.size(); c++)
+            num_places += chunk_places[c * num_shards + shard].size();
+        size_t capacity = 16;
+        while (capacity < 2 * num_places)
+            capacity *= 2;
+        std::vector<entry_t> table(capacity, entry_t{0, ~uint64_t(0), 0, 0});
+        for (size_t c = 0; c < chunks.size(); c++) {
+            const std::vector<uint64_t> &places = chunk_places[c * num_shards + shard];
+            const std::vector<uint64_t> &hashes = chunk_hashes[c * num_shards + shard];
+            for (size_t i = 0; i < places.size(); i++) {
+                size_t slot = hashes[i] & (capacity - 1);
+                for (;; slot = (slot + 1) & (capacity - 1)) {
+                    entry_t &entry = table[slot];
+                    if (entry.place == ~uint64_t(0)) {
+                        entry = entry_t{hashes[i], places[i], 1, static_cast<uint32_t>(places[i] >> 32)};
+                        break;
+                    }
+                    if (entry.hash == hashes[i] && tunable_at(entry.place) == tunable_at(places[i])) {
+                        uint32_t list = static_cast<uint32_t>(places[i] >> 32);
+                        if (entry.last_list != list) {
+                            entry.num_lists_in++;
+                            entry.last_list = list;
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+        for (const entry_t &entry : table) {
+            if (entry.place != ~uint64_t(0) && keep(entry.num_lists_in, (entry.place >> 32) == 0))
+                kept[shard].push_back(entry.place);
+        }
+    });
+
+    std::vector<uint64_t> places;
+    for (const auto &shard_places : kept)
+        places.insert(places.end(), shard_places.begin(), shard_places.end());
+    std::sort(places.begin(), places.end());
+    std::vector<igemm_gtc_packed_tunable_t> result;
+    result.reserve(places.size());
+    for (uint64_t place : places)
+        result.push_back(tunable_at(place));
+    return result;
+}
+
+// the tunables of 'config_file', bound while its text is scanned (see igemm_gtc_tunable_bind_buffer())
+// and packed as they come. A gzip file is inflated first. An incomplete section is fatal.
+static inline std::vector<igemm_gtc_packed_tunable_t> igemm_gtc_tunable_load_packed(const std::string &config_file)
+{
+    std::vector<igemm_gtc_packed_tunable_t> tunables;
+    auto on_tunable = [&](igemm_gtc_tunable_t &&tunable) {
+        igemm_gtc_packed_tunable_t packed;
+        if (!igemm_gtc_tunable_pack(tunable, packed)) {
+            printf("tunable %zu of %s has a value igemm_gtc_packed_tunable_t can not hold\n", tunables.size(),
+                   config_file.c_str());
+            exit(-1);
+        }
+        tunables.push_back(packed);
+    };
+    bool ok;
+    if (config_gzip_is_compressed(config_file)) {
+        std::string text;
+        config_gzip_reader_t reader(config_file);
+        char block[64 * 1024];
+        for (size_t n = reader.read(block, sizeof(block)); n > 0; n = reader.read(block, sizeof(block)))
+            text.append(block, n);
+        ok = igemm_gtc_tunable_bind_buffer(text, on_tunable);
+    } else {
+        config_mapped_file_t mapped_file(config_file);
+        ok = igemm_gtc_tunable_bind_buffer(mapped_file.view(), on_tunable);
+    }
+    if (!ok) {
+        printf("%s has incomplete tunable sections\n", config_file.c_str());
+        exit(-1);
+    }
+    return tunables;
+}
+
+#endif
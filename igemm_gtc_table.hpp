@@ -0,0 +1,468 @@
+/*******************************************************************************
+ *
+ * MIT License
+ *
+ * Copyright (c) 2020 Advanced Micro Devices, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef __IGEMM_GTC_TABLE_HPP__
+#define __IGEMM_GTC_TABLE_HPP__
+
+#include <algorithm>
+#include <assert.h>
+#include <ctype.h>
+#include <limits>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "igemm_gtc_base.hpp"
+
+/*
+* columns of igemm_gtc_tunable_table_t, one per field of igemm_gtc_packed_tunable_t
+* and one per component of the length arrays, named like the keys of the config
+* sections ("tensor_b_thread_lengths.3" is the 4th component). The 7 columns of
+* the union hold the xdlops view or the mac one depending on fma_type, so either
+* set of names gives the same columns. The last columns hold the
+* igemm_gtc_tunable_attributes_t of the rows, computed when they are stored, so
+* that filters can select on block size, vector widths and the like directly
+* (lds_bytes saturates at 65535).
+*/
+enum igemm_gtc_table_column_enum {
+    igemm_gtc_table_column_tensor_a_thread_lengths = 0,
+    igemm_gtc_table_column_tensor_a_cluster_lengths = 4,
+    igemm_gtc_table_column_tensor_b_thread_lengths = 8,
+    igemm_gtc_table_column_tensor_b_cluster_lengths = 12,
+    igemm_gtc_table_column_gemm_m_per_block = 16,
+    igemm_gtc_table_column_gemm_n_per_block,
+    igemm_gtc_table_column_gemm_k_per_block,
+    igemm_gtc_table_column_wave_tile_m,
+    igemm_gtc_table_column_wave_step_m,
+    igemm_gtc_table_column_wave_repeat_m,
+    igemm_gtc_table_column_wave_tile_n,
+    igemm_gtc_table_column_wave_step_n,
+    igemm_gtc_table_column_wave_repeat_n,
+    igemm_gtc_table_column_wave_tile_k,
+    igemm_gtc_table_column_nxb,
+    igemm_gtc_table_column_nxe,
+    igemm_gtc_table_column_gemm_m_unmerge_cluster,
+    igemm_gtc_table_column_gemm_n_unmerge_cluster,
+    igemm_gtc_table_column_gemm_k_unmerge_cluster,
+    igemm_gtc_table_column_multihead,
+    igemm_gtc_table_column_source_access_order,
+    igemm_gtc_table_column_gemm_k_global_split,
+    igemm_gtc_table_column_tensor_layout,
+    igemm_gtc_table_column_direction,
+    igemm_gtc_table_column_precision,
+    igemm_gtc_table_column_fma_type,
+    igemm_gtc_table_num_tunable_columns,
+    igemm_gtc_table_column_block_size = igemm_gtc_table_num_tunable_columns,
+    igemm_gtc_table_column_waves,
+    igemm_gtc_table_column_vector_a,
+    igemm_gtc_table_column_vector_b,
+    igemm_gtc_table_column_global_loads_a,
+    igemm_gtc_table_column_global_loads_b,
+    igemm_gtc_table_column_lds_bytes,
+    igemm_gtc_table_column_mfma_per_k_step,
+    igemm_gtc_table_column_unmerge_sub_n,
+    igemm_gtc_table_num_columns,
+};
+
+// the uint16_t fields of igemm_gtc_packed_tunable_t come first, column c at byte 2 * c,
+// then the uint8_t ones, column c at byte 52 + c - 26
+static constexpr int igemm_gtc_table_num_wide_columns = igemm_gtc_table_column_nxb;
+static_assert(offsetof(igemm_gtc_packed_tunable_t, gemm_m_per_block) == 2 * igemm_gtc_table_column_gemm_m_per_block,
+              "igemm_gtc_packed_tunable_t layout does not match the table columns");
+static_assert(offsetof(igemm_gtc_packed_tunable_t, nxb) == 2 * igemm_gtc_table_num_wide_columns,
+              "igemm_gtc_packed_tunable_t layout does not match the table columns");
+static_assert(offsetof(igemm_gtc_packed_tunable_t, fma_type) ==
+                  2 * igemm_gtc_table_num_wide_columns + igemm_gtc_table_column_fma_type - igemm_gtc_table_column_nxb,
+              "igemm_gtc_packed_tunable_t layout does not match the table columns");
+
+static const char *const igemm_gtc_table_column_names[] = {
+    "tensor_a_thread_lengths.0", "tensor_a_thread_lengths.1", "tensor_a_thread_lengths.2", "tensor_a_thread_lengths.3",
+    "tensor_a_cluster_lengths.0", "tensor_a_cluster_lengths.1", "tensor_a_cluster_lengths.2", "tensor_a_cluster_lengths.3",
+    "tensor_b_thread_lengths.0", "tensor_b_thread_lengths.1", "tensor_b_thread_lengths.2", "tensor_b_thread_lengths.3",
+    "tensor_b_cluster_lengths.0", "tensor_b_cluster_lengths.1", "tensor_b_cluster_lengths.2", "tensor_b_cluster_lengths.3",
+    "gemm_m_per_block", "gemm_n_per_block", "gemm_k_per_block",
+    "wave_tile_m", "wave_step_m", "wave_repeat_m", "wave_tile_n", "wave_step_n", "wave_repeat_n", "wave_tile_k",
+    "nxb", "nxe", "gemm_m_unmerge_cluster", "gemm_n_unmerge_cluster", "gemm_k_unmerge_cluster",
+    "multihead", "source_access_order", "gemm_k_global_split",
+    "tensor_layout", "direction", "precision", "fma_type",
+    "block_size", "waves", "vector_a", "vector_b", "global_loads_a", "global_loads_b", "lds_bytes",
+    "mfma_per_k_step", "unmerge_sub_n",
+};
+static_assert(sizeof(igemm_gtc_table_column_names) / sizeof(igemm_gtc_table_column_names[0]) == igemm_gtc_table_num_columns,
+              "a name for every column");
+
+// the mac names of the union columns, from igemm_gtc_table_column_wave_tile_m on
+static const char *const igemm_gtc_table_mac_column_names[] = {
+    "gemm_m_per_thread", "gemm_m_level0_cluster", "gemm_m_level1_cluster",
+    "gemm_n_per_thread", "gemm_n_level0_cluster", "gemm_n_level1_cluster",
+};
+
+// column of 'name', -1 when there is none
+static inline int igemm_gtc_table_find_column(std::string_view name)
+{
+    for (int c = 0; c < igemm_gtc_table_num_columns; c++)
+        if (name == igemm_gtc_table_column_names[c])
+            return c;
+    for (size_t i = 0; i < sizeof(igemm_gtc_table_mac_column_names) / sizeof(igemm_gtc_table_mac_column_names[0]); i++)
+        if (name == igemm_gtc_table_mac_column_names[i])
+            return igemm_gtc_table_column_wave_tile_m + static_cast<int>(i);
+    return -1;
+}
+
+enum igemm_gtc_table_op_enum {
+    igemm_gtc_table_op_eq = 0,
+    igemm_gtc_table_op_ne,
+    igemm_gtc_table_op_lt,
+    igemm_gtc_table_op_le,
+    igemm_gtc_table_op_gt,
+    igemm_gtc_table_op_ge,
+};
+
+/*
+* every comparison of a column against a value is compiled to one test,
+* 'uint16_t(x - lo) <= span' or its negation, which is a subtract, a saturating
+* subtract and a compare in SIMD. A comparison no row can pass (or every row
+* passes) is the full range negated (or not), so nothing needs a special case.
+*/
+struct igemm_gtc_table_term_t {
+    int column;
+    uint16_t lo;
+    uint16_t span;
+    bool negate;
+};
+
+/*
+* a predicate over the table columns, an OR of ANDs of comparisons, built by
+* where() / or_where() or compiled from text like
+*
+*   gemm_n_per_block >= 64 && nxe == 0 && tensor_b_thread_lengths.3 == 4 || precision == fp16
+*
+* where && binds tighter than ||. Values are ints, or the names of the enum
+* columns (nhwc, bwd, fp16, xdlops...).
+*/
+class igemm_gtc_table_query_t {
+  public:
+    // ANDs a comparison into the last group
+    igemm_gtc_table_query_t &where(int column, igemm_gtc_table_op_enum op, int value) {
+        assert(column >= 0 && column < igemm_gtc_table_num_columns);
+        if (groups.empty())
+            groups.emplace_back();
+        groups.back().push_back(make_term(column, op, value));
+        return *this;
+    }
+
+    // starts a new group, ORed with the previous ones
+    igemm_gtc_table_query_t &or_where(int column, igemm_gtc_table_op_enum op, int value) {
+        groups.emplace_back();
+        return where(column, op, value);
+    }
+
+    bool compile(std::string_view text, std::string &error) {
+        groups.clear();
+        size_t pos = 0;
+        for (;;) {
+            std::string_view name = next_token(text, pos, false);
+            std::string_view op_text = next_token(text, pos, true);
+            std::string_view value_text = next_token(text, pos, false);
+            int column = igemm_gtc_table_find_column(name);
+            if (column < 0) {
+                error = "unknown column '" + std::string(name) + "'";
+                return false;
+            }
+            int op = find_op(op_text);
+            if (op < 0) {
+                error = "unknown comparison '" + std::string(op_text) + "' after " + std::string(name);
+                return false;
+            }
+            int value;
+            if (!parse_value(column, value_text, value)) {
+                error = "bad value '" + std::string(value_text) + "' for " + std::string(name);
+                return false;
+            }
+            where(column, static_cast<igemm_gtc_table_op_enum>(op), value);
+
+            std::string_view joint = next_token(text, pos, true);
+            if (joint.empty() && pos >= text.size())
+                return true;
+            if (joint == "||")
+                groups.emplace_back();
+            else if (joint != "&&") {
+                error = "expecting && or || instead of '" + std::string(joint) + "'";
+                return false;
+            }
+        }
+    }
+
+    std::vector<std::vector<igemm_gtc_table_term_t>> groups;
+
+  private:
+    static igemm_gtc_table_term_t make_term(int column, igemm_gtc_table_op_enum op, int value) {
+        const int max = std::numeric_limits<uint16_t>::max();
+        int lo = 0, hi = max;
+        bool negate = false;
+        switch (op) {
+        case igemm_gtc_table_op_ne: negate = true; // fall through
+        case igemm_gtc_table_op_eq: lo = value; hi = value; break;
+        case igemm_gtc_table_op_lt: hi = value - 1; break;
+        case igemm_gtc_table_op_le: hi = value; break;
+        case igemm_gtc_table_op_gt: lo = value + 1; break;
+        case igemm_gtc_table_op_ge: lo = value; break;
+        }
+        lo = std::max(lo, 0);
+        hi = std::min(hi, max);
+        if (lo > hi)
+            return {column, 0, static_cast<uint16_t>(max), !negate};
+        return {column, static_cast<uint16_t>(lo), static_cast<uint16_t>(hi - lo), negate};
+    }
+
+    // a name or a number, or with 'op' a run of comparison characters
+    static std::string_view next_token(std::string_view text, size_t &pos, bool op) {
+        while (pos < text.size() && isspace(static_cast<unsigned char>(text[pos])))
+            pos++;
+        size_t begin = pos;
+        while (pos < text.size() && !isspace(static_cast<unsigned char>(text[pos])) &&
+               (strchr("=!<>&|", text[pos]) != nullptr) == op)
+            pos++;
+        return text.substr(begin, pos - begin);
+    }
+
+    static int find_op(std::string_view op) {
+        const char *const ops[] = {"==", "!=", "<", "<=", ">", ">="};
+        for (int i = 0; i < 6; i++)
+            if (op == ops[i])
+                return i;
+        return -1;
+    }
+
+    static bool parse_value(int column, std::string_view text, int &value) {
+        uint8_t e;
+        switch (column) {
+        case igemm_gtc_table_column_tensor_layout:
+            if (igemm_gtc_enum_from_name(igemm_gtc_tensor_layout_names, text, e) && !text.empty()) { value = e; return true; }
+            break;
+        case igemm_gtc_table_column_direction:
+            if (igemm_gtc_enum_from_name(igemm_gtc_direction_names, text, e) && !text.empty()) { value = e; return true; }
+            break;
+        case igemm_gtc_table_column_precision:
+            if (igemm_gtc_enum_from_name(igemm_gtc_precision_names, text, e) && !text.empty()) { value = e; return true; }
+            break;
+        case igemm_gtc_table_column_fma_type:
+            if (igemm_gtc_enum_from_name(igemm_gtc_fma_type_names, text, e) && !text.empty()) { value = e; return true; }
+            break;
+        }
+        size_t i = (!text.empty() && text[0] == '-') ? 1 : 0;
+        if (i == text.size() || text.size() > 9)
+            return false;
+        for (size_t j = i; j < text.size(); j++)
+            if (!isdigit(static_cast<unsigned char>(text[j])))
+                return false;
+        value = atoi(std::string(text).c_str());
+        return true;
+    }
+};
+
+/*
+* structure of arrays store of packed tunables: every column is a contiguous
+* uint16_t array, the uint8_t fields and the enums widened, so a predicate
+* streams only the columns it names and compares 16 (AVX2) or 8 (SSE2) rows per
+* instruction. Columns are padded to 64 rows, a query is evaluated 64 rows at a
+* time into a bit mask word, the groups of the query ANDed and ORed on those
+* words, and the set bits turned into the selected row indices.
+*/
+class igemm_gtc_tunable_table_t {
+  public:
+    igemm_gtc_tunable_table_t() : num_rows(0), stride(0) {}
+    explicit igemm_gtc_tunable_table_t(const std::vector<igemm_gtc_packed_tunable_t> &tunables) : num_rows(0), stride(0) {
+        append(tunables);
+    }
+
+    size_t size() const { return num_rows; }
+    const uint16_t *column(int c) const { return data.data() + c * stride; }
+
+    void append(const std::vector<igemm_gtc_packed_tunable_t> &tunables) {
+        if (num_rows + tunables.size() > stride)
+            reserve(std::max(num_rows + tunables.size(), 2 * stride));
+        for (const auto &tunable : tunables)
+            store(num_rows++, tunable);
+    }
+
+    void push_back(const igemm_gtc_packed_tunable_t &tunable) {
+        if (num_rows == stride)
+            reserve(std::max<size_t>(2 * stride, 64));
+        store(num_rows++, tunable);
+    }
+
+    igemm_gtc_packed_tunable_t row(size_t r) const {
+        assert(r < num_rows);
+        igemm_gtc_packed_tunable_t tunable = igemm_gtc_packed_tunable_t();
+        unsigned char *bytes = reinterpret_cast<unsigned char *>(&tunable);
+        for (int c = 0; c < igemm_gtc_table_num_wide_columns; c++)
+            memcpy(bytes + 2 * c, &column(c)[r], sizeof(uint16_t));
+        for (int c = igemm_gtc_table_num_wide_columns; c < igemm_gtc_table_num_tunable_columns; c++)
+            bytes[c + igemm_gtc_table_num_wide_columns] = static_cast<unsigned char>(column(c)[r]);
+        return tunable;
+    }
+
+    std::vector<igemm_gtc_packed_tunable_t> rows(const std::vector<uint32_t> &selection) const {
+        std::vector<igemm_gtc_packed_tunable_t> tunables;
+        tunables.reserve(selection.size());
+        for (uint32_t r : selection)
+            tunables.push_back(row(r));
+        return tunables;
+    }
+
+    // bit r of mask[r / 64] set for every row r passing 'query'
+    void select_mask(const igemm_gtc_table_query_t &query, std::vector<uint64_t> &mask, bool vectorized = true) const {
+        size_t num_words = (num_rows + 63) / 64;
+        mask.assign(num_words, 0);
+        for (size_t w = 0; w < num_words; w++) {
+            uint64_t word = 0;
+            for (const auto &group : query.groups) {
+                uint64_t group_word = ~uint64_t(0);
+                for (const auto &term : group) {
+                    if (group_word == 0)
+                        break;
+                    const uint16_t *x = column(term.column) + 64 * w;
+                    uint64_t match = vectorized ? match_vector(x, term.lo, term.span) : match_scalar(x, term.lo, term.span);
+                    group_word &= term.negate ? ~match : match;
+                }
+                word |= group_word;
+            }
+            mask[w] = word;
+        }
+        if (num_rows % 64 != 0)
+            mask.back() &= (uint64_t(1) << (num_rows % 64)) - 1;
+    }
+
+    // indices of the rows passing 'query', in order
+    std::vector<uint32_t> select(const igemm_gtc_table_query_t &query, bool vectorized = true) const {
+        std::vector<uint64_t> mask;
+        select_mask(query, mask, vectorized);
+        size_t count = 0;
+        for (uint64_t word : mask)
+            count += __builtin_popcountll(word);
+        std::vector<uint32_t> selection;
+        selection.reserve(count);
+        for (size_t w = 0; w < mask.size(); w++) {
+            for (uint64_t word = mask[w]; word != 0; word &= word - 1)
+                selection.push_back(static_cast<uint32_t>(64 * w + __builtin_ctzll(word)));
+        }
+        return selection;
+    }
+
+  private:
+    void reserve(size_t n) {
+        size_t new_stride = (n + 63) / 64 * 64;
+        if (new_stride <= stride)
+            return;
+        std::vector<uint16_t> new_data(new_stride * igemm_gtc_table_num_columns, 0);
+        for (int c = 0; c < igemm_gtc_table_num_columns; c++)
+            std::copy(column(c), column(c) + num_rows, new_data.begin() + c * new_stride);
+        data.swap(new_data);
+        stride = new_stride;
+    }
+
+    void store(size_t r, const igemm_gtc_packed_tunable_t &tunable) {
+        const unsigned char *bytes = reinterpret_cast<const unsigned char *>(&tunable);
+        for (int c = 0; c < igemm_gtc_table_num_wide_columns; c++)
+            memcpy(&data[c * stride + r], bytes + 2 * c, sizeof(uint16_t));
+        for (int c = igemm_gtc_table_num_wide_columns; c < igemm_gtc_table_num_tunable_columns; c++)
+            data[c * stride + r] = bytes[c + igemm_gtc_table_num_wide_columns];
+
+        igemm_gtc_tunable_attributes_t attributes = igemm_gtc_tunable_derive(tunable);
+        data[igemm_gtc_table_column_block_size * stride + r]      = attributes.block_size;
+        data[igemm_gtc_table_column_waves * stride + r]           = attributes.waves;
+        data[igemm_gtc_table_column_vector_a * stride + r]        = attributes.vector_a;
+        data[igemm_gtc_table_column_vector_b * stride + r]        = attributes.vector_b;
+        data[igemm_gtc_table_column_global_loads_a * stride + r]  = attributes.global_loads_a;
+        data[igemm_gtc_table_column_global_loads_b * stride + r]  = attributes.global_loads_b;
+        data[igemm_gtc_table_column_lds_bytes * stride + r]       = igemm_gtc_saturate<uint16_t>(attributes.lds_bytes);
+        data[igemm_gtc_table_column_mfma_per_k_step * stride + r] = attributes.mfma_per_k_step;
+        data[igemm_gtc_table_column_unmerge_sub_n * stride + r]   = attributes.unmerge_sub_n;
+    }
+
+    static uint64_t match_scalar(const uint16_t *x, uint16_t lo, uint16_t span) {
+        uint64_t bits = 0;
+        for (int i = 0; i < 64; i++)
+            bits |= uint64_t(static_cast<uint16_t>(x[i] - lo) <= span) << i;
+        return bits;
+    }
+
+    static uint64_t match_vector(const uint16_t *x, uint16_t lo, uint16_t span) {
+#if defined(__AVX2__)
+        // packs_epi16 interleaves the 128 bits lanes of its inputs, permute4x64 puts the rows back in order
+        const __m256i vlo = _mm256_set1_epi16(static_cast<short>(lo));
+        const __m256i vspan = _mm256_set1_epi16(static_cast<short>(span));
+        const __m256i zero = _mm256_setzero_si256();
+        uint64_t bits = 0;
+        for (int i = 0; i < 4; i += 2) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + 16 * i));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + 16 * i + 16));
+            a = _mm256_cmpeq_epi16(_mm256_subs_epu16(_mm256_sub_epi16(a, vlo), vspan), zero);
+            b = _mm256_cmpeq_epi16(_mm256_subs_epu16(_mm256_sub_epi16(b, vlo), vspan), zero);
+            __m256i ab = _mm256_permute4x64_epi64(_mm256_packs_epi16(a, b), 0xd8);
+            bits |= uint64_t(static_cast<uint32_t>(_mm256_movemask_epi8(ab))) << (16 * i);
+        }
+        return bits;
+#elif defined(__SSE2__)
+        const __m128i vlo = _mm_set1_epi16(static_cast<short>(lo));
+        const __m128i vspan = _mm_set1_epi16(static_cast<short>(span));
+        const __m128i zero = _mm_setzero_si128();
+        uint64_t bits = 0;
+        for (int i = 0; i < 8; i += 2) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(x + 8 * i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(x + 8 * i + 8));
+            a = _mm_cmpeq_epi16(_mm_subs_epu16(_mm_sub_epi16(a, vlo), vspan), zero);
+            b = _mm_cmpeq_epi16(_mm_subs_epu16(_mm_sub_epi16(b, vlo), vspan), zero);
+            bits |= uint64_t(static_cast<uint32_t>(_mm_movemask_epi8(_mm_packs_epi16(a, b)))) << (8 * i);
+        }
+        return bits;
+#else
+        return match_scalar(x, lo, span);
+#endif
+    }
+
+    std::vector<uint16_t> data;     // column c is data[c * stride, c * stride + num_rows)
+    size_t num_rows;
+    size_t stride;
+};
+
+// the tunables of a config file, search-space sections expanded, as a table
+static inline igemm_gtc_tunable_table_t igemm_gtc_tunable_table_load(const std::string &config_file)
+{
+    return igemm_gtc_tunable_table_t(igemm_gtc_tunable_pack(igemm_gtc_tunable_load(config_file)));
+}
+
+#endif
@@ -110,13 +110,9 @@ int main(int argc, char **argv)
     const char *config_file = argv[1]; 
     const char *tunables_h_file = argv[2];  
 
-    config_parser_t config_parser(config_file);
-    auto content = config_parser.parse();
-    // content.dump();
-   
     std::ofstream ofs(argv[2], std::ofstream::out);
 
-    auto tunables = igemm_gtc_tunable_from_config(content);
+    auto tunables = igemm_gtc_tunable_load(config_file);
     if (tunables.size() == 0){
         fprintf(stdout, "no tunable specified, may not work\n");
         return 0;
@@ -45,7 +45,7 @@
 
 static bool simpleSorter(int i,int j) { return (i>j); }; 
 
-static std::vector<igemm_gtc_tunable_t> ordered_configs; 
+static std::vector<igemm_gtc_packed_tunable_t> ordered_configs; 
 
 int main(int argc, char **argv) 
 {
@@ -56,39 +56,37 @@ int main(int argc, char **argv)
 
     const char *config_file = argv[1];
 
-    config_parser_t config_parser(config_file);
-    auto content = config_parser.parse();
-   
-    std::ofstream ofs(argv[2], std::ofstream::out);
+    config_ofstream_t ofs(argv[2]);
 
-    auto tunables = igemm_gtc_tunable_from_config(content);
+    auto tunables = igemm_gtc_tunable_pack(igemm_gtc_tunable_load(config_file));
     if (tunables.size() == 0){
         fprintf(stdout, "no tunable specified, may not work\n");
         return 0;
     }
     fprintf(stdout, "tunables:%d\n", (int)tunables.size());
+    drop_duplicated_configurations(tunables);
 
-    std::string direction(tunables[0].direction);
-    std::string precision(tunables[0].precision); 
-    std::string layout(tunables[0].tensor_layout);
+    std::string direction(tunables[0].get_direction());
+    std::string precision(tunables[0].get_precision()); 
+    std::string layout(tunables[0].get_tensor_layout());
 
     std::cout << std::endl << "layout = " << layout << std::endl; 
 
     // "indexed_configs" is used to classify the configs according to the size of the macro-tile
-    std::map< int, std::vector<igemm_gtc_tunable_t> > indexed_configs; 
-    std::map< int, std::vector<igemm_gtc_tunable_t> >::iterator it;
+    std::map< int, std::vector<igemm_gtc_packed_tunable_t> > indexed_configs; 
+    std::map< int, std::vector<igemm_gtc_packed_tunable_t> >::iterator it;
     std::vector<int> mt_sizes; 
 
     int count=0; 
     for (const auto& tunable : tunables)  {
-         assert(direction == tunable.direction && std::string(precision) == tunable.precision && layout == tunable.tensor_layout); 
+         assert(direction == tunable.get_direction() && std::string(precision) == tunable.get_precision() && layout == tunable.get_tensor_layout()); 
 
          auto mt = tunable.gemm_m_per_block*tunable.gemm_n_per_block; 
 
          it = indexed_configs.find(mt); 
 
          if ( it == indexed_configs.end() ) {
-              std::vector<igemm_gtc_tunable_t> tmpVector;
+              std::vector<igemm_gtc_packed_tunable_t> tmpVector;
 
               indexed_configs.insert( std::make_pair(mt, tmpVector) );
               it = indexed_configs.find(mt);
@@ -112,11 +110,13 @@ int main(int argc, char **argv)
          if ( it != indexed_configs.end() ) {
               fprintf(stdout, "Macro-tile %d, number of configurations %d\n", mt, (int)it->second.size());
 
+              auto attributes = igemm_gtc_tunable_derive(it->second);
+
               if ( layout == "nchw" ) 
-                   std::sort(it->second.begin(), it->second.end(), BwdNchwSorter);
+                   igemm_gtc_tunable_sort(it->second, attributes, BwdNchwSortKey, BwdNchwSorter<igemm_gtc_packed_tunable_t>);
               else 
               if ( layout == "nhwc" )  	
-                   std::sort(it->second.begin(), it->second.end(), BwdNhwcSorter);
+                   igemm_gtc_tunable_sort(it->second, attributes, BwdNhwcSortKey, BwdNhwcSorter<igemm_gtc_packed_tunable_t>);
 
               for (const auto&  tunable : it->second)
                    ordered_configs.push_back(tunable);
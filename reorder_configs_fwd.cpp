@@ -50,7 +50,7 @@ static std::pair<int,int> macro_tiles[] = { {256,128}, {128, 256}, {64,256}, {12
                                             
 #define NUM_MACRO_TILES (sizeof(macro_tiles)/sizeof(macro_tiles[0]))
 
-static std::vector<igemm_gtc_tunable_t> ordered_configs; 
+static std::vector<igemm_gtc_packed_tunable_t> ordered_configs; 
 
 int main(int argc, char **argv) 
 {
@@ -61,36 +61,34 @@ int main(int argc, char **argv)
 
     const char *config_file = argv[1];
 
-    config_parser_t config_parser(config_file);
-    auto content = config_parser.parse();
-   
-    std::ofstream ofs(argv[2], std::ofstream::out);
+    config_ofstream_t ofs(argv[2]);
 
-    auto tunables = igemm_gtc_tunable_from_config(content);
+    auto tunables = igemm_gtc_tunable_pack(igemm_gtc_tunable_load(config_file));
     if (tunables.size() == 0){
         fprintf(stdout, "no tunable specified, may not work\n");
         return 0;
     }
     fprintf(stdout, "tunables:%d\n", (int)tunables.size());
+    drop_duplicated_configurations(tunables);
 
-    std::string direction(tunables[0].direction);
-    std::string precision(tunables[0].precision);
-    std::string layout(tunables[0].tensor_layout);
+    std::string direction(tunables[0].get_direction());
+    std::string precision(tunables[0].get_precision());
+    std::string layout(tunables[0].get_tensor_layout());
 
     // "indexed_configs" is used to classify the configs according to the lengths of the macro-tile
-    std::map< std::pair<int,int>, std::vector<igemm_gtc_tunable_t> > indexed_configs; 
-    std::map< std::pair<int,int>, std::vector<igemm_gtc_tunable_t> >::iterator it;
+    std::map< std::pair<int,int>, std::vector<igemm_gtc_packed_tunable_t> > indexed_configs; 
+    std::map< std::pair<int,int>, std::vector<igemm_gtc_packed_tunable_t> >::iterator it;
 
     int count=0; 
     for (const auto& tunable : tunables)  {
-         assert(direction == tunable.direction && std::string(precision) == tunable.precision); 
+         assert(direction == tunable.get_direction() && std::string(precision) == tunable.get_precision()); 
 
          auto mt = std::make_pair((int)tunable.gemm_m_per_block, (int)tunable.gemm_n_per_block); 
 
          it = indexed_configs.find(mt); 
 
          if ( it == indexed_configs.end() ) {
-              std::vector<igemm_gtc_tunable_t> tmpVector;       
+              std::vector<igemm_gtc_packed_tunable_t> tmpVector;       
 
               indexed_configs.insert( std::make_pair(mt, tmpVector) ); 
               it = indexed_configs.find(mt);
@@ -110,8 +108,10 @@ int main(int argc, char **argv)
          if ( it != indexed_configs.end() ) {
               fprintf(stdout, "Macro-tile [%d,%d], number of configurations %d\n", it->first.first, it->first.second, (int)it->second.size());
 
+              auto attributes = igemm_gtc_tunable_derive(it->second);
+
               if ( layout == "nchw" )
-                   std::sort(it->second.begin(), it->second.end(), FwdNchwSorter);
+                   igemm_gtc_tunable_sort(it->second, attributes, FwdNchwSortKey, FwdNchwSorter<igemm_gtc_packed_tunable_t>);
               else
 	      if ( layout == "nhwc" )
 	           throw std::runtime_error("Not implemented at present"); 
@@ -29,6 +29,8 @@
 #include <string>
 #include <vector>
 #include <assert.h>
+#include <stdint.h>
+#include <string.h>
 
 template <typename T>
 T utility_gcd(T x, T y)
@@ -117,4 +119,40 @@ static std::string utility_lower_string(const char *inStr)
     return(out);
 };
 
+// MurmurHash64A, fast non-cryptographic fingerprint of a memory block
+static inline uint64_t utility_hash64(const void *data, size_t length, uint64_t seed = 0)
+{
+    const uint64_t m = 0xc6a4a7935bd1e995ULL;
+    const int r = 47;
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+    const uint8_t *end = p + (length & ~static_cast<size_t>(7));
+    uint64_t h = seed ^ (length * m);
+
+    for (; p != end; p += 8) {
+        uint64_t k;
+        memcpy(&k, p, 8);
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+        h ^= k;
+        h *= m;
+    }
+
+    switch (length & 7) {
+    case 7: h ^= uint64_t(p[6]) << 48; // fall through
+    case 6: h ^= uint64_t(p[5]) << 40; // fall through
+    case 5: h ^= uint64_t(p[4]) << 32; // fall through
+    case 4: h ^= uint64_t(p[3]) << 24; // fall through
+    case 3: h ^= uint64_t(p[2]) << 16; // fall through
+    case 2: h ^= uint64_t(p[1]) << 8;  // fall through
+    case 1: h ^= uint64_t(p[0]);
+            h *= m;
+    };
+
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+    return h;
+}
+
 #endif